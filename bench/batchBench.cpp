@@ -0,0 +1,34 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <sim/batch.hpp>
+#include "benchmarks.hpp"
+
+using namespace gerryfudd::sim;
+
+#define BATCH_GAMES 40000
+
+double time_batch(int thread_count, BatchSummary *summary) {
+  BatchRunner runner{thread_count};
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  *summary = runner.run(BATCH_GAMES, 1);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+void batch_benchmark() {
+  int thread_count = std::max(1u, std::thread::hardware_concurrency());
+  BatchSummary summary;
+  double single = time_batch(1, &summary);
+  double parallel = time_batch(thread_count, &summary);
+
+  std::cout << "Batch runner" << std::endl;
+  std::cout << "  games:             " << summary.game_count() << std::endl;
+  std::cout << "  win rate:          " << summary.win_rate() << std::endl;
+  for (int i = 0; i < MAX_EPIDEMIC_COUNT; i++) {
+    std::cout << "  epidemic " << i + 1 << " turn:   " << summary.mean_epidemic_turn(i) << std::endl;
+  }
+  std::cout << "  1 thread games/sec: " << BATCH_GAMES / single << std::endl;
+  std::cout << "  " << thread_count << " thread games/sec: " << BATCH_GAMES / parallel << std::endl;
+  std::cout << "  speedup:           " << single / parallel << std::endl;
+}
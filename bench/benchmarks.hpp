@@ -0,0 +1,12 @@
+#ifndef BENCHMARKS
+#define BENCHMARKS
+
+void move_generation_benchmark(void);
+void simulator_benchmark(void);
+void batch_benchmark(void);
+void mcts_benchmark(void);
+void expectimax_benchmark(void);
+void risk_benchmark(void);
+void rollout_benchmark(void);
+
+#endif
@@ -0,0 +1,38 @@
+#include <chrono>
+#include <iostream>
+#include <sim/expectimax.hpp>
+#include "benchmarks.hpp"
+
+using namespace gerryfudd::sim;
+
+#define EXPECTIMAX_GAMES 2
+
+void expectimax_benchmark() {
+  ExpectimaxOptions options;
+  int wins = 0, cures = 0;
+  long turns = 0, nodes = 0, memo_hits = 0, cutoffs = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint64_t seed = 1; seed <= EXPECTIMAX_GAMES; seed++) {
+    ExpectimaxPolicy policy{options};
+    Simulator simulator{&policy};
+    GameResult result = simulator.play(easy, 4, seed);
+    wins += result.won;
+    cures += result.cures;
+    turns += result.turns;
+    nodes += policy.stats().nodes;
+    memo_hits += policy.stats().memo_hits;
+    cutoffs += policy.stats().cutoffs;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "Simulated games (expectimax policy)" << std::endl;
+  std::cout << "  games:             " << EXPECTIMAX_GAMES << std::endl;
+  std::cout << "  depth:             " << options.depth << std::endl;
+  std::cout << "  wins:              " << wins << std::endl;
+  std::cout << "  cures per game:    " << (double) cures / EXPECTIMAX_GAMES << std::endl;
+  std::cout << "  turns per game:    " << (double) turns / EXPECTIMAX_GAMES << std::endl;
+  std::cout << "  nodes per turn:    " << (double) nodes / turns << std::endl;
+  std::cout << "  memo hits:         " << memo_hits << std::endl;
+  std::cout << "  cutoffs:           " << cutoffs << std::endl;
+  std::cout << "  seconds per game:  " << elapsed.count() / EXPECTIMAX_GAMES << std::endl;
+}
@@ -0,0 +1,12 @@
+#include "benchmarks.hpp"
+
+int main() {
+  move_generation_benchmark();
+  simulator_benchmark();
+  batch_benchmark();
+  mcts_benchmark();
+  expectimax_benchmark();
+  risk_benchmark();
+  rollout_benchmark();
+  return 0;
+}
@@ -0,0 +1,38 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <sim/mcts.hpp>
+#include "benchmarks.hpp"
+
+using namespace gerryfudd::sim;
+
+#define MCTS_GAMES 2
+#define MCTS_ITERATIONS 1000
+#define MCTS_ROLLOUT_TURNS 2
+
+void mcts_benchmark() {
+  SearchOptions options;
+  options.iterations = MCTS_ITERATIONS;
+  options.rollout_turns = MCTS_ROLLOUT_TURNS;
+  options.threads = std::max(1u, std::thread::hardware_concurrency());
+  int wins = 0, cures = 0;
+  long turns = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint64_t seed = 1; seed <= MCTS_GAMES; seed++) {
+    MctsPolicy policy{options, seed};
+    Simulator simulator{&policy};
+    GameResult result = simulator.play(easy, 4, seed);
+    wins += result.won;
+    cures += result.cures;
+    turns += result.turns;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "Simulated games (tree search policy)" << std::endl;
+  std::cout << "  games:             " << MCTS_GAMES << std::endl;
+  std::cout << "  threads:           " << options.threads << std::endl;
+  std::cout << "  wins:              " << wins << std::endl;
+  std::cout << "  cures per game:    " << (double) cures / MCTS_GAMES << std::endl;
+  std::cout << "  turns per game:    " << (double) turns / MCTS_GAMES << std::endl;
+  std::cout << "  seconds per game:  " << elapsed.count() / MCTS_GAMES << std::endl;
+}
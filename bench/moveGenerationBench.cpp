@@ -0,0 +1,63 @@
+#include <chrono>
+#include <iostream>
+#include <game.hpp>
+#include "benchmarks.hpp"
+
+using namespace gerryfudd::core;
+using namespace gerryfudd::types;
+
+#define STATE_COUNT 256
+#define WARMUP_ACTIONS 24
+#define GENERATIONS_PER_STATE 2000
+
+// Play a seeded game forward with random actions and infections so that the
+// hands, pawns, research facilities and cubes look like they would mid-game.
+GameState random_mid_game_state(uint64_t seed) {
+  Game game{initialize_state(medium, 4, seed)};
+  random::Generator generator{seed};
+  MoveList choices;
+  for (int i = 0; i < WARMUP_ACTIONS; i++) {
+    const GameState &state = game.get_state();
+    player::Role role = state.players[i / 4 % state.players.size()].role;
+    TurnState turn_state{role, state.get_infection_rate()};
+    turn_state.event_cards_played = true;
+    get_player_choices(role, state, turn_state, &choices);
+    if (choices.size() > 0) {
+      game.apply(choices[generator.below(choices.size())], turn_state);
+    }
+    if (i % 4 == 3 && game.draw_infection_card()) {
+      break;
+    }
+  }
+  return game.get_state();
+}
+
+void move_generation_benchmark() {
+  std::vector<GameState> states;
+  for (uint64_t seed = 1; seed <= STATE_COUNT; seed++) {
+    states.push_back(random_mid_game_state(seed));
+  }
+
+  MoveList choices;
+  long total_moves = 0;
+  long total_generations = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (const GameState &state : states) {
+    for (int i = 0; i < GENERATIONS_PER_STATE; i++) {
+      player::Role role = state.players[i % state.players.size()].role;
+      TurnState turn_state{role, state.get_infection_rate()};
+      turn_state.event_cards_played = true;
+      get_player_choices(role, state, turn_state, &choices);
+      total_moves += choices.size();
+      total_generations++;
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "Move generation" << std::endl;
+  std::cout << "  states:            " << states.size() << std::endl;
+  std::cout << "  generations:       " << total_generations << std::endl;
+  std::cout << "  moves per state:   " << (double) total_moves / total_generations << std::endl;
+  std::cout << "  generations/sec:   " << total_generations / elapsed.count() << std::endl;
+  std::cout << "  moves/sec:         " << total_moves / elapsed.count() << std::endl;
+}
@@ -0,0 +1,22 @@
+#include <chrono>
+#include <iostream>
+#include <sim/risk.hpp>
+#include "benchmarks.hpp"
+
+using namespace gerryfudd::sim;
+
+#define RISK_ASSESSMENTS 20000
+
+void risk_benchmark() {
+  GameState game_state = initialize_state(hard, 4, 1);
+  std::cout << "Risk assessments" << std::endl;
+  for (int turns = 1; turns <= RISK_TURN_LIMIT; turns++) {
+    double loss = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < RISK_ASSESSMENTS; i++) {
+      loss += assess_risk(game_state, turns).outbreak_loss_probability;
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << turns << " turns:           " << elapsed.count() / RISK_ASSESSMENTS << " us (loss " << loss / RISK_ASSESSMENTS << ")" << std::endl;
+  }
+}
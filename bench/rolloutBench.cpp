@@ -0,0 +1,61 @@
+#include <chrono>
+#include <iostream>
+#include <sim/rollout.hpp>
+#include "benchmarks.hpp"
+
+using namespace gerryfudd::sim;
+
+#define ROLLOUTS 40000
+#define ROLLOUT_TURNS 8
+
+// Infection-only rollouts from just after the first epidemic, one Game at a
+// time and then BATCH_LANES at a time. Each rollout shuffles the layers of its
+// own deck.
+void rollout_benchmark() {
+  Game setup{initialize_state(hard, 4, 1)};
+  setup.epidemic();
+  GameState game_state = setup.get_state();
+  random::Generator generator{1};
+  long outbreaks = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROLLOUTS; i++) {
+    GameState copy = game_state;
+    int first = 0;
+    for (int layer = copy.infection_deck.layer_count() - 1; layer >= 0; layer--) {
+      copy.infection_deck.shuffle(first, first + copy.infection_deck.layer_size(layer), generator);
+      first += copy.infection_deck.layer_size(layer);
+    }
+    Game game{copy};
+    bool lost = false;
+    for (int turn = 0; turn < ROLLOUT_TURNS && !lost; turn++) {
+      for (int j = 0; j < game.get_state().get_infection_rate() && !lost; j++) {
+        lost = game.draw_infection_card();
+      }
+    }
+    outbreaks += game.get_state().outbreaks;
+  }
+  std::chrono::duration<double> single = std::chrono::steady_clock::now() - start;
+
+  long batch_outbreaks = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROLLOUTS; i += BATCH_LANES) {
+    GameBatch batch{game_state, generator};
+    for (int turn = 0; turn < ROLLOUT_TURNS; turn++) {
+      batch.infect();
+    }
+    for (int lane = 0; lane < BATCH_LANES; lane++) {
+      batch_outbreaks += batch.outbreaks(lane);
+    }
+  }
+  std::chrono::duration<double> batched = std::chrono::steady_clock::now() - start;
+
+  std::cout << "Infection rollouts" << std::endl;
+#ifdef __AVX2__
+  std::cout << "  kernel:            AVX2" << std::endl;
+#else
+  std::cout << "  kernel:            scalar" << std::endl;
+#endif
+  std::cout << "  game rollouts/sec: " << ROLLOUTS / single.count() << " (outbreaks " << (double) outbreaks / ROLLOUTS << ")" << std::endl;
+  std::cout << "  batch rollouts/sec: " << ROLLOUTS / batched.count() << " (outbreaks " << (double) batch_outbreaks / ROLLOUTS << ")" << std::endl;
+  std::cout << "  speedup:           " << single.count() / batched.count() << std::endl;
+}
@@ -0,0 +1,33 @@
+#include <chrono>
+#include <iostream>
+#include <sim/simulator.hpp>
+#include "benchmarks.hpp"
+
+using namespace gerryfudd::sim;
+
+#define SIMULATED_GAMES 20000
+
+void simulator_benchmark() {
+  RandomPolicy policy{1};
+  Simulator simulator{&policy};
+  int wins = 0;
+  long turns = 0;
+  int losses[player_cards + 1] = {};
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint64_t seed = 1; seed <= SIMULATED_GAMES; seed++) {
+    GameResult result = simulator.play(easy, 2 + seed % 3, seed);
+    wins += result.won;
+    losses[result.loss_reason]++;
+    turns += result.turns;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "Simulated games (random policy)" << std::endl;
+  std::cout << "  games:             " << SIMULATED_GAMES << std::endl;
+  std::cout << "  wins:              " << wins << std::endl;
+  for (int reason = outbreaks; reason <= player_cards; reason++) {
+    std::cout << "  lost to " << name_of((LossReason) reason) << ": " << losses[reason] << std::endl;
+  }
+  std::cout << "  turns per game:    " << (double) turns / SIMULATED_GAMES << std::endl;
+  std::cout << "  games/sec:         " << SIMULATED_GAMES / elapsed.count() << std::endl;
+}
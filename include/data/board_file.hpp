@@ -0,0 +1,45 @@
+#ifndef BOARD_FILE
+#define BOARD_FILE
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "types/city.hpp"
+
+#define BOARD_FILE_MAGIC 0x44524250
+#define BOARD_FILE_VERSION 1
+#define MAX_BOARD_FILE_CITIES 4096
+
+namespace gerryfudd::data::board {
+  // A binary board is a Header followed by city_count CityEntry records,
+  // edge_count EdgeEntry records and names_size bytes of city names, all
+  // little-endian. It is read in place through mmap.
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t city_count;
+    uint32_t edge_count;
+    uint32_t names_size;
+  };
+  struct CityEntry {
+    uint32_t population;
+    uint32_t name_offset;
+    uint16_t name_length;
+    uint8_t color;
+    uint8_t reserved;
+  };
+  struct EdgeEntry {
+    uint16_t a;
+    uint16_t b;
+  };
+
+  // The text form has one tab-separated record per line:
+  //   city <color> <population> <name>
+  //   edge <name> <name>
+  // Blank lines and lines starting with # are ignored.
+  void convert_board(std::istream&, std::ostream&);
+  void convert_board(const std::string&, const std::string&);
+  void load_board(const std::string&, types::city::Graph *);
+}
+
+#endif
@@ -1,21 +1,30 @@
 #ifndef GAME_TYPE
 #define GAME_TYPE
+#include <array>
 #include <filesystem>
-#include <map>
+#include <memory>
 #include <string>
-#include <functional>
 #include "types/disease.hpp"
+#include "types/fixed.hpp"
 #include "types/city.hpp"
 #include "types/card.hpp"
 #include "types/player.hpp"
+#include "types/random.hpp"
 
 #define BASE_EPIDEMIC_COUNT 4
-#define INFECTION_RATE_SIZE BASE_EPIDEMIC_COUNT + 3
+#define MAX_EPIDEMIC_COUNT (BASE_EPIDEMIC_COUNT + hard)
+#define INFECTION_RATE_SIZE (BASE_EPIDEMIC_COUNT + 3)
 #define INFECTION_RATE_ESCALATION { 2, 2, 2, 3, 3, 4, 4 }
 #define MIN_PLAYER_COUNT 2
 #define PLAYER_COUNT_OPTIONS 3
 #define HAND_SIZES { 4, 3, 2 }
 #define RESEARCH_FACILITY_COUNT 6
+#define OUTBREAK_LIMIT 10
+// Each outbreak before the limit pushes at most one placement per neighbor.
+#define OUTBREAK_STACK_CAPACITY (1 + OUTBREAK_LIMIT * (MAX_CITY_COUNT - 1))
+#define HAND_LIMIT 7
+#define MAX_MOVE_CARDS 5
+#define MAX_MOVES (32 * MAX_CITY_COUNT)
 
 #define CDC_LOCATION "Atlanta"
 
@@ -24,24 +33,62 @@ using namespace gerryfudd::types;
 namespace gerryfudd::core {
   enum Difficulty { easy, medium, hard };
   struct GameState {
-    std::map<disease::DiseaseColor, disease::DiseaseStatus> diseases;
-    std::map<std::string, city::City> cities;
-    std::map<std::string, city::CityState> board;
+    std::array<disease::DiseaseStatus, DISEASE_COLOR_COUNT> diseases;
+    std::shared_ptr<const city::Graph> cities;
+    city::Board board;
     std::vector<player::Player> players;
-    std::map<player::Role, std::string> player_locations;
+    std::array<city::CityId, ROLE_COUNT> player_locations;
     card::Deck infection_deck;
     card::Deck player_deck;
     card::Hand contingency_card;
+    // The size of each pile the player deck was built from, top first. Each
+    // pile was shuffled with one epidemic card.
+    fixed::Vector<int, MAX_EPIDEMIC_COUNT> epidemic_piles;
     int outbreaks;
     int infection_rate_level;
     int research_facility_reserve;
+    random::Generator generator;
+    // The cities where no cubes of each color may be placed because of the
+    // Quarantine Specialist or the Medic. Code that changes player_locations or
+    // cures directly must call update_protection() afterwards.
+    std::array<city::CitySet, DISEASE_COLOR_COUNT> protected_cities;
+    // The fewest drives from each city to a research facility. Kept current by
+    // Game::place_research_facility; direct changes to the board must call
+    // update_facility_distances() afterwards.
+    std::array<uint8_t, MAX_CITY_COUNT> facility_distances;
+    // The Zobrist hash of the pawn locations, hands and contingency card. The
+    // board and infection discard keep their own hashes; hash() combines them.
+    uint64_t position_hash;
     GameState();
-    int get_infection_rate(void);
-    player::Player get_player(player::Role);
+    GameState(city::Graph);
+    GameState(std::shared_ptr<const city::Graph>);
+    int get_infection_rate(void) const;
+    const player::Player& get_player(player::Role) const;
+    player::Player& get_player(player::Role);
     void add_card(player::Role, card::Card);
-    card::Card remove_card(player::Role, std::string);
-    bool prevent_placement(std::string, disease::DiseaseColor);
+    card::Card remove_card(player::Role, card::Card);
+    void update_protection(void);
+    void update_facility_distances(void);
+    void update_hash(void);
+    uint64_t hash(void) const;
+    uint64_t compute_hash(void) const;
+    int distance_to_research_facility(city::CityId) const;
+    bool prevent_placement(city::CityId, disease::DiseaseColor) const;
+    bool eradicated(disease::DiseaseColor) const;
   };
+  // A read-only handle on a GameState. Code that only inspects the game, such as
+  // the player choice generators, takes a view so that it never copies the state.
+  class GameStateView {
+    const GameState *state;
+  public:
+    GameStateView(const GameState&);
+    const GameState& operator*(void) const;
+    const GameState *operator->(void) const;
+  };
+  // Sets up a game on the given board with the first research facility and
+  // every pawn in the given city.
+  GameState initialize_state(std::shared_ptr<const city::Graph>, city::CityId, Difficulty, int, uint64_t);
+  GameState initialize_state(Difficulty, int, uint64_t);
   GameState initialize_state(Difficulty, int);
   GameState initialize_state(void); 
   struct TurnState {
@@ -50,59 +97,138 @@ namespace gerryfudd::core {
     int remaining_actions;
     int remaining_player_card_draws;
     int remaining_infection_card_draws;
+    // The Operations Expert's flight from a research facility is once per turn.
+    bool company_plane_used;
     TurnState(player::Role, int);
   };
+  enum MoveType { play_event, take_action };
+  // One decision available to a player. Moves are plain values so that they can
+  // be generated in bulk into a MoveList; describe() renders the text for one on
+  // demand and Game::apply() carries it out.
+  struct Move {
+    MoveType type;
+    player::Role role;
+    card::CardType event;
+    player::ActionType action;
+    player::Role target_role;
+    city::CityId target_city;
+    city::CityId source_city;
+    disease::DiseaseColor color;
+    bool from_contingency_card;
+    card::Card cards[MAX_MOVE_CARDS];
+    bool operator==(const Move&) const = default;
+  };
+  typedef fixed::Vector<Move, MAX_MOVES> MoveList;
+
+  enum ChangeType {
+    cube_change, reserve_change, cure_change, outbreak_change, infection_rate_change,
+    facility_change, facility_reserve_change, location_change, contingency_change,
+    card_gained, card_lost, deck_drawn, deck_discarded, discard_removed, deck_shuffled, layer_shuffled, generator_change
+  };
+  // One primitive change to a GameState along with what it replaced. The
+  // subject is the color, role or deck type it applies to and the value holds
+  // the old count or flag, or the position a card was taken from. A drawn card
+  // also notes the deck layer it was taken from.
+  struct Change {
+    ChangeType type;
+    int subject;
+    city::CityId city;
+    card::Card card;
+    uint8_t layer;
+    int value;
+  };
+  // Everything needed to take the game back to an earlier point: how much of
+  // the journal had been written then and the turn in progress.
+  struct Undo {
+    size_t mark;
+    TurnState turn_state;
+  };
+
   class Game {
     GameState state;
-    int place(std::string, disease::DiseaseColor, int);
-    int place(std::string, int);
-    bool place_disease(std::string, disease::DiseaseColor, std::vector<std::string>&);
+    // Every change made through Game is journaled so that undo() can reverse it
+    // in place. Generator states are kept aside since they are larger.
+    std::vector<Change> journal;
+    std::vector<random::Generator> saved_generators;
+    void record(ChangeType, int, city::CityId, card::Card, int);
+    void revert(const Change&);
+    card::Deck& deck(card::DeckType);
+    void set_cube_count(city::CityId, disease::DiseaseColor, int);
+    void set_reserve(disease::DiseaseColor, int);
+    void set_cured(disease::DiseaseColor);
+    void set_research_facility(city::CityId, bool);
+    void set_contingency_card(int, card::Card);
+    void hold_contingency_card(int, card::Card);
+    void relocate(player::Role, city::CityId);
+    void add_player_card(player::Role, card::Card);
+    card::Card draw(card::DeckType, int);
+    void shuffle_discard(card::DeckType);
+    void play_event_card(const Move&);
+    int place(city::CityId, disease::DiseaseColor, int);
+    int place(city::CityId, int);
+    bool place_disease(city::CityId, disease::DiseaseColor);
   public:
-    static int infection_rate_escalation[INFECTION_RATE_SIZE];
-    static int hand_sizes[PLAYER_COUNT_OPTIONS];
+    static constexpr int infection_rate_escalation[INFECTION_RATE_SIZE] = INFECTION_RATE_ESCALATION;
+    static constexpr int hand_sizes[PLAYER_COUNT_OPTIONS] = HAND_SIZES;
     Game();
     Game(GameState);
     void discard(card::Card);
-    void remove_from_discard(card::Card);
-    GameState get_state(void);
-    void place_research_facility(std::string);
-    void place_research_facility(std::string, std::string);
-    card::Card remove_player_card(player::Role, std::string);
+    card::Card remove_from_discard(card::Card);
+    const GameState& get_state(void) const;
+    void place_research_facility(city::CityId);
+    void place_research_facility(city::CityId, city::CityId);
+    card::Card remove_player_card(player::Role, card::Card);
+    card::Card remove_player_card(player::Role, city::CityId);
     void remove_contingency_card(void);
     bool draw_infection_card(void);
+    // Draws the card at a position from the top of the infection deck, as a
+    // search does to follow one outcome of a draw.
+    bool draw_infection_card(int);
+    // Shuffles the layer holding a position if it is stacked, as drawing from
+    // it would, so that a search can tell its cards apart by position.
+    void shuffle_layer(card::DeckType, int);
 
-    void drive(player::Role, std::string);
-    void direct_flight(player::Role, std::string);
-    void charter_flight(player::Role, std::string);
-    void shuttle(player::Role, std::string);
+    void drive(player::Role, city::CityId);
+    void direct_flight(player::Role, city::CityId);
+    void charter_flight(player::Role, city::CityId);
+    void shuttle(player::Role, city::CityId);
 
-    void dispatcher_direct_flight(player::Role, std::string);
-    void dispatcher_charter_flight(player::Role, std::string);
+    void dispatcher_direct_flight(player::Role, city::CityId);
+    void dispatcher_charter_flight(player::Role, city::CityId);
     void dispatcher_conference(player::Role, player::Role);
 
-    void move(player::Role, std::string);
+    void move(player::Role, city::CityId);
 
     void treat(player::Role, disease::DiseaseColor);
     void share(player::Role, player::Role);
-    void researcher_share(std::string, player::Role);
-    void cure(player::Role, std::string[5]);
-    void scientist_cure(std::string[4]);
+    void researcher_share(city::CityId, player::Role);
+    void cure(player::Role, city::CityId[5]);
+    void scientist_cure(city::CityId[4]);
 
-    void reclaim(std::string);
+    void reclaim(card::Card);
 
-    void company_plane(std::string, std::string);
+    void company_plane(city::CityId, city::CityId);
 
     bool epidemic(void);
+    // Resolves an epidemic with the infection card at a position in place of
+    // the bottom card, -1.
+    bool epidemic(int);
 
     bool draw_player_card(player::Role);
-  };
+    bool draw_player_card(player::Role, int);
 
-  struct PlayerChoice {
-    std::string prompt;
-    std::function<bool(Game&, TurnState&)> effect;
+    // Applies a move and returns the record that undo() needs to take it back.
+    Undo apply(const Move&, TurnState&);
+    // A record of the current point, for undoing draws and infections.
+    Undo checkpoint(const TurnState&) const;
+    // Reverses every change made since the record was taken. Records taken
+    // after it are invalidated.
+    void undo(const Undo&);
+    void undo(const Undo&, TurnState&);
   };
 
-  std::vector<PlayerChoice> get_player_choices(player::Role, GameState, TurnState);
+  void get_player_choices(player::Role, GameStateView, const TurnState&, MoveList*);
+  std::string describe(const Move&, GameStateView);
 }
 
 #endif
@@ -0,0 +1,75 @@
+#ifndef BATCH
+#define BATCH
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "sim/simulator.hpp"
+
+#define DIFFICULTY_COUNT 3
+#define BATCH_CHUNK_SIZE 64
+
+namespace gerryfudd::sim {
+  // Builds the policy for one game from that game's seed.
+  typedef std::function<std::unique_ptr<Policy>(uint64_t)> PolicyFactory;
+  std::unique_ptr<Policy> random_policy(uint64_t);
+
+  // The setup of game i of a batch is derived from the batch seed and i alone,
+  // so a batch plays the same games however its work is divided among threads.
+  struct GameSetup {
+    Difficulty difficulty;
+    int player_count;
+    uint64_t seed;
+  };
+  GameSetup game_setup(uint64_t, uint32_t);
+
+  struct BatchSummary {
+    std::array<std::array<long, PLAYER_COUNT_OPTIONS>, DIFFICULTY_COUNT> games;
+    std::array<std::array<long, PLAYER_COUNT_OPTIONS>, DIFFICULTY_COUNT> wins;
+    std::array<long, player_cards + 1> losses;
+    // outbreak_counts[k] is the number of games that ended with k outbreaks.
+    std::array<long, OUTBREAK_LIMIT + 1> outbreak_counts;
+    // The number of games with a k-th epidemic and the sum of the turns it came on.
+    std::array<long, MAX_EPIDEMIC_COUNT> epidemic_counts;
+    std::array<long, MAX_EPIDEMIC_COUNT> epidemic_turn_totals;
+    long turns;
+    BatchSummary();
+    void add(const GameSetup&, const GameResult&);
+    void merge(const BatchSummary&);
+    long game_count(void) const;
+    long win_count(void) const;
+    double win_rate(void) const;
+    double win_rate(Difficulty, int) const;
+    double mean_epidemic_turn(int) const;
+    bool operator==(const BatchSummary&) const = default;
+  };
+
+  // The games a worker has yet to play, packed as [begin, end) into one word so
+  // that the owner taking from the front and thieves splitting off the back
+  // both claim work with a single compare-and-swap.
+  class WorkRange {
+    std::atomic<uint64_t> bounds;
+  public:
+    WorkRange();
+    void reset(uint32_t, uint32_t);
+    bool take(uint32_t, uint32_t*, uint32_t*);
+    bool steal_into(WorkRange*);
+  };
+
+  // Plays batches of independent games on a fixed number of threads. Each
+  // thread starts with an even share of the games, takes them a chunk at a
+  // time, and steals half of another thread's remaining share once its own is
+  // done. Results are accumulated per thread and merged once the threads finish.
+  class BatchRunner {
+    int thread_count;
+    PolicyFactory policy_factory;
+  public:
+    BatchRunner();
+    BatchRunner(int);
+    BatchRunner(int, PolicyFactory);
+    BatchSummary run(uint32_t, uint64_t);
+  };
+}
+
+#endif
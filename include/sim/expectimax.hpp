@@ -0,0 +1,88 @@
+#ifndef EXPECTIMAX
+#define EXPECTIMAX
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "sim/simulator.hpp"
+
+#define MEMO_LIMIT (1 << 20)
+
+namespace gerryfudd::sim {
+  struct ExpectimaxOptions {
+    // The actions searched before the end of the turn's draws. Actions past
+    // this depth are not taken.
+    int depth;
+    // Outcomes reached with less than this probability are evaluated where
+    // they stand instead of drawing further.
+    double probability_threshold;
+    ExpectimaxOptions();
+  };
+
+  struct ExpectimaxStats {
+    long nodes;
+    long memo_hits;
+    long cutoffs;
+    ExpectimaxStats();
+  };
+
+  // The draws that lead to the same kind of position: the position of one card
+  // that produces it and how many of the cards that may be drawn would.
+  struct Outcome {
+    int group;
+    int position;
+    int count;
+  };
+  typedef fixed::Vector<Outcome, DECK_CAPACITY> Outcomes;
+  // The outcomes of the next player card, the bottom infection card of an
+  // epidemic and the next infection card, with the total their counts are out
+  // of. The player card is the pile's epidemic with chance one in the cards
+  // left in the pile, if it hasn't been drawn, and otherwise any other undrawn
+  // card. Infection cards come from the bottom and the top infection layer.
+  int player_outcomes(const GameState&, Outcomes*);
+  int epidemic_outcomes(const GameState&, Outcomes*);
+  int infection_outcomes(const GameState&, Outcomes*);
+
+  // What is known of a chance node's value from an earlier visit, which may
+  // only be a bound if the search window cut it short.
+  enum Bound { exact, lower_bound, upper_bound };
+  struct MemoEntry {
+    double value;
+    Bound bound;
+  };
+
+  // Chooses the active player's actions by depth-limited expectimax. The
+  // actions are max nodes and the end of the turn is a run of chance nodes:
+  // the two player cards, the infection card an epidemic takes from the bottom
+  // of the deck and the infection cards drawn at the infection rate. Outcomes
+  // are weighted by what the players know of the decks: when the epidemic in
+  // the pile being drawn is due, and how many of the other undrawn player cards
+  // or the cards of the top or bottom infection layer produce them. Player cards are grouped by color and
+  // infection cards by the color and cube count of their city, except that a
+  // city that would break out is its own outcome. Chance nodes are pruned with
+  // Star1 bounds, since every value lies between 0 and 1, and their values are
+  // memoized by the position's hash for the rest of the search so that draws
+  // that arrive at the same position in a different order are only searched
+  // once.
+  class ExpectimaxPolicy: public Policy {
+    ExpectimaxOptions options;
+    ExpectimaxStats search_stats;
+    std::unordered_map<uint64_t, MemoEntry> memo;
+    // The moves offered at each depth, kept between searches.
+    std::vector<MoveList> levels;
+    bool recall(uint64_t, double, double, double*);
+    void remember(uint64_t, double, double, double);
+    double decide(Game&, TurnState&, int, double, double, double);
+    double draw_stage(Game&, const TurnState&, double, double, double);
+    double draw_player_cards(Game&, const TurnState&, double, double, double);
+    double resolve_epidemic(Game&, const TurnState&, double, double, double);
+    double draw_infection_cards(Game&, const TurnState&, double, double, double);
+  public:
+    ExpectimaxPolicy();
+    ExpectimaxPolicy(ExpectimaxOptions);
+    int choose(const MoveList&, GameStateView, const TurnState&) override;
+    card::Card choose_discard(player::Role, GameStateView) override;
+    const ExpectimaxStats& stats(void) const;
+  };
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef MCTS
+#define MCTS
+#include <cstdint>
+#include <vector>
+#include "sim/simulator.hpp"
+
+#define NO_NODE -1
+
+namespace gerryfudd::sim {
+  // How long a search may run and how it spends that time. A search stops at
+  // whichever of the iteration and time budgets runs out first; a budget of
+  // zero is no limit, though one of them must be set.
+  struct SearchOptions {
+    int iterations;
+    int milliseconds;
+    // Each thread searches its own tree and their root statistics are summed.
+    int threads;
+    double exploration;
+    // Rollouts stop after this many turns, or play to the end at NO_TURN_LIMIT.
+    int rollout_turns;
+    SearchOptions();
+  };
+
+  // One decision in a search tree, reached by the move or pass on its edge.
+  // Chance is not branched on, so a node stands for every deal that leads to
+  // it, and a child only counts as available on the visits whose deal offered it.
+  struct Node {
+    Move move;
+    bool pass;
+    int first_child;
+    int next_sibling;
+    int visits;
+    int availability;
+    double value;
+    // Who faced the decision at this node, for checking that a reused tree
+    // is still in step with the game.
+    bool decided;
+    player::Role chooser;
+    bool event_cards_played;
+    int remaining_actions;
+  };
+
+  class SearchTree {
+    std::vector<Node> nodes;
+    std::vector<Node> spare;
+    void copy_subtree(int, int);
+  public:
+    SearchTree();
+    void clear(void);
+    int root(void) const;
+    Node& operator[](int);
+    const Node& operator[](int) const;
+    int add_child(int, const Move*);
+    int find_child(int, const Move*) const;
+    int size(void) const;
+    // Makes a child the new root, dropping the rest of the tree.
+    void advance(int);
+  };
+
+  // Picks moves by Monte Carlo tree search over the decisions of every player,
+  // with UCT selection. Each iteration deals the hidden cards of the current
+  // position at random and plays it out: through the tree while every offered
+  // move has been tried, then with a light rollout policy. The tree is kept
+  // from one choice to the next as long as the game follows it.
+  class MctsPolicy: public Policy {
+    SearchOptions options;
+    std::vector<SearchTree> trees;
+    std::vector<random::Generator> generators;
+    void search(int, const MoveList&, const GameState&, const TurnState&);
+    void align(const MoveList&, const TurnState&);
+  public:
+    MctsPolicy(SearchOptions, uint64_t);
+    int choose(const MoveList&, GameStateView, const TurnState&) override;
+    card::Card choose_discard(player::Role, GameStateView) override;
+    // The visits already below the root, summed across threads.
+    int root_visits(void) const;
+  };
+
+  // Randomizes what the players can't see: the order of the undrawn cards
+  // within each infection layer, which epidemic pile each undrawn player card
+  // other than the epidemics is in and where in its pile each epidemic still
+  // to come is, and the generator that will shuffle them.
+  void determinize(GameState*, random::Generator&);
+  // The value of where a playout ended: 1 for a win, otherwise the evaluation
+  // of the position, halved if the game was lost.
+  double score(const GameState&, const GameResult&);
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef RISK
+#define RISK
+#include <array>
+#include "game.hpp"
+
+#define RISK_TURN_LIMIT 4
+// A city's outbreaks are counted up to this many.
+#define RISK_OUTBREAK_CAP 3
+
+namespace gerryfudd::sim {
+  using namespace gerryfudd::core;
+
+  struct RiskReport {
+    int turns;
+    // The chance that at least one epidemic is drawn.
+    double epidemic_probability;
+    // The chance that each city's infection card is drawn, including as the
+    // bottom card of an epidemic.
+    std::array<double, MAX_CITY_COUNT> draw_probability;
+    // The chance that each city breaks out from its own card being drawn.
+    std::array<double, MAX_CITY_COUNT> outbreak_probability;
+    // The chance that the outbreaks reach OUTBREAK_LIMIT.
+    double outbreak_loss_probability;
+    RiskReport();
+  };
+
+  // The risks over the draws of the given number of turns, starting with the
+  // current turn's player cards, from what the players can see: the cards in
+  // each layer of the infection deck and the discard pile, and how many cards
+  // are left in the player deck's epidemic piles. Every placement of the
+  // epidemics among the piles is weighed by its probability. Within one, the
+  // cards of a layer are equally likely to be in any order, so a card's chance
+  // of being drawn follows from the layer sizes alone, and cities that start
+  // in the same layer with the same cubes share their odds.
+  //
+  // Cubes are only placed by a city's own cards: outbreaks don't spread cubes
+  // to the neighbors and the pawns and cures are taken to stay as they are.
+  // For the loss, each outbreak is counted with the chain it would set off on
+  // the current board and cities break out independently of one another.
+  RiskReport assess_risk(const GameState&, int);
+}
+
+#endif
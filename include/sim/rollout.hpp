@@ -0,0 +1,59 @@
+#ifndef ROLLOUT
+#define ROLLOUT
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "game.hpp"
+
+// The games in a batch. A multiple of 8 so that each group of lanes fills an
+// AVX2 register of 32 bit counts.
+#define BATCH_LANES 8
+
+namespace gerryfudd::sim {
+  using namespace gerryfudd::core;
+
+  typedef std::array<int32_t, BATCH_LANES> Lanes;
+
+  // BATCH_LANES copies of a game that play out the infection deck side by side,
+  // stored as structures of arrays: each count is kept for every lane at once
+  // so that a draw in all of the games is a handful of vector operations.
+  // Outbreak chains are irregular and are resolved one lane at a time.
+  //
+  // Only the infection step is played. The pawns and cures stay as they were,
+  // so the cities where cubes can't be placed are shared by every lane. A lane
+  // stops once its game is lost, and draws nothing once its deck is empty.
+  class GameBatch {
+    std::shared_ptr<const city::Graph> cities;
+    // The count of city c's cubes of color k in lane l is at
+    // ((c * DISEASE_COLOR_COUNT) + k) * BATCH_LANES + l.
+    std::vector<int32_t> cube_lanes;
+    // Nonzero at c * DISEASE_COLOR_COUNT + k where that color is prevented.
+    std::vector<int32_t> prevented;
+    std::vector<int32_t> city_colors;
+    std::array<Lanes, DISEASE_COLOR_COUNT> reserve_lanes;
+    Lanes outbreak_lanes;
+    Lanes rate_lanes;
+    Lanes lost_lanes;
+    // Each lane's undrawn infection cards, top last.
+    std::array<fixed::Vector<city::CityId, DECK_CAPACITY>, BATCH_LANES> decks;
+    void place_disease(int, city::CityId, disease::DiseaseColor);
+    void draw(const Lanes&);
+  public:
+    // Every lane starts from the state, with its infection deck in the same order.
+    GameBatch(const GameState&);
+    // Every lane starts from the state, with each layer of its infection deck
+    // shuffled separately.
+    GameBatch(const GameState&, random::Generator&);
+    // Draws each lane's infection cards at its infection rate.
+    void infect(void);
+    int cube_count(int, city::CityId, disease::DiseaseColor) const;
+    int reserve(int, disease::DiseaseColor) const;
+    int outbreaks(int) const;
+    int infection_rate_level(int) const;
+    int remaining(int) const;
+    bool lost(int) const;
+  };
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef SIMULATOR
+#define SIMULATOR
+#include <cstdint>
+#include <memory>
+#include "game.hpp"
+
+#define NO_MOVE -1
+#define NO_TURN_LIMIT 0
+
+namespace gerryfudd::sim {
+  using namespace gerryfudd::core;
+
+  // Decides every choice a simulated game needs. choose() returns an index into
+  // the moves it is offered, or NO_MOVE to pass on playing an event or to give
+  // up the rest of the turn's actions.
+  class Policy {
+  public:
+    virtual ~Policy() = default;
+    virtual int choose(const MoveList&, GameStateView, const TurnState&) = 0;
+    virtual card::Card choose_discard(player::Role, GameStateView) = 0;
+  };
+
+  // Picks uniformly among the legal moves. Events are passed on with the same
+  // probability as any single event move.
+  class RandomPolicy: public Policy {
+    random::Generator generator;
+  public:
+    RandomPolicy();
+    RandomPolicy(uint64_t);
+    int choose(const MoveList&, GameStateView, const TurnState&) override;
+    card::Card choose_discard(player::Role, GameStateView) override;
+  };
+
+  enum LossReason { no_loss, outbreaks, disease_cubes, player_cards };
+  std::string name_of(LossReason);
+
+  struct GameResult {
+    bool won;
+    LossReason loss_reason;
+    int turns;
+    int outbreaks;
+    int cures;
+    // The turn on which each epidemic was drawn, in order.
+    fixed::Vector<int, MAX_EPIDEMIC_COUNT> epidemic_turns;
+    GameResult();
+  };
+
+  // Plays complete games headlessly: on each turn the policy may play events,
+  // takes up to four actions, then the active player draws two player cards,
+  // resolving epidemics and the hand limit, and the infection deck is drawn at
+  // the current infection rate. The game ends as soon as it is won or lost.
+  class Simulator {
+    Policy *policy;
+    int turn_limit;
+    // A move list can be too large for a thread's stack on a big board, so
+    // each simulator keeps one on the heap and reuses it from game to game.
+    std::unique_ptr<MoveList> move_buffer;
+    void play_events(Game&, TurnState&, int, MoveList*);
+    void enforce_hand_limit(Game&);
+  public:
+    Simulator(Policy*);
+    // Stops after the given number of turns, leaving the game neither won nor lost.
+    Simulator(Policy*, int);
+    // Plays later games with another policy, keeping the move buffer.
+    void set_policy(Policy*);
+    GameResult play(GameState);
+    GameResult play(Difficulty, int, uint64_t);
+    // Continues a game from the choice the given player faces in the turn in
+    // progress. Turns are counted from that one.
+    GameResult play(Game&, TurnState, player::Role);
+  };
+
+  player::Role next_role(const GameState&, player::Role);
+  int count_cures(const GameState&);
+  // A heuristic value of a position from 0 to 1 for searches that stop short
+  // of the end of the game. Each cure counts most, then the outbreaks avoided,
+  // the cubes left in reserve and the cards gathered toward the remaining cures.
+  double evaluate(const GameState&);
+  // Discards a card of the color the player holds the fewest of.
+  card::Card weakest_card(player::Role, GameStateView);
+}
+
+#endif
@@ -1,7 +1,11 @@
 #ifndef CARD_TYPE
 #define CARD_TYPE
+#include <cstdint>
 #include <string>
-#include <vector>
+#include "types/city.hpp"
+#include "types/fixed.hpp"
+#include "types/random.hpp"
+#include "types/zobrist.hpp"
 
 #define ONE_QUIET_NIGHT "One Quiet Night"
 #define RESILIENT_POPULATION "Resilient Population"
@@ -9,44 +13,107 @@
 #define AIRLIFT "Airlift"
 #define EPIDEMIC "Epidemic"
 
+#if MAX_CITY_COUNT < 128
+#define NO_CARD 0xFF
+#define INFECTION_CARD_FLAG 0x80
+#else
+#define NO_CARD 0xFFFF
+#define INFECTION_CARD_FLAG 0x8000
+#endif
+#define HAND_CAPACITY 16
+#define DECK_CAPACITY (2 * MAX_CITY_COUNT)
+#define MAX_DECK_LAYERS 32
+
 namespace gerryfudd::types::card {
   enum DeckType { player, infect };
   std::string name_of(DeckType);
   enum CardType { one_quiet_night, resilient_population, government_grant, airlift, epidemic, city };
   std::string name_of(CardType);
+#if MAX_CITY_COUNT < 128
+  typedef uint8_t CardId;
+#else
+  typedef uint16_t CardId;
+#endif
+
+  static_assert(MAX_CITY_COUNT + city < INFECTION_CARD_FLAG, "Card ids must leave room for the infection deck flag.");
+
+  // A card is a single byte, or two on builds for boards of 128 or more cities.
+  // City cards use the id of their city and the other player cards use
+  // MAX_CITY_COUNT + their CardType. Infection cards are city cards with
+  // INFECTION_CARD_FLAG set. Names are only looked up for display.
   struct Card {
-    std::string name;
-    DeckType deck_type;
-    CardType type;
-    Card(std::string, DeckType);
-    Card(std::string, DeckType, CardType);
+    CardId id;
+    Card();
+    Card(city::CityId, DeckType);
+    Card(CardType);
+    CardType type(void) const;
+    DeckType deck_type(void) const;
+    city::CityId city_id(void) const;
+    bool operator==(const Card&) const = default;
   };
+  std::string name_of(Card, const city::Graph&);
+
   struct Hand {
     DeckType deck_type;
-    std::vector<Card> contents;
+    fixed::Vector<Card, HAND_CAPACITY> contents;
     Hand(DeckType);
-    friend std::ostream& operator<<(std::ostream&, const Hand&);
   };
-  bool contains(Hand, std::string);
-  int random(int);
+  std::string to_string(const Hand&, const city::Graph&);
+  bool contains(const Hand&, Card);
+
+  // The undrawn cards are held top-last in a ring buffer so that drawing from
+  // either the top or the bottom of the deck and revealing any position are
+  // constant time.
+  //
+  // Each shuffle of the discard pile puts a layer of cards on top of the deck
+  // whose members are public though their order is not. The layer sizes are
+  // kept bottom first, including layers that have been drawn out, so that a
+  // draw can be put back into the layer it came from. A layer can be stacked
+  // without shuffling it, leaving the shuffle until a card is first drawn from
+  // it.
   class Deck {
-    std::vector<Card> contents;
-    std::vector<Card> discard_contents;
+    fixed::Deque<Card, DECK_CAPACITY> contents;
+    fixed::Vector<Card, DECK_CAPACITY> discard_contents;
+    fixed::Vector<int, MAX_DECK_LAYERS> layers;
+    fixed::Vector<bool, MAX_DECK_LAYERS> stacked;
     DeckType deck_type;
+    uint64_t discard_hash;
   public:
     Deck(DeckType);
     void discard(Card);
-    void shuffle(void);
-    void shuffle(int, int);
+    void shuffle(random::Generator&);
+    void shuffle(int, int, random::Generator&);
+    // Puts the discard pile on top as a new layer in the order it was discarded.
+    void stack(void);
+    // Whether a layer is still in the order it was stacked in.
+    bool is_stacked(int) const;
+    void shuffle_layer(int, random::Generator&);
+    // Puts a layer back in stacked order, given the generator it was shuffled
+    // with.
+    void unshuffle_layer(int, random::Generator);
+    // Inserts into the layer of the card at the position, or the bottom layer.
     void insert(Card, int);
+    void insert(Card, int, int);
     Card draw(void);
     Card draw(int);
-    Card reveal(int);
-    int size(void);
-    int remaining(void);
+    Card reveal(int) const;
+    int size(void) const;
+    int remaining(void) const;
     void clear(void);
-    std::vector<Card> get_discard_contents(void);
-    Card remove_from_discard(std::string);
+    int layer_count(void) const;
+    int layer_size(int) const;
+    // The layer holding the card at a position, or the bottom card at -1.
+    int layer_of(int) const;
+    // Takes back the last shuffle or stack, whose cards are still the top layer.
+    void unshuffle(void);
+    const fixed::Vector<Card, DECK_CAPACITY>& get_discard_contents(void) const;
+    // The Zobrist hash of the set of cards in the discard pile.
+    uint64_t get_discard_hash(void) const;
+    Card remove_from_discard(Card);
+    // Remove or put back the discard at a position, bottom first, so that a
+    // discard pile can be restored exactly.
+    Card take_from_discard(int);
+    void return_to_discard(Card, int);
     Card draw_and_discard(int);
     Card draw_and_discard(void);
   };
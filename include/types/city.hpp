@@ -1,24 +1,134 @@
 #ifndef CITY_TYPES
 #define CITY_TYPES
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
 #include <vector>
 #include <map>
 #include "types/disease.hpp"
+#include "types/zobrist.hpp"
+
+// Builds for larger boards pass -DMAX_CITY_COUNT=<a power of two>. City ids
+// widen to 16 bits past 255 cities and CitySets grow by one word per 64 cities.
+#ifndef MAX_CITY_COUNT
+#define MAX_CITY_COUNT 64
+#endif
+#if MAX_CITY_COUNT < 256
+#define NO_CITY 0xFF
+#else
+#define NO_CITY 0xFFFF
+#endif
+#define CITY_SET_WORDS (MAX_CITY_COUNT / 64)
+#define DISEASE_COLOR_COUNT 4
+#define MAX_CUBES_PER_CITY 3
+#define NO_PATH 255
 
 namespace gerryfudd::types::city {
+#if MAX_CITY_COUNT < 256
+  typedef uint8_t CityId;
+#else
+  typedef uint16_t CityId;
+#endif
+  static_assert(MAX_CITY_COUNT >= 64 && (MAX_CITY_COUNT & (MAX_CITY_COUNT - 1)) == 0, "MAX_CITY_COUNT must be a power of two of at least 64.");
+  static_assert(MAX_CITY_COUNT <= 4096, "Boards are limited to 4096 cities.");
+
   struct City {
     std::string name;
     disease::DiseaseColor color;
     int population;
-    std::vector<City> neighbors;
+    // A view into the adjacency array of the Graph that owns this city.
+    std::span<const CityId> neighbors;
     City();
     City(std::string, disease::DiseaseColor, int);
-    friend void attach(City *, City *);
   };
 
-  struct CityState {
-    std::map<disease::DiseaseColor, int> disease_count;
-    bool research_facility;
-    CityState();
+  // A set of cities on a board of at most MAX_CITY_COUNT cities, one bit per CityId.
+  class CitySet {
+    std::array<uint64_t, CITY_SET_WORDS> words;
+  public:
+    class iterator {
+      const uint64_t *words;
+      int word;
+      uint64_t remaining;
+      void skip_empty_words(void);
+    public:
+      iterator(const uint64_t*, int);
+      CityId operator*(void) const;
+      iterator& operator++(void);
+      bool operator!=(const iterator&) const;
+    };
+    CitySet();
+    bool contains(CityId) const;
+    void insert(CityId);
+    void erase(CityId);
+    int size(void) const;
+    bool empty(void) const;
+    iterator begin(void) const;
+    iterator end(void) const;
+    CitySet operator&(const CitySet&) const;
+    CitySet operator|(const CitySet&) const;
+    CitySet operator~(void) const;
+    bool operator==(const CitySet&) const = default;
+  };
+
+  // The disease cubes and research facilities on the board. Each city's cube
+  // counts are packed into a single byte, 2 bits per color, and the cities that
+  // have any cubes or are at MAX_CUBES_PER_CITY of each color are tracked as
+  // CitySets so that outbreak and eradication checks are single mask operations.
+  class Board {
+    std::array<uint8_t, MAX_CITY_COUNT> cubes;
+    std::array<CitySet, DISEASE_COLOR_COUNT> infected_cities;
+    std::array<CitySet, DISEASE_COLOR_COUNT> saturated_cities;
+    CitySet research_facilities;
+    uint64_t zobrist_hash;
+  public:
+    Board();
+    int cube_count(CityId, disease::DiseaseColor) const;
+    int cube_count(CityId) const;
+    void set_cube_count(CityId, disease::DiseaseColor, int);
+    CitySet infected(disease::DiseaseColor) const;
+    CitySet saturated(disease::DiseaseColor) const;
+    bool research_facility(CityId) const;
+    void set_research_facility(CityId, bool);
+    CitySet research_facility_locations(void) const;
+    // The Zobrist hash of the cubes and research facilities, kept up to date by
+    // the setters.
+    uint64_t hash(void) const;
+  };
+
+  // The cities of a board indexed by CityId. Neighbors are kept in a compressed
+  // adjacency array: the neighbors of city i are neighbor_ids[neighbor_offsets[i]]
+  // through neighbor_ids[neighbor_offsets[i + 1] - 1]. A graph is built once and
+  // then shared read-only by every GameState that is played on it. The number of
+  // drives between every pair of cities is kept up to date as cities are attached.
+  class Graph {
+    std::vector<City> cities;
+    std::vector<int> neighbor_offsets;
+    std::vector<CityId> neighbor_ids;
+    std::map<std::string, CityId> ids_by_name;
+    // Row-major, MAX_CITY_COUNT entries per row.
+    std::vector<uint8_t> distances;
+    void link(void);
+  public:
+    Graph();
+    Graph(const Graph&);
+    Graph(Graph&&) = default;
+    Graph& operator=(const Graph&);
+    Graph& operator=(Graph&&) = default;
+    CityId add(City);
+    void attach(CityId, CityId);
+    // Replaces an empty graph with prebuilt adjacency arrays and a row-major
+    // table of distances between the given cities.
+    void load(std::vector<City>, std::span<const int>, std::span<const CityId>, std::span<const uint8_t>);
+    int size(void) const;
+    const City& operator[](CityId) const;
+    std::span<const CityId> neighbors(CityId) const;
+    bool adjacent(CityId, CityId) const;
+    // The fewest drives from one city to another, or NO_PATH.
+    int distance(CityId, CityId) const;
+    CityId id_of(std::string) const;
+    std::string name_of(CityId) const;
   };
 }
 #endif
@@ -0,0 +1,113 @@
+#ifndef FIXED_TYPES
+#define FIXED_TYPES
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+
+namespace gerryfudd::types::fixed {
+  // A vector with inline storage for at most N elements. It never allocates, so
+  // it is trivially copyable whenever T is.
+  template <typename T, int N>
+  class Vector {
+    std::array<T, N> items;
+    int count;
+  public:
+    Vector(): count{0} {}
+    int size(void) const { return count; }
+    bool empty(void) const { return count == 0; }
+    static constexpr int capacity(void) { return N; }
+    T& operator[](int i) { return items[i]; }
+    const T& operator[](int i) const { return items[i]; }
+    T& back(void) { return items[count - 1]; }
+    const T& back(void) const { return items[count - 1]; }
+    T *begin(void) { return items.data(); }
+    T *end(void) { return items.data() + count; }
+    const T *begin(void) const { return items.data(); }
+    const T *end(void) const { return items.data() + count; }
+    void push_back(T item) {
+      if (count == N) {
+        throw std::invalid_argument("This container is full.");
+      }
+      items[count++] = item;
+    }
+    void pop_back(void) {
+      count--;
+    }
+    void insert(int i, T item) {
+      push_back(item);
+      for (int j = count - 1; j > i; j--) {
+        items[j] = items[j - 1];
+      }
+      items[i] = item;
+    }
+    T *erase(T *position) {
+      for (T *cursor = position; cursor + 1 < end(); cursor++) {
+        *cursor = *(cursor + 1);
+      }
+      count--;
+      return position;
+    }
+    void clear(void) {
+      count = 0;
+    }
+  };
+
+  // A ring buffer with inline storage for at most N elements, N a power of two.
+  // Index 0 is the front; pushing and popping at either end is constant time.
+  template <typename T, int N>
+  class Deque {
+    static_assert((N & (N - 1)) == 0, "The capacity of a fixed deque must be a power of two.");
+    std::array<T, N> items;
+    int first;
+    int count;
+  public:
+    Deque(): first{0}, count{0} {}
+    int size(void) const { return count; }
+    bool empty(void) const { return count == 0; }
+    static constexpr int capacity(void) { return N; }
+    T& operator[](int i) { return items[(first + i) & (N - 1)]; }
+    const T& operator[](int i) const { return items[(first + i) & (N - 1)]; }
+    T& front(void) { return (*this)[0]; }
+    T& back(void) { return (*this)[count - 1]; }
+    void push_back(T item) {
+      if (count == N) {
+        throw std::invalid_argument("This container is full.");
+      }
+      items[(first + count++) & (N - 1)] = item;
+    }
+    void push_front(T item) {
+      if (count == N) {
+        throw std::invalid_argument("This container is full.");
+      }
+      first = (first - 1) & (N - 1);
+      items[first] = item;
+      count++;
+    }
+    void pop_back(void) {
+      count--;
+    }
+    void pop_front(void) {
+      first = (first + 1) & (N - 1);
+      count--;
+    }
+    void insert(int i, T item) {
+      push_back(item);
+      for (int j = count - 1; j > i; j--) {
+        (*this)[j] = (*this)[j - 1];
+      }
+      (*this)[i] = item;
+    }
+    void erase(int i) {
+      for (int j = i; j + 1 < count; j++) {
+        (*this)[j] = (*this)[j + 1];
+      }
+      count--;
+    }
+    void clear(void) {
+      first = 0;
+      count = 0;
+    }
+  };
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "types/card.hpp"
+#include "types/fixed.hpp"
 
 #define CONTINGENCY_PLANNER "Contingency Planner"
 #define DISPATCHER "Dispatcher"
@@ -13,6 +14,8 @@
 #define QUARANTINE_SPECIALIST "Quarantine Specialist"
 #define SCIENTIST "Scientist"
 #define RESEARCHER "Researcher"
+#define ROLE_COUNT 7
+#define ACTION_TYPE_COUNT 11
 
 #define CONTINGENCY_PLANNER_DESCRIPTION "As an action you may move a discarded event card to your role card. You may play event cards from your role card as though they were in your hand, but then they are removed from the game. You may only have one event card on your role card at a time."
 #define DISPATCHER_DESCRIPTION "You may move other players' pawns as though they were your own. You may also move another players' pawn to a city with another pawn in it.\nYou must get permission from a pawn's owner before moving it."
@@ -58,11 +61,11 @@ namespace gerryfudd::types::player {
   enum Role { contingency_planner, dispatcher, medic, operations_expert, quarantine_specialist, scientist, researcher };
   std::string name_of(Role);
   std::string description_of(Role);
-  std::vector<Role> get_roles(int);
+  std::vector<Role> get_roles(int, random::Generator&);
   enum ActionType { drive, direct_flight, charter_flight, shuttle, build, treat, share, cure, reclaim, conference, company_plane };
   std::string name_of(ActionType);
   std::string description_of(ActionType, Role);
-  std::vector<ActionType> get_actions(Role);
+  fixed::Vector<ActionType, ACTION_TYPE_COUNT> get_actions(Role);
 
   struct Player {
     Role role;
@@ -0,0 +1,27 @@
+#ifndef RANDOM_TYPES
+#define RANDOM_TYPES
+#include <array>
+#include <cstdint>
+
+namespace gerryfudd::types::random {
+  uint64_t splitmix64(uint64_t&);
+  uint64_t entropy_seed(void);
+
+  // xoshiro256** (Blackman & Vigna). The whole state is four words, so a game
+  // can carry its own generator and be replayed from the seed it started with.
+  class Generator {
+    std::array<uint64_t, 4> state;
+  public:
+    typedef uint64_t result_type;
+    Generator();
+    Generator(uint64_t);
+    uint64_t operator()(void);
+    // A uniformly distributed integer in [0, bound).
+    int below(int);
+    bool operator==(const Generator&) const = default;
+    static constexpr uint64_t min(void) { return 0; }
+    static constexpr uint64_t max(void) { return UINT64_MAX; }
+  };
+}
+
+#endif
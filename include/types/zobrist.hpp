@@ -0,0 +1,19 @@
+#ifndef ZOBRIST_TYPES
+#define ZOBRIST_TYPES
+#include <cstdint>
+
+namespace gerryfudd::types::zobrist {
+  enum Domain { cubes, research_facility, location, hand, discard, cure, outbreaks, infection_rate };
+
+  // The Zobrist key for one feature of a position. Keys are derived by mixing
+  // the domain and index rather than looked up in a table, so there is no
+  // shared table to initialize and every build agrees on them.
+  constexpr uint64_t key(Domain domain, uint64_t index) {
+    uint64_t z = (uint64_t{domain} << 56) ^ index ^ 0x9e3779b97f4a7c15;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+  }
+}
+
+#endif
@@ -0,0 +1,208 @@
+#include <bit>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "data/board_file.hpp"
+
+namespace gerryfudd::data::board {
+  static_assert(std::endian::native == std::endian::little, "Board files are read in place, which requires a little-endian host.");
+
+  types::disease::DiseaseColor parse_color(const std::string &name) {
+    for (int color = 0; color < types::disease::none; color++) {
+      if (types::disease::name_of((types::disease::DiseaseColor) color) == name) {
+        return (types::disease::DiseaseColor) color;
+      }
+    }
+    throw std::invalid_argument("There is no disease color named " + name + ".");
+  }
+
+  std::vector<std::string> split_fields(const std::string &line) {
+    std::vector<std::string> result;
+    std::stringstream fields(line);
+    std::string field;
+    while (std::getline(fields, field, '\t')) {
+      result.push_back(field);
+    }
+    return result;
+  }
+
+  void convert_board(std::istream &text, std::ostream &binary) {
+    std::vector<CityEntry> cities;
+    std::vector<EdgeEntry> edges;
+    std::string names;
+    std::map<std::string, uint16_t> ids_by_name;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(text, line)) {
+      line_number++;
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+      std::vector<std::string> fields = split_fields(line);
+      if (fields.size() == 4 && fields[0] == "city") {
+        if (cities.size() >= MAX_BOARD_FILE_CITIES) {
+          throw std::invalid_argument("A board file can't hold more than " + std::to_string(MAX_BOARD_FILE_CITIES) + " cities.");
+        }
+        if (!ids_by_name.emplace(fields[3], cities.size()).second) {
+          throw std::invalid_argument("The city " + fields[3] + " is listed twice.");
+        }
+        if (fields[2].empty() || fields[2].size() > 10 || fields[2].find_first_not_of("0123456789") != std::string::npos || std::stoull(fields[2]) > UINT32_MAX) {
+          throw std::invalid_argument("Line " + std::to_string(line_number) + " has a population that isn't a count up to " + std::to_string(UINT32_MAX) + ".");
+        }
+        if (fields[3].size() > UINT16_MAX) {
+          throw std::invalid_argument("Line " + std::to_string(line_number) + " has a name longer than " + std::to_string(UINT16_MAX) + " bytes.");
+        }
+        CityEntry entry{};
+        entry.population = std::stoull(fields[2]);
+        entry.name_offset = names.size();
+        entry.name_length = fields[3].size();
+        entry.color = parse_color(fields[1]);
+        cities.push_back(entry);
+        names += fields[3];
+      } else if (fields.size() == 3 && fields[0] == "edge") {
+        std::map<std::string, uint16_t>::const_iterator a = ids_by_name.find(fields[1]), b = ids_by_name.find(fields[2]);
+        if (a == ids_by_name.end() || b == ids_by_name.end()) {
+          throw std::invalid_argument("Line " + std::to_string(line_number) + " attaches a city that hasn't been listed.");
+        }
+        edges.push_back(EdgeEntry{a->second, b->second});
+      } else {
+        throw std::invalid_argument("Line " + std::to_string(line_number) + " is not a city or an edge.");
+      }
+    }
+
+    Header header{BOARD_FILE_MAGIC, BOARD_FILE_VERSION, (uint32_t) cities.size(), (uint32_t) edges.size(), (uint32_t) names.size()};
+    binary.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    binary.write(reinterpret_cast<const char*>(cities.data()), cities.size() * sizeof(CityEntry));
+    binary.write(reinterpret_cast<const char*>(edges.data()), edges.size() * sizeof(EdgeEntry));
+    binary.write(names.data(), names.size());
+  }
+
+  void convert_board(const std::string &text_path, const std::string &binary_path) {
+    std::ifstream text(text_path);
+    if (!text) {
+      throw std::invalid_argument("Unable to read " + text_path + ".");
+    }
+    std::ofstream binary(binary_path, std::ios::binary);
+    if (!binary) {
+      throw std::invalid_argument("Unable to write " + binary_path + ".");
+    }
+    convert_board(text, binary);
+  }
+
+  // Owns a read-only mapping of a whole file for the duration of a load.
+  class MappedFile {
+    const char *data;
+    size_t length;
+  public:
+    MappedFile(const std::string &path): data{nullptr}, length{0} {
+      int descriptor = open(path.c_str(), O_RDONLY);
+      if (descriptor < 0) {
+        throw std::invalid_argument("Unable to open " + path + ".");
+      }
+      struct stat status;
+      if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+        length = status.st_size;
+        void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        data = mapped == MAP_FAILED ? nullptr : static_cast<const char*>(mapped);
+      }
+      close(descriptor);
+      if (data == nullptr) {
+        throw std::invalid_argument("Unable to map " + path + ".");
+      }
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+      munmap(const_cast<char*>(data), length);
+    }
+    const char *begin(void) const { return data; }
+    size_t size(void) const { return length; }
+  };
+
+  void load_board(const std::string &path, types::city::Graph *graph) {
+    MappedFile file(path);
+    if (file.size() < sizeof(Header)) {
+      throw std::invalid_argument("The board file " + path + " is truncated.");
+    }
+    const Header *header = reinterpret_cast<const Header*>(file.begin());
+    if (header->magic != BOARD_FILE_MAGIC || header->version != BOARD_FILE_VERSION) {
+      throw std::invalid_argument("The file " + path + " is not a board file this build can read.");
+    }
+    if (header->city_count > MAX_CITY_COUNT) {
+      throw std::invalid_argument("This board has " + std::to_string(header->city_count) + " cities, but this build supports at most " + std::to_string(MAX_CITY_COUNT) + ". Rebuild with a larger -DMAX_CITY_COUNT.");
+    }
+    size_t expected_size = sizeof(Header) + header->city_count * sizeof(CityEntry) + header->edge_count * sizeof(EdgeEntry) + header->names_size;
+    if (file.size() != expected_size) {
+      throw std::invalid_argument("The board file " + path + " is truncated.");
+    }
+    const CityEntry *city_entries = reinterpret_cast<const CityEntry*>(file.begin() + sizeof(Header));
+    const EdgeEntry *edge_entries = reinterpret_cast<const EdgeEntry*>(city_entries + header->city_count);
+    const char *names = reinterpret_cast<const char*>(edge_entries + header->edge_count);
+    int city_count = header->city_count;
+
+    std::vector<types::city::City> cities;
+    for (int id = 0; id < city_count; id++) {
+      const CityEntry &entry = city_entries[id];
+      if (entry.color >= types::disease::none || uint64_t{entry.name_offset} + entry.name_length > header->names_size) {
+        throw std::invalid_argument("The board file " + path + " has a malformed city.");
+      }
+      cities.push_back(types::city::City(std::string(names + entry.name_offset, entry.name_length), (types::disease::DiseaseColor) entry.color, entry.population));
+    }
+
+    // Lay the edges out as compressed adjacency arrays in the order they are listed.
+    std::vector<int> offsets(city_count + 1, 0);
+    for (uint32_t i = 0; i < header->edge_count; i++) {
+      const EdgeEntry &edge = edge_entries[i];
+      if (edge.a >= city_count || edge.b >= city_count || edge.a == edge.b) {
+        throw std::invalid_argument("The board file " + path + " has a malformed edge.");
+      }
+      offsets[edge.a + 1]++;
+      offsets[edge.b + 1]++;
+    }
+    for (int id = 0; id < city_count; id++) {
+      offsets[id + 1] += offsets[id];
+    }
+    std::vector<types::city::CityId> neighbor_ids(offsets.back());
+    std::vector<int> filled(offsets.begin(), offsets.end() - 1);
+    for (uint32_t i = 0; i < header->edge_count; i++) {
+      const EdgeEntry &edge = edge_entries[i];
+      for (int j = offsets[edge.a]; j < filled[edge.a]; j++) {
+        if (neighbor_ids[j] == edge.b) {
+          throw std::invalid_argument("The board file " + path + " attaches " + cities[edge.a].name + " and " + cities[edge.b].name + " twice.");
+        }
+      }
+      neighbor_ids[filled[edge.a]++] = edge.b;
+      neighbor_ids[filled[edge.b]++] = edge.a;
+    }
+
+    // A breadth-first search from every city.
+    std::vector<uint8_t> distances(city_count * city_count, NO_PATH);
+    std::vector<types::city::CityId> queue(city_count);
+    for (int source = 0; source < city_count; source++) {
+      uint8_t *row = distances.data() + source * city_count;
+      int head = 0, tail = 0;
+      row[source] = 0;
+      queue[tail++] = source;
+      while (head < tail) {
+        types::city::CityId current = queue[head++];
+        for (int i = offsets[current]; i < offsets[current + 1]; i++) {
+          if (row[neighbor_ids[i]] == NO_PATH) {
+            if (row[current] + 1 >= NO_PATH) {
+              throw std::invalid_argument("The board file " + path + " has cities too far apart to measure.");
+            }
+            row[neighbor_ids[i]] = row[current] + 1;
+            queue[tail++] = neighbor_ids[i];
+          }
+        }
+      }
+    }
+
+    graph->load(cities, offsets, neighbor_ids, distances);
+  }
+}
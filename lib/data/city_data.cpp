@@ -1,7 +1,16 @@
+#include <array>
+#include <stdexcept>
+#include <string_view>
 #include "data/city_data.hpp"
 
 namespace gerryfudd::data::city {
-  void load_cities(std::map<std::string, types::city::City> *CITIES_MAP) {
+  struct CityRecord {
+    const char *name;
+    types::disease::DiseaseColor color;
+    int population;
+  };
+
+  constexpr CityRecord CITY_TABLE[] = {
     #define COLOR black
     MAP_CITY(Algeirs, 2946000)
     MAP_CITY(Baghdad, 6204000)
@@ -61,7 +70,26 @@ namespace gerryfudd::data::city {
     MAP_CITY(Santiago, 6015000)
     MAP_CITY(São Paulo, 20186000)
     #undef COLOR
+  };
+  constexpr int CITY_COUNT = sizeof(CITY_TABLE) / sizeof(CityRecord);
+
+  constexpr types::city::CityId id_of(std::string_view name) {
+    for (types::city::CityId id = 0; id < CITY_COUNT; id++) {
+      if (name == CITY_TABLE[id].name) {
+        return id;
+      }
+    }
+    throw std::invalid_argument("This city is not in the city table.");
+  }
 
+  // Each connection is listed once and attaches both cities, so the neighbor
+  // lists mirror each other by construction.
+  struct Edge {
+    types::city::CityId a;
+    types::city::CityId b;
+  };
+
+  constexpr Edge EDGES[] = {
     ATTACH(Algeirs, Cairo)
     ATTACH(Algeirs, Istanbul)
     ATTACH(Algeirs, Madrid)
@@ -143,6 +171,98 @@ namespace gerryfudd::data::city {
     ATTACH(Shanghai, Taipei)
     ATTACH(Osaka, Taipei)
     ATTACH(Osaka, Tokyo)
+  };
+
+  constexpr int EDGE_COUNT = sizeof(EDGES) / sizeof(Edge);
+
+  // The compressed adjacency arrays and the drive distances for the standard
+  // board, laid out exactly as city::Graph keeps them. Neighbors appear in the
+  // order their edges are listed above.
+  struct Topology {
+    std::array<int, CITY_COUNT + 1> neighbor_offsets;
+    std::array<types::city::CityId, 2 * EDGE_COUNT> neighbor_ids;
+    std::array<uint8_t, CITY_COUNT * CITY_COUNT> distances;
+  };
+
+  constexpr Topology build_topology() {
+    Topology result{};
+    std::array<int, CITY_COUNT> degrees{};
+    for (const Edge &edge : EDGES) {
+      degrees[edge.a]++;
+      degrees[edge.b]++;
+    }
+    for (int id = 0; id < CITY_COUNT; id++) {
+      result.neighbor_offsets[id + 1] = result.neighbor_offsets[id] + degrees[id];
+    }
+    std::array<int, CITY_COUNT> filled{};
+    for (const Edge &edge : EDGES) {
+      result.neighbor_ids[result.neighbor_offsets[edge.a] + filled[edge.a]++] = edge.b;
+      result.neighbor_ids[result.neighbor_offsets[edge.b] + filled[edge.b]++] = edge.a;
+    }
+
+    // A breadth-first search from every city.
+    for (int source = 0; source < CITY_COUNT; source++) {
+      uint8_t *distances = result.distances.data() + source * CITY_COUNT;
+      for (int id = 0; id < CITY_COUNT; id++) {
+        distances[id] = NO_PATH;
+      }
+      std::array<types::city::CityId, CITY_COUNT> queue{};
+      int head = 0, tail = 0;
+      distances[source] = 0;
+      queue[tail++] = source;
+      while (head < tail) {
+        types::city::CityId current = queue[head++];
+        for (int i = result.neighbor_offsets[current]; i < result.neighbor_offsets[current + 1]; i++) {
+          types::city::CityId neighbor = result.neighbor_ids[i];
+          if (distances[neighbor] == NO_PATH) {
+            distances[neighbor] = distances[current] + 1;
+            queue[tail++] = neighbor;
+          }
+        }
+      }
+    }
+    return result;
   }
-}
 
+  constexpr Topology TOPOLOGY = build_topology();
+
+  constexpr bool simple() {
+    for (int a = 0; a < CITY_COUNT; a++) {
+      for (int i = TOPOLOGY.neighbor_offsets[a]; i < TOPOLOGY.neighbor_offsets[a + 1]; i++) {
+        if (TOPOLOGY.neighbor_ids[i] == a) {
+          return false;
+        }
+        for (int j = TOPOLOGY.neighbor_offsets[a]; j < i; j++) {
+          if (TOPOLOGY.neighbor_ids[i] == TOPOLOGY.neighbor_ids[j]) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  constexpr bool connected() {
+    for (uint8_t distance : TOPOLOGY.distances) {
+      if (distance == NO_PATH) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static_assert(CITY_COUNT <= MAX_CITY_COUNT, "The city table has more cities than a board can hold.");
+  static_assert(simple(), "No city may be attached to itself or to the same neighbor twice.");
+  static_assert(connected(), "Every city must be reachable from every other city.");
+
+  void load_cities(types::city::Graph *graph) {
+    if (graph->size() > 0) {
+      throw std::invalid_argument("Cities may only be loaded onto an empty graph.");
+    }
+    std::vector<types::city::City> cities;
+    for (const CityRecord &record : CITY_TABLE) {
+      cities.push_back(types::city::City(record.name, record.color, record.population));
+    }
+    graph->load(cities, TOPOLOGY.neighbor_offsets, TOPOLOGY.neighbor_ids, TOPOLOGY.distances);
+  }
+}
@@ -6,457 +6,822 @@
 #include "data/city_data.hpp"
 
 namespace gerryfudd::core {
-  int Game::infection_rate_escalation[] = INFECTION_RATE_ESCALATION;
-  int Game::hand_sizes[] = HAND_SIZES;
+  // Every game on the standard board shares one read-only copy of its topology.
+  std::shared_ptr<const city::Graph> standard_graph() {
+    static const std::shared_ptr<const city::Graph> graph = [] {
+      std::shared_ptr<city::Graph> result = std::make_shared<city::Graph>();
+      data::city::load_cities(result.get());
+      return result;
+    }();
+    return graph;
+  }
 
-  GameState::GameState(): infection_deck{card::infect}, player_deck{card::player}, contingency_card{card::player}, outbreaks{0}, infection_rate_level{0}, research_facility_reserve{RESEARCH_FACILITY_COUNT} {}
-  int GameState::get_infection_rate() {
+  GameState::GameState(): GameState::GameState(standard_graph()) {}
+  GameState::GameState(city::Graph cities): GameState::GameState(std::make_shared<const city::Graph>(std::move(cities))) {}
+  GameState::GameState(std::shared_ptr<const city::Graph> cities): cities{cities}, infection_deck{card::infect}, player_deck{card::player}, contingency_card{card::player}, outbreaks{0}, infection_rate_level{0}, research_facility_reserve{RESEARCH_FACILITY_COUNT} {
+    player_locations.fill(NO_CITY);
+    facility_distances.fill(NO_PATH);
+    position_hash = 0;
+  }
+  int GameState::get_infection_rate() const {
     return Game::infection_rate_escalation[infection_rate_level];
   }
-  player::Player GameState::get_player(player::Role role) {
-    for (std::vector<player::Player>::iterator cursor = players.begin(); cursor != players.end(); cursor++) {
+  const player::Player& GameState::get_player(player::Role role) const {
+    for (std::vector<player::Player>::const_iterator cursor = players.begin(); cursor != players.end(); cursor++) {
       if (cursor->role == role) {
         return *cursor;
       }
     }
     throw std::invalid_argument("There is no player with this role.");
   }
+  player::Player& GameState::get_player(player::Role role) {
+    return const_cast<player::Player&>(static_cast<const GameState&>(*this).get_player(role));
+  }
+  // The contingency card is hashed as though it were held by an extra role.
+  uint64_t hand_key(int holder, card::Card card) {
+    return zobrist::key(zobrist::hand, uint64_t{(uint64_t) holder} << 32 | card.id);
+  }
+  uint64_t location_key(player::Role role, city::CityId location) {
+    return location == NO_CITY ? 0 : zobrist::key(zobrist::location, uint64_t{(uint64_t) role} << 32 | location);
+  }
   void GameState::add_card(player::Role role, card::Card card) {
-    for (std::vector<player::Player>::iterator cursor = players.begin(); cursor != players.end(); cursor++) {
-      if (cursor->role == role) {
-        cursor->hand.contents.push_back(card);
-        return;
+    get_player(role).hand.contents.push_back(card);
+    position_hash ^= hand_key(role, card);
+  }
+  card::Card GameState::remove_card(player::Role role, card::Card card) {
+    card::Hand &hand = get_player(role).hand;
+    for (card::Card *card_cursor = hand.contents.begin(); card_cursor != hand.contents.end(); card_cursor++) {
+      if (*card_cursor == card) {
+        hand.contents.erase(card_cursor);
+        position_hash ^= hand_key(role, card);
+        return card;
       }
     }
-    throw std::invalid_argument("There is no player with this role.");
+    throw std::invalid_argument("This player doesn't have this card.");
   }
-  card::Card GameState::remove_card(player::Role role, std::string card_name) {
-    for (std::vector<player::Player>::iterator player_cursor = players.begin(); player_cursor != players.end(); player_cursor++) {
-      if (player_cursor->role == role) {
-        for (std::vector<card::Card>::iterator card_cursor = player_cursor->hand.contents.begin(); card_cursor != player_cursor->hand.contents.end(); card_cursor++) {
-          if (card_cursor->name == card_name) {
-            card::Card result = *card_cursor;
-            player_cursor->hand.contents.erase(card_cursor);
-            return result;
-          }
+  bool GameState::eradicated(disease::DiseaseColor color) const {
+    return diseases[color].cured && board.infected(color).empty();
+  }
+  void GameState::update_protection() {
+    protected_cities.fill(city::CitySet());
+    city::CityId quarantine_location = player_locations[player::quarantine_specialist];
+    if (quarantine_location != NO_CITY) {
+      city::CitySet quarantined;
+      quarantined.insert(quarantine_location);
+      for (city::CityId neighbor : cities->neighbors(quarantine_location)) {
+        quarantined.insert(neighbor);
+      }
+      protected_cities.fill(quarantined);
+    }
+    city::CityId medic_location = player_locations[player::medic];
+    if (medic_location != NO_CITY) {
+      for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+        if (diseases[color].cured) {
+          protected_cities[color].insert(medic_location);
         }
-        throw std::invalid_argument("This player doesn't have this card.");
       }
     }
-    throw std::invalid_argument("There is no player with this role.");
   }
-  bool GameState::prevent_placement(std::string location, disease::DiseaseColor color) {
-    if (player_locations[player::quarantine_specialist] == location) {
-      return true;
+  void GameState::update_facility_distances() {
+    facility_distances.fill(NO_PATH);
+    for (city::CityId facility : board.research_facility_locations()) {
+      for (city::CityId id = 0; id < cities->size(); id++) {
+        facility_distances[id] = std::min<int>(facility_distances[id], cities->distance(id, facility));
+      }
     }
-    if (diseases[color].cured && player_locations[player::medic] == location) {
-      return true;
+  }
+  int GameState::distance_to_research_facility(city::CityId location) const {
+    return facility_distances[location];
+  }
+  void GameState::update_hash() {
+    position_hash = 0;
+    for (const player::Player &player : players) {
+      position_hash ^= location_key(player.role, player_locations[player.role]);
+      for (card::Card card : player.hand.contents) {
+        position_hash ^= hand_key(player.role, card);
+      }
     }
-
-    for (std::vector<city::City>::iterator cursor = cities[location].neighbors.begin(); cursor != cities[location].neighbors.end(); cursor++) {
-      if (cursor->name == player_locations[player::quarantine_specialist]) {
-        return true;
+    for (card::Card card : contingency_card.contents) {
+      position_hash ^= hand_key(ROLE_COUNT, card);
+    }
+  }
+  // The counters and cures are few enough to hash on demand.
+  uint64_t status_hash(const GameState &state) {
+    uint64_t result = zobrist::key(zobrist::outbreaks, state.outbreaks) ^ zobrist::key(zobrist::infection_rate, state.infection_rate_level);
+    for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+      if (state.diseases[color].cured) {
+        result ^= zobrist::key(zobrist::cure, color);
       }
     }
-    return false;
+    return result;
+  }
+  uint64_t GameState::hash() const {
+    return position_hash ^ board.hash() ^ infection_deck.get_discard_hash() ^ status_hash(*this);
+  }
+  // The same value as hash(), computed from scratch.
+  uint64_t GameState::compute_hash() const {
+    GameState rehashed = *this;
+    rehashed.update_hash();
+    uint64_t result = rehashed.position_hash;
+    for (city::CityId id = 0; id < cities->size(); id++) {
+      for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+        int count = board.cube_count(id, (disease::DiseaseColor) color);
+        if (count > 0) {
+          result ^= zobrist::key(zobrist::cubes, (uint64_t{id} * DISEASE_COLOR_COUNT + color) * (MAX_CUBES_PER_CITY + 1) + count);
+        }
+      }
+      if (board.research_facility(id)) {
+        result ^= zobrist::key(zobrist::research_facility, id);
+      }
+    }
+    for (card::Card card : infection_deck.get_discard_contents()) {
+      result ^= zobrist::key(zobrist::discard, card.id);
+    }
+    return result ^ status_hash(*this);
+  }
+  bool GameState::prevent_placement(city::CityId location, disease::DiseaseColor color) const {
+    return protected_cities[color].contains(location);
   }
 
-  GameState initialize_state(Difficulty difficulty, int player_count) {
-    GameState result{};
+  GameState initialize_state(std::shared_ptr<const city::Graph> cities, city::CityId cdc_location, Difficulty difficulty, int player_count, uint64_t seed) {
+    GameState result{cities};
+    result.generator = random::Generator(seed);
 
-    data::city::load_cities(&result.cities);
-    for (std::map<std::string, city::City>::iterator cursor = result.cities.begin(); cursor != result.cities.end(); ++cursor) {
-      result.board[cursor->first] = city::CityState();
-      result.infection_deck.discard(card::Card(cursor->first, card::infect));
-      result.player_deck.discard(card::Card(cursor->first, card::player));
+    for (city::CityId id = 0; id < result.cities->size(); id++) {
+      result.infection_deck.discard(card::Card(id, card::infect));
+      result.player_deck.discard(card::Card(id, card::player));
     }
     result.research_facility_reserve--;
-    result.board[CDC_LOCATION].research_facility = true;
+    result.board.set_research_facility(cdc_location, true);
 
-    result.infection_deck.shuffle();
+    result.infection_deck.shuffle(result.generator);
 
-    std::string last_city_drawn;
+    city::CityId last_city_drawn;
     for (int i = 3; i < 12; i++) {
-      last_city_drawn = result.infection_deck.draw_and_discard().name;
-      result.board[last_city_drawn].disease_count[result.cities[last_city_drawn].color] += i / 3;
-      result.diseases[result.cities[last_city_drawn].color].reserve -= i / 3;
+      last_city_drawn = result.infection_deck.draw_and_discard().city_id();
+      result.board.set_cube_count(last_city_drawn, (*result.cities)[last_city_drawn].color, i / 3);
+      result.diseases[(*result.cities)[last_city_drawn].color].reserve -= i / 3;
     }
     
-    result.player_deck.discard(card::Card(ONE_QUIET_NIGHT, card::player));
-    result.player_deck.discard(card::Card(RESILIENT_POPULATION, card::player));
-    result.player_deck.discard(card::Card(GOVERNMENT_GRANT, card::player));
-    result.player_deck.discard(card::Card(AIRLIFT, card::player));
+    result.player_deck.discard(card::Card(card::one_quiet_night));
+    result.player_deck.discard(card::Card(card::resilient_population));
+    result.player_deck.discard(card::Card(card::government_grant));
+    result.player_deck.discard(card::Card(card::airlift));
 
-    result.player_deck.shuffle();
+    result.player_deck.shuffle(result.generator);
     int initial_hand_size = Game::hand_sizes[player_count - MIN_PLAYER_COUNT];
-    std::vector<player::Role> roles = player::get_roles(player_count);
+    std::vector<player::Role> roles = player::get_roles(player_count, result.generator);
     for (std::vector<player::Role>::iterator cursor = roles.begin(); cursor != roles.end(); cursor++) {
       result.players.push_back(player::Player(*cursor));
       while (result.players.back().hand.contents.size() < initial_hand_size) {
         result.players.back().hand.contents.push_back(result.player_deck.draw());
       }
-      result.player_locations[*cursor] = CDC_LOCATION;
+      result.player_locations[*cursor] = cdc_location;
     }
+    result.update_protection();
+    result.update_facility_distances();
+    result.update_hash();
     int epidemics = BASE_EPIDEMIC_COUNT + difficulty;
     int cards_per_epidemic = (result.player_deck.remaining() + epidemics) / epidemics;
+    // The last pile takes the cards left over, so every card shares a pile
+    // with an epidemic.
     for (int i = 0; i < epidemics; i++) {
-      result.player_deck.insert(card::Card(EPIDEMIC, card::player, card::epidemic), cards_per_epidemic * i);
-      result.player_deck.shuffle(cards_per_epidemic * i, std::min(cards_per_epidemic * (i+1), result.player_deck.remaining()));
+      result.player_deck.insert(card::Card(card::epidemic), cards_per_epidemic * i);
+      int pile_end = i == epidemics - 1 ? result.player_deck.remaining() : cards_per_epidemic * (i+1);
+      result.player_deck.shuffle(cards_per_epidemic * i, pile_end, result.generator);
+      result.epidemic_piles.push_back(pile_end - cards_per_epidemic * i);
     }
     return result;
   }
+  GameState initialize_state(Difficulty difficulty, int player_count, uint64_t seed) {
+    std::shared_ptr<const city::Graph> cities = standard_graph();
+    return initialize_state(cities, cities->id_of(CDC_LOCATION), difficulty, player_count, seed);
+  }
+  GameState initialize_state(Difficulty difficulty, int player_count) {
+    return initialize_state(difficulty, player_count, random::entropy_seed());
+  }
   GameState initialize_state() {
     return initialize_state(easy, 2);
   }
 
-  TurnState::TurnState(player::Role active_role, int infection_rate): active_role{active_role}, event_cards_played{false}, remaining_actions{4}, remaining_player_card_draws{2}, remaining_infection_card_draws{infection_rate} {}
+  GameStateView::GameStateView(const GameState &state): state{&state} {}
+  const GameState& GameStateView::operator*() const {
+    return *state;
+  }
+  const GameState *GameStateView::operator->() const {
+    return state;
+  }
+
+  TurnState::TurnState(player::Role active_role, int infection_rate): active_role{active_role}, event_cards_played{false}, remaining_actions{4}, remaining_player_card_draws{2}, remaining_infection_card_draws{infection_rate}, company_plane_used{false} {}
 
   Game::Game() {}
-  Game::Game(GameState game_state): state{game_state} {}
+  Game::Game(GameState game_state): state{game_state} {
+    state.update_protection();
+    state.update_facility_distances();
+    state.update_hash();
+  }
 
-  int Game::place(std::string target, disease::DiseaseColor color, int quantity) {
+  void Game::record(ChangeType type, int subject, city::CityId city, card::Card card, int value) {
+    journal.push_back(Change{type, subject, city, card, 0, value});
+  }
+  card::Deck& Game::deck(card::DeckType deck_type) {
+    return deck_type == card::infect ? state.infection_deck : state.player_deck;
+  }
+  void Game::set_cube_count(city::CityId city_id, disease::DiseaseColor color, int count) {
+    record(cube_change, color, city_id, card::Card(), state.board.cube_count(city_id, color));
+    state.board.set_cube_count(city_id, color, count);
+  }
+  void Game::set_reserve(disease::DiseaseColor color, int reserve) {
+    record(reserve_change, color, NO_CITY, card::Card(), state.diseases[color].reserve);
+    state.diseases[color].reserve = reserve;
+  }
+  void Game::set_cured(disease::DiseaseColor color) {
+    record(cure_change, color, NO_CITY, card::Card(), state.diseases[color].cured);
+    state.diseases[color].cured = true;
+    state.update_protection();
+  }
+  void Game::set_research_facility(city::CityId city_id, bool present) {
+    record(facility_change, 0, city_id, card::Card(), state.board.research_facility(city_id));
+    state.board.set_research_facility(city_id, present);
+  }
+  // Replaces the contingency card with the given number of cards, none or one.
+  void Game::set_contingency_card(int count, card::Card card) {
+    card::Card held = state.contingency_card.contents.empty() ? card::Card() : state.contingency_card.contents[0];
+    record(contingency_change, 0, NO_CITY, held, state.contingency_card.contents.size());
+    hold_contingency_card(count, card);
+  }
+  void Game::hold_contingency_card(int count, card::Card card) {
+    for (card::Card replaced : state.contingency_card.contents) {
+      state.position_hash ^= hand_key(ROLE_COUNT, replaced);
+    }
+    state.contingency_card.contents.clear();
+    if (count > 0) {
+      state.contingency_card.contents.push_back(card);
+      state.position_hash ^= hand_key(ROLE_COUNT, card);
+    }
+  }
+  void Game::relocate(player::Role role, city::CityId city_id) {
+    state.position_hash ^= location_key(role, state.player_locations[role]) ^ location_key(role, city_id);
+    state.player_locations[role] = city_id;
+    if (role == player::quarantine_specialist || role == player::medic) {
+      state.update_protection();
+    }
+  }
+  void Game::add_player_card(player::Role role, card::Card card) {
+    state.add_card(role, card);
+    record(card_gained, role, NO_CITY, card, 0);
+  }
+  void Game::shuffle_layer(card::DeckType deck_type, int position) {
+    if (deck(deck_type).remaining() == 0) {
+      return;
+    }
+    int layer = deck(deck_type).layer_of(position);
+    if (deck(deck_type).is_stacked(layer)) {
+      record(layer_shuffled, deck_type, NO_CITY, card::Card(), layer);
+      saved_generators.push_back(state.generator);
+      record(generator_change, 0, NO_CITY, card::Card(), 0);
+      deck(deck_type).shuffle_layer(layer, state.generator);
+    }
+  }
+  // Draws from the top of a deck, or from the bottom at position -1. A stacked
+  // layer is shuffled when the first card is drawn from it.
+  card::Card Game::draw(card::DeckType deck_type, int position) {
+    shuffle_layer(deck_type, position);
+    int layer = deck(deck_type).layer_of(position);
+    card::Card result = deck(deck_type).draw(position);
+    record(deck_drawn, deck_type, NO_CITY, result, position);
+    journal.back().layer = layer;
+    return result;
+  }
+  // Stacks the discard pile onto the deck, to be shuffled once it is drawn
+  // from. Its cards are journaled top first so that undoing them rebuilds the
+  // pile from the bottom up.
+  void Game::shuffle_discard(card::DeckType deck_type) {
+    const fixed::Vector<card::Card, DECK_CAPACITY> &discarded = deck(deck_type).get_discard_contents();
+    for (int i = discarded.size() - 1; i >= 0; i--) {
+      record(discard_removed, deck_type, NO_CITY, discarded[i], i);
+    }
+    record(deck_shuffled, deck_type, NO_CITY, card::Card(), discarded.size());
+    deck(deck_type).stack();
+  }
+
+  void Game::revert(const Change &change) {
+    switch (change.type)
+    {
+    case cube_change:
+      state.board.set_cube_count(change.city, (disease::DiseaseColor) change.subject, change.value);
+      break;
+    case reserve_change:
+      state.diseases[change.subject].reserve = change.value;
+      break;
+    case cure_change:
+      state.diseases[change.subject].cured = change.value;
+      state.update_protection();
+      break;
+    case outbreak_change:
+      state.outbreaks = change.value;
+      break;
+    case infection_rate_change:
+      state.infection_rate_level = change.value;
+      break;
+    case facility_change:
+      state.board.set_research_facility(change.city, change.value);
+      state.update_facility_distances();
+      break;
+    case facility_reserve_change:
+      state.research_facility_reserve = change.value;
+      break;
+    case location_change:
+      relocate((player::Role) change.subject, change.city);
+      break;
+    case contingency_change:
+      hold_contingency_card(change.value, change.card);
+      break;
+    case card_gained:
+      // The gained card is the last one, even if the hand holds another copy.
+      state.get_player((player::Role) change.subject).hand.contents.pop_back();
+      state.position_hash ^= hand_key(change.subject, change.card);
+      break;
+    case card_lost:
+      state.get_player((player::Role) change.subject).hand.contents.insert(change.value, change.card);
+      state.position_hash ^= hand_key(change.subject, change.card);
+      break;
+    case deck_drawn:
+      deck((card::DeckType) change.subject).insert(change.card, change.value == -1 ? deck((card::DeckType) change.subject).remaining() : change.value, change.layer);
+      break;
+    case deck_discarded:
+      deck((card::DeckType) change.subject).take_from_discard(deck((card::DeckType) change.subject).get_discard_contents().size() - 1);
+      break;
+    case discard_removed:
+      deck((card::DeckType) change.subject).return_to_discard(change.card, change.value);
+      break;
+    case deck_shuffled:
+      deck((card::DeckType) change.subject).unshuffle();
+      break;
+    case layer_shuffled:
+      // The generator was restored first, since it was saved after this.
+      deck((card::DeckType) change.subject).unshuffle_layer(change.value, state.generator);
+      break;
+    case generator_change:
+      state.generator = saved_generators.back();
+      saved_generators.pop_back();
+      break;
+    }
+  }
+
+  Undo Game::checkpoint(const TurnState &turn_state) const {
+    return Undo{journal.size(), turn_state};
+  }
+  void Game::undo(const Undo &record) {
+    while (journal.size() > record.mark) {
+      Change change = journal.back();
+      journal.pop_back();
+      revert(change);
+    }
+  }
+  void Game::undo(const Undo &record, TurnState &turn_state) {
+    undo(record);
+    turn_state = record.turn_state;
+  }
+
+  int Game::place(city::CityId target, disease::DiseaseColor color, int quantity) {
     if (state.prevent_placement(target, color)) {
       return 0;
     }
-    state.diseases[color].reserve -= quantity;
-    state.board[target].disease_count[color] += quantity;
+    quantity = std::min(quantity, MAX_CUBES_PER_CITY - state.board.cube_count(target, color));
+    set_reserve(color, state.diseases[color].reserve - quantity);
+    set_cube_count(target, color, state.board.cube_count(target, color) + quantity);
     return quantity;
   }
 
-  int Game::place(std::string target, int quantity) {
-    return place(target, state.cities[target].color, quantity);
+  int Game::place(city::CityId target, int quantity) {
+    return place(target, (*state.cities)[target].color, quantity);
   }
 
-  GameState Game::get_state() {
+  const GameState& Game::get_state() const {
     return state;
   }
   void Game::discard(card::Card card) {
-    switch (card.deck_type)
-    {
-    case card::infect:
-      state.infection_deck.discard(card);
-      break;
-    case card::player:
-      state.player_deck.discard(card);
-      break;
-    default:
-      throw std::invalid_argument("");
-    }
-  } 
-  void Game::remove_from_discard(card::Card card) {
-    switch (card.deck_type)
-    {
-    case card::player:
-      state.player_deck.remove_from_discard(card.name);
-      break;
-    case card::infect:
-      state.infection_deck.remove_from_discard(card.name);
-      break;
-    default:
-      throw std::invalid_argument("");
-    }
+    deck(card.deck_type()).discard(card);
+    record(deck_discarded, card.deck_type(), NO_CITY, card, 0);
+  }
+  card::Card Game::remove_from_discard(card::Card card) {
+    const fixed::Vector<card::Card, DECK_CAPACITY> &discarded = deck(card.deck_type()).get_discard_contents();
+    int position = std::find(discarded.begin(), discarded.end(), card) - discarded.begin();
+    deck(card.deck_type()).remove_from_discard(card);
+    record(discard_removed, card.deck_type(), NO_CITY, card, position);
+    return card;
   }
 
-  void Game::place_research_facility(std::string city_name) {
-    state.board[city_name].research_facility = true;
+  void Game::place_research_facility(city::CityId city_id) {
+    set_research_facility(city_id, true);
+    for (city::CityId id = 0; id < state.cities->size(); id++) {
+      state.facility_distances[id] = std::min<int>(state.facility_distances[id], state.cities->distance(id, city_id));
+    }
+    record(facility_reserve_change, 0, NO_CITY, card::Card(), state.research_facility_reserve);
     state.research_facility_reserve--;
   }
 
-  void Game::place_research_facility(std::string city_name, std::string source_city_name) {
-    state.board[city_name].research_facility = true;
-    state.board[source_city_name].research_facility = false;
+  void Game::place_research_facility(city::CityId city_id, city::CityId source_city_id) {
+    set_research_facility(city_id, true);
+    set_research_facility(source_city_id, false);
+    state.update_facility_distances();
   }
 
-  bool Game::place_disease(std::string city_name, disease::DiseaseColor color, std::vector<std::string>& executed_outbreaks) {
-    if (state.prevent_placement(city_name, color)) {
-      return false;
-    }
-    if (state.diseases[color].reserve <= 0) {
-      return true;
-    }
-    if (state.board[city_name].disease_count[color] >= 3) {
-      for (std::vector<std::string>::iterator cursor = executed_outbreaks.begin(); cursor != executed_outbreaks.end(); cursor++) {
-        if (city_name == *cursor) {
-          return false;
-        }
+  // Resolves an infection and any chain of outbreaks it sets off. Pending
+  // placements are kept on a stack, with each outbreak's neighbors pushed in
+  // reverse, so that cubes are placed in the same depth-first order as a
+  // recursive walk of the neighbors would place them.
+  bool Game::place_disease(city::CityId city_id, disease::DiseaseColor color) {
+    fixed::Vector<city::CityId, OUTBREAK_STACK_CAPACITY> pending;
+    city::CitySet executed_outbreaks;
+    pending.push_back(city_id);
+    while (!pending.empty()) {
+      city::CityId target = pending.back();
+      pending.pop_back();
+      if (state.prevent_placement(target, color)) {
+        continue;
       }
-      if (++state.outbreaks >= 10) {
+      // Even a city that has already broken out loses the game once the
+      // reserve is empty, as in the recursive walk.
+      if (state.diseases[color].reserve <= 0) {
         return true;
       }
-      executed_outbreaks.push_back(city_name);
-      for (std::vector<city::City>::iterator cursor = state.cities[city_name].neighbors.begin(); cursor != state.cities[city_name].neighbors.end(); cursor++) {
-        if (place_disease(cursor->name, color, executed_outbreaks)) {
+      if (state.board.saturated(color).contains(target)) {
+        if (executed_outbreaks.contains(target)) {
+          continue;
+        }
+        record(outbreak_change, 0, NO_CITY, card::Card(), state.outbreaks);
+        if (++state.outbreaks >= OUTBREAK_LIMIT) {
           return true;
         }
+        executed_outbreaks.insert(target);
+        std::span<const city::CityId> neighbors = state.cities->neighbors(target);
+        for (int i = neighbors.size() - 1; i >= 0; i--) {
+          pending.push_back(neighbors[i]);
+        }
+        continue;
       }
-      return false;
+      set_reserve(color, state.diseases[color].reserve - 1);
+      set_cube_count(target, color, state.board.cube_count(target, color) + 1);
     }
-    state.diseases[color].reserve--;
-    state.board[city_name].disease_count[color]++;
     return false;
   }
   bool Game::draw_infection_card() {
-    std::vector<std::string> executed_outbreaks;
-    card::Card infection_card = state.infection_deck.draw();
-    if (place_disease(infection_card.name, state.cities[infection_card.name].color, executed_outbreaks)) {
+    return draw_infection_card(0);
+  }
+  bool Game::draw_infection_card(int position) {
+    card::Card infection_card = draw(card::infect, position);
+    if (place_disease(infection_card.city_id(), (*state.cities)[infection_card.city_id()].color)) {
       return true;
     }
-    state.infection_deck.discard(infection_card);
+    discard(infection_card);
     return false;
   }
-  card::Card Game::remove_player_card(player::Role role, std::string card_name) {
-    return state.remove_card(role, card_name);
+  card::Card Game::remove_player_card(player::Role role, card::Card card) {
+    const card::Hand &hand = state.get_player(role).hand;
+    int position = std::find(hand.contents.begin(), hand.contents.end(), card) - hand.contents.begin();
+    state.remove_card(role, card);
+    record(card_lost, role, NO_CITY, card, position);
+    return card;
+  }
+  card::Card Game::remove_player_card(player::Role role, city::CityId city_id) {
+    return remove_player_card(role, card::Card(city_id, card::player));
   }
   void Game::remove_contingency_card() {
     if (state.contingency_card.contents.size() == 0) {
       throw std::invalid_argument("This is not allowed.");
     }
-    state.contingency_card.contents.pop_back();
+    set_contingency_card(0, card::Card());
   }
 
-  void Game::drive(player::Role role, std::string destination) {
-    std::string origin = state.player_locations[role];
-    for (std::vector<city::City>::iterator cursor = state.cities[origin].neighbors.begin(); cursor != state.cities[origin].neighbors.end(); cursor++) {
-      if (cursor->name == destination) {
-        state.player_locations[role] = destination;
-        return;
-      }
+  void Game::drive(player::Role role, city::CityId destination) {
+    if (!state.cities->adjacent(state.player_locations[role], destination)) {
+      throw std::invalid_argument("This player can't drive to " + state.cities->name_of(destination));
     }
-    throw std::invalid_argument("This player can't drive to " + destination);
+    move(role, destination);
   }
 
-  void Game::direct_flight(player::Role role, std::string destination) {
-    state.player_deck.discard(remove_player_card(role, destination));
-    state.player_locations[role] = destination;
+  void Game::direct_flight(player::Role role, city::CityId destination) {
+    discard(remove_player_card(role, destination));
+    move(role, destination);
   }
 
-  void Game::charter_flight(player::Role role, std::string destination) {
-    state.player_deck.discard(remove_player_card(role, state.player_locations[role]));
-    state.player_locations[role] = destination;
+  void Game::charter_flight(player::Role role, city::CityId destination) {
+    discard(remove_player_card(role, state.player_locations[role]));
+    move(role, destination);
   }
-  void Game::shuttle(player::Role role, std::string destination) {
-    if (!state.board[state.player_locations[role]].research_facility || !state.board[destination].research_facility) {
+  void Game::shuttle(player::Role role, city::CityId destination) {
+    if (!state.board.research_facility(state.player_locations[role]) || !state.board.research_facility(destination)) {
       throw std::invalid_argument("You may only shuttle between research facilities.");
     }
-    state.player_locations[role] = destination;
+    move(role, destination);
   }
 
-  void Game::dispatcher_direct_flight(player::Role role, std::string destination) {
-    state.player_deck.discard(remove_player_card(player::dispatcher, destination));
-    state.player_locations[role] = destination;
+  void Game::dispatcher_direct_flight(player::Role role, city::CityId destination) {
+    discard(remove_player_card(player::dispatcher, destination));
+    move(role, destination);
   }
-  void Game::dispatcher_charter_flight(player::Role role, std::string destination) {
-    state.player_deck.discard(remove_player_card(player::dispatcher, state.player_locations[role]));
-    state.player_locations[role] = destination;
+  void Game::dispatcher_charter_flight(player::Role role, city::CityId destination) {
+    discard(remove_player_card(player::dispatcher, state.player_locations[role]));
+    move(role, destination);
   }
   void Game::dispatcher_conference(player::Role guest, player::Role host) {
     // FIXME: this should require a dispatcher to be in the game.
-    state.player_locations[guest] = state.player_locations[host];
+    move(guest, state.player_locations[host]);
   }
-  void Game::move(player::Role role, std::string city_name) {
-    state.player_locations[role] = city_name;
+  // Every pawn movement goes through here so that the protected cities are
+  // kept up to date when the Quarantine Specialist or the Medic moves.
+  void Game::move(player::Role role, city::CityId city_id) {
+    record(location_change, role, state.player_locations[role], card::Card(), 0);
+    relocate(role, city_id);
   }
 
   void Game::treat(player::Role role, disease::DiseaseColor color) {
+    city::CityId location = state.player_locations[role];
+    int cube_count = state.board.cube_count(location, color);
     if (state.diseases[color].cured || role == player::medic) {
-      state.diseases[color].reserve += state.board[state.player_locations[role]].disease_count[color];
-      state.board[state.player_locations[role]].disease_count[color] = 0;
-    } else if (state.board[state.player_locations[role]].disease_count[color] > 0) {
-      state.diseases[color].reserve++;
-      state.board[state.player_locations[role]].disease_count[color]--;
+      set_reserve(color, state.diseases[color].reserve + cube_count);
+      set_cube_count(location, color, 0);
+    } else if (cube_count > 0) {
+      set_reserve(color, state.diseases[color].reserve + 1);
+      set_cube_count(location, color, cube_count - 1);
     }
   }
   void Game::share(player::Role source, player::Role target) {
     if (state.player_locations[source] != state.player_locations[target]) {
       throw std::invalid_argument("Players must be in the same city to share cards.");
     }
-    state.add_card(target, remove_player_card(source, state.player_locations[source]));
+    add_player_card(target, remove_player_card(source, state.player_locations[source]));
   }
-  void Game::researcher_share(std::string card_name, player::Role target) {
+  void Game::researcher_share(city::CityId card_city, player::Role target) {
     if (state.player_locations[player::researcher] != state.player_locations[target]) {
       throw std::invalid_argument("Players must be in the same city to share cards.");
     }
-    state.add_card(target, remove_player_card(player::researcher, card_name));
+    add_player_card(target, remove_player_card(player::researcher, card_city));
   }
-  void Game::cure(player::Role role, std::string matching_cards[5]) {
-    if (!state.board[state.player_locations[role]].research_facility) {
+  void Game::cure(player::Role role, city::CityId matching_cards[5]) {
+    if (!state.board.research_facility(state.player_locations[role])) {
       throw std::invalid_argument("Curing a disease may only occur in a city with a research facility.");
     }
     disease::DiseaseColor disease_to_cure;
     int i;
     for (i = 0; i < 5; i++) {
       if (i == 0) {
-        disease_to_cure = state.cities[matching_cards[i]].color;
-      } else if (disease_to_cure != state.cities[matching_cards[i]].color) {
+        disease_to_cure = (*state.cities)[matching_cards[i]].color;
+      } else if (disease_to_cure != (*state.cities)[matching_cards[i]].color) {
         throw std::invalid_argument("Curing a disease requires that all discarded cards share a color.");
       }
-      if (!card::contains(state.get_player(role).hand, matching_cards[i])) {
+      if (!card::contains(state.get_player(role).hand, card::Card(matching_cards[i], card::player))) {
         throw std::invalid_argument("This player doesn't have this card.");
       }
     }
     for (i = 0; i < 5; i++) {
-      state.player_deck.discard(remove_player_card(role, matching_cards[i]));
+      discard(remove_player_card(role, matching_cards[i]));
     }
-    state.diseases[disease_to_cure].cured = true;
+    set_cured(disease_to_cure);
   }
-  void Game::scientist_cure(std::string matching_cards[4]) {
-    if (!state.board[state.player_locations[player::scientist]].research_facility) {
+  void Game::scientist_cure(city::CityId matching_cards[4]) {
+    if (!state.board.research_facility(state.player_locations[player::scientist])) {
       throw std::invalid_argument("Curing a disease may only occur in a city with a research facility.");
     }
     disease::DiseaseColor disease_to_cure;
     int i;
     for (i = 0; i < 4; i++) {
       if (i == 0) {
-        disease_to_cure = state.cities[matching_cards[i]].color;
-      } else if (disease_to_cure != state.cities[matching_cards[i]].color) {
+        disease_to_cure = (*state.cities)[matching_cards[i]].color;
+      } else if (disease_to_cure != (*state.cities)[matching_cards[i]].color) {
         throw std::invalid_argument("Curing a disease requires that all discarded cards share a color.");
       }
-      if (!card::contains(state.get_player(player::scientist).hand, matching_cards[i])) {
+      if (!card::contains(state.get_player(player::scientist).hand, card::Card(matching_cards[i], card::player))) {
         throw std::invalid_argument("This player doesn't have this card.");
       }
     }
     for (i = 0; i < 4; i++) {
-      state.player_deck.discard(remove_player_card(player::scientist, matching_cards[i]));
+      discard(remove_player_card(player::scientist, matching_cards[i]));
     }
-    state.diseases[disease_to_cure].cured = true;
+    set_cured(disease_to_cure);
   }
-  void Game::reclaim(std::string event_card) {
-    if (state.player_locations[player::contingency_planner] == "") {
+  void Game::reclaim(card::Card event_card) {
+    if (state.player_locations[player::contingency_planner] == NO_CITY) {
       throw std::invalid_argument("Reclaim is not usable without a Contingency Planner.");
     }
-    card::Card discarded_card = state.player_deck.remove_from_discard(event_card);
-    if (discarded_card.type == card::city) {
-      state.player_deck.discard(discarded_card);
+    if (event_card.type() == card::city) {
       throw std::invalid_argument("City cards may not be reclaimed.");
     }
-    state.contingency_card.contents.resize(0, discarded_card);
-    state.contingency_card.contents.push_back(discarded_card);
+    set_contingency_card(1, remove_from_discard(event_card));
   }
-  void Game::company_plane(std::string destination, std::string to_discard) {
-    if (state.player_locations[player::operations_expert] == "") {
+  void Game::company_plane(city::CityId destination, city::CityId to_discard) {
+    if (state.player_locations[player::operations_expert] == NO_CITY) {
       throw std::invalid_argument("Company plane is not usable without an Operations Expert.");
-    } else if (!state.board[state.player_locations[player::operations_expert]].research_facility) {
+    } else if (!state.board.research_facility(state.player_locations[player::operations_expert])) {
       throw std::invalid_argument("Company plane requires the Operations Expert to be in a city with a research facility.");
     }
-    if (!card::contains(state.get_player(player::operations_expert).hand, to_discard)) {
+    if (!card::contains(state.get_player(player::operations_expert).hand, card::Card(to_discard, card::player))) {
       throw std::invalid_argument("This player does not have this card.");
     }
-    state.player_deck.discard(remove_player_card(player::operations_expert, to_discard));
-    state.player_locations[player::operations_expert] = destination;
+    discard(remove_player_card(player::operations_expert, to_discard));
+    move(player::operations_expert, destination);
   }
 
   bool Game::epidemic() {
-    card::Card infection_card = state.infection_deck.draw_and_discard(-1);
-    state.infection_deck.shuffle();
-    place(infection_card.name, 3);
+    return epidemic(-1);
+  }
+  bool Game::epidemic(int position) {
+    card::Card infection_card = draw(card::infect, position);
+    discard(infection_card);
+    shuffle_discard(card::infect);
+    record(infection_rate_change, 0, NO_CITY, card::Card(), state.infection_rate_level);
     state.infection_rate_level++;
-    return false;
+    // A city that already has cubes is filled to three and breaks out.
+    city::CityId city_id = infection_card.city_id();
+    disease::DiseaseColor color = (*state.cities)[city_id].color;
+    bool breaks_out = !state.prevent_placement(city_id, color) && state.board.cube_count(city_id, color) > 0;
+    place(city_id, color, 3);
+    if (state.diseases[color].reserve < 0) {
+      return true;
+    }
+    return breaks_out && place_disease(city_id, color);
   }
 
   bool Game::draw_player_card(player::Role role) {
-    if (state.player_deck.size() == 0) {
+    return draw_player_card(role, 0);
+  }
+  bool Game::draw_player_card(player::Role role, int position) {
+    if (state.player_deck.remaining() == 0) {
       return true;
     }
-    state.get_player(role).hand.contents.push_back(state.player_deck.draw());
+    add_player_card(role, draw(card::player, position));
     return false;
   }
 
-  void move_card(Game& game, player::Role role, std::string card_name, bool from_contingency_card) {
-      if (from_contingency_card) {
-        game.remove_contingency_card();
-      } else {
-        game.discard(game.remove_player_card(role, card_name));
-      }
+  void Game::play_event_card(const Move &move) {
+    if (move.from_contingency_card) {
+      remove_contingency_card();
+    } else {
+      discard(remove_player_card(move.role, card::Card(move.event)));
+    }
   }
 
-  std::string begin_prompt(std::string card_name, bool from_contingency_card) {
-    std::string result = from_contingency_card ? "Use " : "Play ";
-    result += card_name;
-    if (from_contingency_card) {
-      result += " from your role card";
+  Undo Game::apply(const Move &move, TurnState &turn_state) {
+    Undo result = checkpoint(turn_state);
+    if (move.type == play_event) {
+      play_event_card(move);
+      switch (move.event)
+      {
+      case card::one_quiet_night:
+        turn_state.remaining_infection_card_draws = 0;
+        break;
+      case card::resilient_population:
+        remove_from_discard(move.cards[0]);
+        break;
+      case card::government_grant:
+        place_research_facility(move.target_city);
+        break;
+      case card::airlift:
+        this->move(move.target_role, move.target_city);
+        break;
+      default:
+        throw std::invalid_argument("This card can't be played as an event.");
+      }
+      return result;
+    }
+    bool moves_other_pawn = move.role == player::dispatcher && move.target_role != player::dispatcher;
+    switch (move.action)
+    {
+    case player::drive:
+      drive(move.target_role, move.target_city);
+      break;
+    case player::conference:
+      this->move(move.target_role, move.target_city);
+      break;
+    case player::direct_flight:
+      if (moves_other_pawn) {
+        dispatcher_direct_flight(move.target_role, move.target_city);
+      } else {
+        direct_flight(move.role, move.target_city);
+      }
+      break;
+    case player::charter_flight:
+      if (moves_other_pawn) {
+        dispatcher_charter_flight(move.target_role, move.target_city);
+      } else {
+        charter_flight(move.role, move.target_city);
+      }
+      break;
+    case player::shuttle:
+      shuttle(move.target_role, move.target_city);
+      break;
+    case player::build:
+      if (move.role != player::operations_expert) {
+        discard(remove_player_card(move.role, move.target_city));
+      }
+      if (move.source_city == NO_CITY) {
+        place_research_facility(move.target_city);
+      } else {
+        place_research_facility(move.target_city, move.source_city);
+      }
+      break;
+    case player::treat:
+      treat(move.role, move.color);
+      break;
+    case player::share: {
+      bool giving = card::contains(state.get_player(move.role).hand, move.cards[0]);
+      player::Role giver = giving ? move.role : move.target_role;
+      player::Role receiver = giving ? move.target_role : move.role;
+      if (move.cards[0].city_id() != state.player_locations[giver]) {
+        researcher_share(move.cards[0].city_id(), receiver);
+      } else {
+        share(giver, receiver);
+      }
+      break;
     }
+    case player::cure:
+      if (move.role == player::scientist) {
+        city::CityId matching_cards[4];
+        for (int i = 0; i < 4; i++) {
+          matching_cards[i] = move.cards[i].city_id();
+        }
+        scientist_cure(matching_cards);
+      } else {
+        city::CityId matching_cards[5];
+        for (int i = 0; i < 5; i++) {
+          matching_cards[i] = move.cards[i].city_id();
+        }
+        cure(move.role, matching_cards);
+      }
+      break;
+    case player::reclaim:
+      reclaim(move.cards[0]);
+      break;
+    case player::company_plane:
+      company_plane(move.target_city, move.cards[0].city_id());
+      turn_state.company_plane_used = true;
+      break;
+    default:
+      throw std::invalid_argument("This is not an action.");
+    }
+    turn_state.remaining_actions--;
     return result;
   }
 
-  PlayerChoice create_one_quiet_night(player::Role role, bool from_contingency_card) {
-    PlayerChoice choice;
-    choice.prompt = begin_prompt(ONE_QUIET_NIGHT, from_contingency_card);
-    choice.prompt += " to skip the next infect step.";
-    choice.effect = [role, from_contingency_card](Game &game, TurnState &turn_state) -> bool {
-      move_card(game, role, ONE_QUIET_NIGHT, from_contingency_card);
-      turn_state.remaining_infection_card_draws = 0;
-      return false;
-    };
-    return choice;
-  }
-
-  PlayerChoice create_resilient_population(player::Role role, card::Card card_to_remove, bool from_contingency_card) {
-    PlayerChoice choice;
-    choice.prompt = begin_prompt(RESILIENT_POPULATION, from_contingency_card);
-    choice.prompt += " to remove ";
-    choice.prompt += card_to_remove.name;
-    choice.prompt += " from the infection discard.";
-    choice.effect = [role, card_to_remove, from_contingency_card](Game &game, TurnState &) -> bool {
-      move_card(game, role, RESILIENT_POPULATION, from_contingency_card);
-      game.remove_from_discard(card_to_remove);
-      return false;
-    };
-    return choice;
-  }
-
-  PlayerChoice create_government_grant(player::Role role, std::string target_city, bool from_contingency_card) {
-    PlayerChoice choice;
-    choice.prompt = begin_prompt(GOVERNMENT_GRANT, from_contingency_card);
-    choice.prompt += " to place a research facility in ";
-    choice.prompt += target_city;
-    choice.prompt += ".";
-    choice.effect = [role, target_city, from_contingency_card](Game &game, TurnState &) -> bool {
-      move_card(game, role, GOVERNMENT_GRANT, from_contingency_card);
-      game.place_research_facility(target_city);
-      return false;
-    };
-    return choice;
-  }
-
-  PlayerChoice create_airlift(player::Role role, player::Role target_player, std::string target_city, bool from_contingency_card) {
-    PlayerChoice choice;
-    choice.prompt = begin_prompt(AIRLIFT, from_contingency_card);
-    choice.prompt += " to move the ";
-    choice.prompt += player::name_of(target_player);
-    choice.prompt += " to ";
-    choice.prompt += target_city;
-    choice.prompt += ".";
-    choice.effect = [role, target_player, target_city, from_contingency_card](Game &game, TurnState &) -> bool {
-      move_card(game, role, AIRLIFT, from_contingency_card);
-      game.move(target_player, target_city);
-      return false;
-    };
-    return choice;
-  }
-
-  void add_choices_for_card_type(std::vector<PlayerChoice> *player_choices, player::Role role, card::CardType type, GameState game_state, bool from_contingency_card) {
+  Move create_event(player::Role role, card::CardType event, bool from_contingency_card) {
+    Move move{};
+    move.type = play_event;
+    move.role = role;
+    move.event = event;
+    move.target_role = role;
+    move.target_city = NO_CITY;
+    move.source_city = NO_CITY;
+    move.color = disease::none;
+    move.from_contingency_card = from_contingency_card;
+    return move;
+  }
+
+  Move create_action(player::Role role, player::ActionType action, player::Role target_role, city::CityId target_city) {
+    Move move{};
+    move.type = take_action;
+    move.role = role;
+    move.event = card::city;
+    move.action = action;
+    move.target_role = target_role;
+    move.target_city = target_city;
+    move.source_city = NO_CITY;
+    move.color = disease::none;
+    return move;
+  }
+
+  void add_choices_for_card_type(MoveList *moves, player::Role role, card::CardType type, GameStateView game_state, bool from_contingency_card) {
+    Move move = create_event(role, type, from_contingency_card);
     switch (type)
     {
     case card::one_quiet_night:
-      (*player_choices).push_back(create_one_quiet_night(role, from_contingency_card));
+      moves->push_back(move);
       break;
     case card::resilient_population:
-      for (int i = 0; i < game_state.infection_deck.get_discard_contents().size(); i++) {
-        (*player_choices).push_back(create_resilient_population(role, game_state.infection_deck.get_discard_contents()[i], from_contingency_card));
+      for (card::Card discarded : game_state->infection_deck.get_discard_contents()) {
+        move.cards[0] = discarded;
+        moves->push_back(move);
       }
       break;
     case card::government_grant:
-      for (std::map<std::string, city::CityState>::iterator cursor = game_state.board.begin(); cursor != game_state.board.end(); cursor++) {
-        if (!cursor->second.research_facility) {
-          (*player_choices).push_back(create_government_grant(role, cursor->first, from_contingency_card));
+      if (game_state->research_facility_reserve <= 0) {
+        break;
+      }
+      for (city::CityId id = 0; id < game_state->cities->size(); id++) {
+        if (!game_state->board.research_facility(id)) {
+          move.target_city = id;
+          moves->push_back(move);
         }
       }
       break;
     case card::airlift:
-      for (std::vector<player::Player>::iterator player_cursor = game_state.players.begin(); player_cursor != game_state.players.end(); player_cursor++) {
-        for (std::map<std::string, city::City>::iterator city_cursor = game_state.cities.begin(); city_cursor != game_state.cities.end(); city_cursor++) {
-          if (game_state.player_locations[player_cursor->role] != city_cursor->first) {
-            (*player_choices).push_back(create_airlift(role, player_cursor->role, city_cursor->first, from_contingency_card));
+      for (const player::Player &target : game_state->players) {
+        move.target_role = target.role;
+        for (city::CityId id = 0; id < game_state->cities->size(); id++) {
+          if (game_state->player_locations[target.role] != id) {
+            move.target_city = id;
+            moves->push_back(move);
           }
         }
       }
@@ -466,73 +831,291 @@ namespace gerryfudd::core {
     }
   }
 
-  void add_choices_for_card_type(std::vector<PlayerChoice> *player_choices, player::Role role, card::CardType type, GameState game_state) {
-    add_choices_for_card_type(player_choices, role, type, game_state, false);
+  // The movement actions are available for the player's own pawn and, for the
+  // Dispatcher, for every other pawn using the Dispatcher's cards.
+  void add_movement_choices(MoveList *moves, player::Role role, player::ActionType action_type, player::Role pawn, GameStateView game_state) {
+    city::CityId location = game_state->player_locations[pawn];
+    const card::Hand &hand = game_state->get_player(role).hand;
+    switch (action_type)
+    {
+    case player::drive:
+      for (city::CityId neighbor : game_state->cities->neighbors(location)) {
+        moves->push_back(create_action(role, player::drive, pawn, neighbor));
+      }
+      break;
+    case player::direct_flight:
+      for (card::Card card : hand.contents) {
+        if (card.type() == card::city && card.city_id() != location) {
+          moves->push_back(create_action(role, player::direct_flight, pawn, card.city_id()));
+        }
+      }
+      break;
+    case player::charter_flight:
+      if (card::contains(hand, card::Card(location, card::player))) {
+        for (city::CityId id = 0; id < game_state->cities->size(); id++) {
+          if (id != location) {
+            moves->push_back(create_action(role, player::charter_flight, pawn, id));
+          }
+        }
+      }
+      break;
+    case player::shuttle:
+      if (game_state->board.research_facility(location)) {
+        for (city::CityId id : game_state->board.research_facility_locations()) {
+          if (id != location) {
+            moves->push_back(create_action(role, player::shuttle, pawn, id));
+          }
+        }
+      }
+      break;
+    default:
+      break;
+    }
   }
 
-  PlayerChoice create_drive(player::Role role, std::string target_city) {
-    PlayerChoice choice;
-    choice.prompt = "Drive to ";
-    choice.prompt += target_city;
-    choice.prompt += ".";
-    choice.effect = [role, target_city](Game &game, TurnState&) -> bool {
-      game.move(role, target_city);
-      return false;
-    };
-    return choice;
+  void add_share_choices(MoveList *moves, player::Role role, GameStateView game_state) {
+    city::CityId location = game_state->player_locations[role];
+    for (const player::Player &other : game_state->players) {
+      if (other.role == role || game_state->player_locations[other.role] != location) {
+        continue;
+      }
+      for (int giving = 0; giving < 2; giving++) {
+        const player::Player &giver = giving ? game_state->get_player(role) : other;
+        for (card::Card card : giver.hand.contents) {
+          if (card.type() == card::city && (card.city_id() == location || giver.role == player::researcher)) {
+            Move move = create_action(role, player::share, other.role, location);
+            move.cards[0] = card;
+            moves->push_back(move);
+          }
+        }
+      }
+    }
   }
 
-  void add_choices_for_action_type(std::vector<PlayerChoice> *player_choices, player::Role role, player::ActionType action_type, GameState game_state) {
+  void add_cure_choices(MoveList *moves, player::Role role, GameStateView game_state) {
+    if (!game_state->board.research_facility(game_state->player_locations[role])) {
+      return;
+    }
+    int required = role == player::scientist ? 4 : 5;
+    const card::Hand &hand = game_state->get_player(role).hand;
+    for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+      if (game_state->diseases[color].cured) {
+        continue;
+      }
+      Move move = create_action(role, player::cure, role, game_state->player_locations[role]);
+      move.color = (disease::DiseaseColor) color;
+      card::Card matching[HAND_CAPACITY];
+      int count = 0;
+      for (card::Card card : hand.contents) {
+        if (card.type() == card::city && (*game_state->cities)[card.city_id()].color == color) {
+          matching[count++] = card;
+        }
+      }
+      if (count < required) {
+        continue;
+      }
+      // Every choice of the cards to discard, in lexicographic order of their
+      // places in the hand.
+      int chosen[MAX_MOVE_CARDS];
+      for (int i = 0; i < required; i++) {
+        chosen[i] = i;
+      }
+      while (true) {
+        for (int i = 0; i < required; i++) {
+          move.cards[i] = matching[chosen[i]];
+        }
+        moves->push_back(move);
+        int i = required - 1;
+        while (i >= 0 && chosen[i] == count - required + i) {
+          i--;
+        }
+        if (i < 0) {
+          break;
+        }
+        chosen[i]++;
+        for (int j = i + 1; j < required; j++) {
+          chosen[j] = chosen[j - 1] + 1;
+        }
+      }
+    }
+  }
+
+  void add_choices_for_action_type(MoveList *moves, player::Role role, player::ActionType action_type, GameStateView game_state) {
+    city::CityId location = game_state->player_locations[role];
+    const card::Hand &hand = game_state->get_player(role).hand;
     switch (action_type)
     {
     case player::drive:
-        for (auto cursor = game_state.cities[game_state.player_locations[role]].neighbors.begin(); cursor != game_state.cities[game_state.player_locations[role]].neighbors.end(); cursor++) {
-          (*player_choices).push_back(create_drive(role, cursor->name));
-        }
-      break;
     case player::direct_flight:
-      break;
     case player::charter_flight:
-      break;
     case player::shuttle:
+      if (role == player::dispatcher) {
+        for (const player::Player &pawn : game_state->players) {
+          add_movement_choices(moves, role, action_type, pawn.role, game_state);
+        }
+      } else {
+        add_movement_choices(moves, role, action_type, role, game_state);
+      }
       break;
     case player::build:
+      if (game_state->board.research_facility(location)) {
+        break;
+      }
+      if (role != player::operations_expert && !card::contains(hand, card::Card(location, card::player))) {
+        break;
+      }
+      if (game_state->research_facility_reserve > 0) {
+        moves->push_back(create_action(role, player::build, role, location));
+      } else {
+        for (city::CityId source : game_state->board.research_facility_locations()) {
+          Move move = create_action(role, player::build, role, location);
+          move.source_city = source;
+          moves->push_back(move);
+        }
+      }
       break;
     case player::treat:
+      for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+        if (game_state->board.cube_count(location, (disease::DiseaseColor) color) > 0) {
+          Move move = create_action(role, player::treat, role, location);
+          move.color = (disease::DiseaseColor) color;
+          moves->push_back(move);
+        }
+      }
       break;
     case player::share:
+      add_share_choices(moves, role, game_state);
       break;
     case player::cure:
+      add_cure_choices(moves, role, game_state);
       break;
     case player::reclaim:
+      for (card::Card card : game_state->player_deck.get_discard_contents()) {
+        if (card.type() != card::city && card.type() != card::epidemic) {
+          Move move = create_action(role, player::reclaim, role, location);
+          move.cards[0] = card;
+          moves->push_back(move);
+        }
+      }
       break;
     case player::conference:
+      for (const player::Player &guest : game_state->players) {
+        city::CitySet destinations;
+        for (const player::Player &host : game_state->players) {
+          destinations.insert(game_state->player_locations[host.role]);
+        }
+        destinations.erase(game_state->player_locations[guest.role]);
+        for (city::CityId destination : destinations) {
+          moves->push_back(create_action(role, player::conference, guest.role, destination));
+        }
+      }
       break;
     case player::company_plane:
+      if (!game_state->board.research_facility(location)) {
+        break;
+      }
+      for (card::Card card : hand.contents) {
+        if (card.type() != card::city) {
+          continue;
+        }
+        for (city::CityId id = 0; id < game_state->cities->size(); id++) {
+          if (id != location) {
+            Move move = create_action(role, player::company_plane, role, id);
+            move.cards[0] = card;
+            moves->push_back(move);
+          }
+        }
+      }
       break;
-    
     default:
       break;
     }
   }
 
-  std::vector<PlayerChoice> get_player_choices(player::Role role, GameState game_state, TurnState turn_state) {
-    std::vector<PlayerChoice> result;
+  void get_player_choices(player::Role role, GameStateView game_state, const TurnState &turn_state, MoveList *moves) {
+    moves->clear();
     if (turn_state.event_cards_played) {
-      auto actions = player::get_actions(role);
-      for (auto cursor = actions.begin(); cursor != actions.end(); cursor++) {
-        add_choices_for_action_type(&result, role, *cursor, game_state);
+      if (turn_state.remaining_actions <= 0) {
+        return;
       }
-      return result;
+      for (player::ActionType action : player::get_actions(role)) {
+        if (action != player::company_plane || !turn_state.company_plane_used) {
+          add_choices_for_action_type(moves, role, action, game_state);
+        }
+      }
+      return;
     }
 
-    player::Player player = game_state.get_player(role);
-    for (std::vector<card::Card>::iterator cursor = player.hand.contents.begin(); cursor != player.hand.contents.end(); cursor++) {
-      add_choices_for_card_type(&result, role, cursor->type, game_state);
+    for (card::Card card : game_state->get_player(role).hand.contents) {
+      add_choices_for_card_type(moves, role, card.type(), game_state, false);
     }
-    if (role == player::contingency_planner && game_state.contingency_card.contents.size() > 0) {
-      add_choices_for_card_type(&result, role, game_state.contingency_card.contents[0].type, game_state, true);
+    if (role == player::contingency_planner && game_state->contingency_card.contents.size() > 0) {
+      add_choices_for_card_type(moves, role, game_state->contingency_card.contents[0].type(), game_state, true);
+    }
+  }
+
+  std::string begin_prompt(card::CardType event, bool from_contingency_card) {
+    std::string result = from_contingency_card ? "Use " : "Play ";
+    result += card::name_of(event);
+    if (from_contingency_card) {
+      result += " from your role card";
     }
     return result;
   }
+
+  std::string describe(const Move &move, GameStateView game_state) {
+    std::string result;
+    if (move.type == play_event) {
+      result = begin_prompt(move.event, move.from_contingency_card);
+      switch (move.event)
+      {
+      case card::one_quiet_night:
+        return result + " to skip the next infect step.";
+      case card::resilient_population:
+        return result + " to remove " + card::name_of(move.cards[0], *game_state->cities) + " from the infection discard.";
+      case card::government_grant:
+        return result + " to place a research facility in " + game_state->cities->name_of(move.target_city) + ".";
+      case card::airlift:
+        return result + " to move the " + player::name_of(move.target_role) + " to " + game_state->cities->name_of(move.target_city) + ".";
+      default:
+        throw std::invalid_argument("This card can't be played as an event.");
+      }
+    }
+    const city::Graph &cities = *game_state->cities;
+    std::string pawn = move.target_role == move.role ? "" : "the " + player::name_of(move.target_role) + " ";
+    switch (move.action)
+    {
+    case player::drive:
+      return "Drive " + pawn + "to " + cities.name_of(move.target_city) + ".";
+    case player::direct_flight:
+      return "Discard " + cities.name_of(move.target_city) + " to fly " + pawn + "to " + cities.name_of(move.target_city) + ".";
+    case player::charter_flight:
+      return "Discard " + cities.name_of(game_state->player_locations[move.target_role]) + " to fly " + pawn + "to " + cities.name_of(move.target_city) + ".";
+    case player::shuttle:
+      return "Shuttle " + pawn + "to " + cities.name_of(move.target_city) + ".";
+    case player::build:
+      result = "Build a research station in " + cities.name_of(move.target_city);
+      if (move.source_city != NO_CITY) {
+        result += " using the one in " + cities.name_of(move.source_city);
+      }
+      return result + ".";
+    case player::treat:
+      return "Treat " + disease::name_of(move.color) + " disease in " + cities.name_of(move.target_city) + ".";
+    case player::share:
+      if (card::contains(game_state->get_player(move.role).hand, move.cards[0])) {
+        return "Give " + card::name_of(move.cards[0], cities) + " to the " + player::name_of(move.target_role) + ".";
+      }
+      return "Take " + card::name_of(move.cards[0], cities) + " from the " + player::name_of(move.target_role) + ".";
+    case player::cure:
+      return "Discover a cure for " + disease::name_of(move.color) + " disease.";
+    case player::reclaim:
+      return "Reclaim " + card::name_of(move.cards[0], cities) + " from the player discard.";
+    case player::conference:
+      return "Move " + pawn + "to " + cities.name_of(move.target_city) + ".";
+    case player::company_plane:
+      return "Discard " + card::name_of(move.cards[0], cities) + " to fly to " + cities.name_of(move.target_city) + ".";
+    default:
+      throw std::invalid_argument("This is not an action.");
+    }
+  }
 }
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "sim/batch.hpp"
+
+namespace gerryfudd::sim {
+  std::unique_ptr<Policy> random_policy(uint64_t seed) {
+    return std::make_unique<RandomPolicy>(seed);
+  }
+
+  GameSetup game_setup(uint64_t batch_seed, uint32_t index) {
+    uint64_t state = batch_seed ^ (uint64_t{index} << 32 | index);
+    uint64_t hash = random::splitmix64(state);
+    GameSetup result;
+    result.difficulty = (Difficulty) (hash % DIFFICULTY_COUNT);
+    result.player_count = MIN_PLAYER_COUNT + (hash / DIFFICULTY_COUNT) % PLAYER_COUNT_OPTIONS;
+    result.seed = random::splitmix64(state);
+    return result;
+  }
+
+  BatchSummary::BatchSummary(): games{}, wins{}, losses{}, outbreak_counts{}, epidemic_counts{}, epidemic_turn_totals{}, turns{0} {}
+
+  void BatchSummary::add(const GameSetup &setup, const GameResult &result) {
+    games[setup.difficulty][setup.player_count - MIN_PLAYER_COUNT]++;
+    wins[setup.difficulty][setup.player_count - MIN_PLAYER_COUNT] += result.won;
+    losses[result.loss_reason]++;
+    outbreak_counts[std::min(result.outbreaks, OUTBREAK_LIMIT)]++;
+    for (int i = 0; i < result.epidemic_turns.size(); i++) {
+      epidemic_counts[i]++;
+      epidemic_turn_totals[i] += result.epidemic_turns[i];
+    }
+    turns += result.turns;
+  }
+
+  void BatchSummary::merge(const BatchSummary &other) {
+    for (int difficulty = 0; difficulty < DIFFICULTY_COUNT; difficulty++) {
+      for (int i = 0; i < PLAYER_COUNT_OPTIONS; i++) {
+        games[difficulty][i] += other.games[difficulty][i];
+        wins[difficulty][i] += other.wins[difficulty][i];
+      }
+    }
+    for (size_t i = 0; i < losses.size(); i++) {
+      losses[i] += other.losses[i];
+    }
+    for (size_t i = 0; i < outbreak_counts.size(); i++) {
+      outbreak_counts[i] += other.outbreak_counts[i];
+    }
+    for (int i = 0; i < MAX_EPIDEMIC_COUNT; i++) {
+      epidemic_counts[i] += other.epidemic_counts[i];
+      epidemic_turn_totals[i] += other.epidemic_turn_totals[i];
+    }
+    turns += other.turns;
+  }
+
+  long BatchSummary::game_count() const {
+    long result = 0;
+    for (const std::array<long, PLAYER_COUNT_OPTIONS> &row : games) {
+      for (long count : row) {
+        result += count;
+      }
+    }
+    return result;
+  }
+
+  long BatchSummary::win_count() const {
+    long result = 0;
+    for (const std::array<long, PLAYER_COUNT_OPTIONS> &row : wins) {
+      for (long count : row) {
+        result += count;
+      }
+    }
+    return result;
+  }
+
+  double BatchSummary::win_rate() const {
+    long count = game_count();
+    return count == 0 ? 0 : (double) win_count() / count;
+  }
+
+  double BatchSummary::win_rate(Difficulty difficulty, int player_count) const {
+    long count = games[difficulty][player_count - MIN_PLAYER_COUNT];
+    return count == 0 ? 0 : (double) wins[difficulty][player_count - MIN_PLAYER_COUNT] / count;
+  }
+
+  double BatchSummary::mean_epidemic_turn(int i) const {
+    return epidemic_counts[i] == 0 ? 0 : (double) epidemic_turn_totals[i] / epidemic_counts[i];
+  }
+
+  uint64_t pack(uint32_t begin, uint32_t end) {
+    return uint64_t{end} << 32 | begin;
+  }
+
+  WorkRange::WorkRange(): bounds{0} {}
+
+  void WorkRange::reset(uint32_t begin, uint32_t end) {
+    bounds.store(pack(begin, end));
+  }
+
+  bool WorkRange::take(uint32_t chunk, uint32_t *begin, uint32_t *end) {
+    uint64_t current = bounds.load();
+    while (true) {
+      uint32_t first = current, last = current >> 32;
+      if (first >= last) {
+        return false;
+      }
+      uint32_t taken = std::min(last, first + chunk);
+      if (bounds.compare_exchange_weak(current, pack(taken, last))) {
+        *begin = first;
+        *end = taken;
+        return true;
+      }
+    }
+  }
+
+  // Only the thief's owner calls this, and only once its own range is empty,
+  // so no one else can be claiming from the thief's range at the same time.
+  bool WorkRange::steal_into(WorkRange *thief) {
+    uint64_t current = bounds.load();
+    while (true) {
+      uint32_t first = current, last = current >> 32;
+      if (first >= last || last - first < 2) {
+        return false;
+      }
+      uint32_t middle = first + (last - first) / 2;
+      if (bounds.compare_exchange_weak(current, pack(first, middle))) {
+        thief->reset(middle, last);
+        return true;
+      }
+    }
+  }
+
+  BatchRunner::BatchRunner(): BatchRunner::BatchRunner(std::max(1u, std::thread::hardware_concurrency())) {}
+  BatchRunner::BatchRunner(int thread_count): BatchRunner::BatchRunner(thread_count, random_policy) {}
+  BatchRunner::BatchRunner(int thread_count, PolicyFactory policy_factory): thread_count{thread_count}, policy_factory{policy_factory} {
+    if (thread_count < 1) {
+      throw std::invalid_argument("A batch needs at least one thread.");
+    }
+  }
+
+  BatchSummary BatchRunner::run(uint32_t game_count, uint64_t batch_seed) {
+    std::vector<WorkRange> ranges(thread_count);
+    for (int i = 0; i < thread_count; i++) {
+      ranges[i].reset((uint64_t{game_count} * i) / thread_count, (uint64_t{game_count} * (i + 1)) / thread_count);
+    }
+    std::vector<BatchSummary> summaries(thread_count);
+
+    std::function<void(int)> work = [&](int worker) {
+      BatchSummary local;
+      // One simulator per thread, so its move buffer is allocated once rather
+      // than for every game.
+      Simulator simulator{nullptr};
+      uint32_t begin, end;
+      while (true) {
+        while (ranges[worker].take(BATCH_CHUNK_SIZE, &begin, &end)) {
+          for (uint32_t i = begin; i < end; i++) {
+            GameSetup setup = game_setup(batch_seed, i);
+            std::unique_ptr<Policy> policy = policy_factory(setup.seed);
+            simulator.set_policy(policy.get());
+            local.add(setup, simulator.play(setup.difficulty, setup.player_count, setup.seed));
+          }
+        }
+        bool stolen = false;
+        for (int offset = 1; offset < thread_count && !stolen; offset++) {
+          stolen = ranges[(worker + offset) % thread_count].steal_into(&ranges[worker]);
+        }
+        if (!stolen) {
+          break;
+        }
+      }
+      summaries[worker] = local;
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < thread_count; i++) {
+      threads.emplace_back(work, i);
+    }
+    work(0);
+    BatchSummary result;
+    for (int i = 0; i < thread_count; i++) {
+      if (i > 0) {
+        threads[i - 1].join();
+      }
+      result.merge(summaries[i]);
+    }
+    return result;
+  }
+}
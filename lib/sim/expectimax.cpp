@@ -0,0 +1,324 @@
+#include <algorithm>
+#include "sim/expectimax.hpp"
+
+namespace gerryfudd::sim {
+  ExpectimaxOptions::ExpectimaxOptions(): depth{2}, probability_threshold{0.02} {}
+
+  ExpectimaxStats::ExpectimaxStats(): nodes{0}, memo_hits{0}, cutoffs{0} {}
+
+  void add_outcome(Outcomes *outcomes, int group, int position) {
+    for (Outcome &outcome : *outcomes) {
+      if (outcome.group == group) {
+        outcome.count++;
+        return;
+      }
+    }
+    outcomes->push_back(Outcome{group, position, 1});
+  }
+
+  int player_outcomes(const GameState &state, Outcomes *outcomes) {
+    const card::Deck &deck = state.player_deck;
+    int total = 0;
+    for (int size : state.epidemic_piles) {
+      total += size;
+    }
+    int drawn = total - deck.remaining();
+    if (state.epidemic_piles.empty() || drawn < 0) {
+      for (int i = 0; i < deck.remaining(); i++) {
+        card::Card card = deck.reveal(i);
+        add_outcome(outcomes, card.type() == card::city ? (int) card::city + (*state.cities)[card.city_id()].color : (int) card.type(), i);
+      }
+      return deck.remaining();
+    }
+    // The pile being drawn, how many of its cards are left and whether its
+    // epidemic is still to come: each pile's is the next one drawn.
+    int pile = 0, end = 0;
+    for (int size : state.epidemic_piles) {
+      end += size;
+      if (end > drawn) {
+        break;
+      }
+      pile++;
+    }
+    int left = end - drawn;
+    bool due = state.infection_rate_level <= pile;
+    Outcomes cards;
+    int epidemic_position = -1, others = 0;
+    for (int i = 0; i < deck.remaining(); i++) {
+      card::Card card = deck.reveal(i);
+      if (card.type() == card::epidemic) {
+        epidemic_position = epidemic_position == -1 ? i : epidemic_position;
+        continue;
+      }
+      add_outcome(&cards, card.type() == card::city ? (int) card::city + (*state.cities)[card.city_id()].color : (int) card.type(), i);
+      others++;
+    }
+    // The epidemic is drawn with chance 1 / left, and otherwise the card is
+    // equally likely to be any of the other undrawn cards, since which pile
+    // they were dealt into is unknown. The counts are out of left * others.
+    if (!due || epidemic_position == -1) {
+      *outcomes = cards;
+      return others;
+    }
+    if (left == 1 || others == 0) {
+      outcomes->push_back(Outcome{(int) card::epidemic, epidemic_position, 1});
+      return 1;
+    }
+    outcomes->push_back(Outcome{(int) card::epidemic, epidemic_position, others});
+    for (Outcome outcome : cards) {
+      outcome.count *= left - 1;
+      outcomes->push_back(outcome);
+    }
+    return left * others;
+  }
+
+  int epidemic_outcomes(const GameState &state, Outcomes *outcomes) {
+    if (state.infection_deck.remaining() == 0) {
+      return 0;
+    }
+    int available = state.infection_deck.layer_size(state.infection_deck.layer_of(-1));
+    for (int i = state.infection_deck.remaining() - available; i < state.infection_deck.remaining(); i++) {
+      add_outcome(outcomes, (*state.cities)[state.infection_deck.reveal(i).city_id()].color, i);
+    }
+    return available;
+  }
+
+  int infection_outcomes(const GameState &state, Outcomes *outcomes) {
+    int available = state.infection_deck.layer_size(state.infection_deck.layer_of(0));
+    for (int i = 0; i < available; i++) {
+      city::CityId id = state.infection_deck.reveal(i).city_id();
+      disease::DiseaseColor color = (*state.cities)[id].color;
+      int count = state.board.cube_count(id, color);
+      // A full city breaks out and a protected one takes no cube, so each is
+      // its own outcome.
+      bool alone = count == MAX_CUBES_PER_CITY || state.prevent_placement(id, color);
+      add_outcome(outcomes, alone ? DISEASE_COLOR_COUNT * MAX_CUBES_PER_CITY + id : color * MAX_CUBES_PER_CITY + count, i);
+    }
+    return available;
+  }
+
+  // The expectation over the outcomes, with Star1 cutoffs: each outcome is
+  // searched with the window that would let it move the expectation, and the
+  // rest are skipped once the expectation can't reach the window even if they
+  // are all worth 1 or can't leave it even if they are all worth 0. A cut
+  // returns the bound it was cut on.
+  template <typename Follow>
+  double expect(const Outcomes &outcomes, int total, double alpha, double beta, double probability, ExpectimaxStats *stats, Follow follow) {
+    double sum = 0, remaining = 1;
+    for (const Outcome &outcome : outcomes) {
+      double p = (double) outcome.count / total;
+      remaining -= p;
+      double child_alpha = std::max(0.0, (alpha - sum - remaining) / p);
+      double child_beta = std::min(1.0, (beta - sum) / p);
+      sum += p * follow(outcome, child_alpha, child_beta, probability * p);
+      if (sum + remaining <= alpha) {
+        stats->cutoffs++;
+        return sum + remaining;
+      }
+      if (sum >= beta) {
+        stats->cutoffs++;
+        return sum;
+      }
+    }
+    return sum;
+  }
+
+  // Chance nodes are told apart by the position, the draws left and what is
+  // being drawn.
+  uint64_t memo_key(const GameState &state, const TurnState &turn_state, int stage) {
+    uint64_t situation = uint64_t{(uint64_t) stage} << 24 | uint64_t{(uint64_t) turn_state.active_role} << 16
+      | uint64_t{(uint64_t) turn_state.remaining_player_card_draws} << 8 | (uint64_t) turn_state.remaining_infection_card_draws;
+    return state.hash() ^ zobrist::key(zobrist::outbreaks, OUTBREAK_LIMIT + 1 + situation);
+  }
+
+  ExpectimaxPolicy::ExpectimaxPolicy(): ExpectimaxPolicy::ExpectimaxPolicy(ExpectimaxOptions()) {}
+  ExpectimaxPolicy::ExpectimaxPolicy(ExpectimaxOptions options): options{options} {
+    if (options.depth < 1) {
+      throw std::invalid_argument("A search must look at least one action ahead.");
+    }
+    levels.resize(options.depth);
+  }
+
+  bool ExpectimaxPolicy::recall(uint64_t key, double alpha, double beta, double *value) {
+    std::unordered_map<uint64_t, MemoEntry>::const_iterator found = memo.find(key);
+    if (found == memo.end()) {
+      return false;
+    }
+    const MemoEntry &entry = found->second;
+    if (entry.bound == exact || (entry.bound == lower_bound && entry.value >= beta) || (entry.bound == upper_bound && entry.value <= alpha)) {
+      search_stats.memo_hits++;
+      *value = entry.value;
+      return true;
+    }
+    return false;
+  }
+
+  void ExpectimaxPolicy::remember(uint64_t key, double alpha, double beta, double value) {
+    if (memo.size() >= MEMO_LIMIT) {
+      memo.clear();
+    }
+    memo[key] = MemoEntry{value, value <= alpha ? upper_bound : value >= beta ? lower_bound : exact};
+  }
+
+  double ExpectimaxPolicy::decide(Game &game, TurnState &turn_state, int depth, double alpha, double beta, double probability) {
+    search_stats.nodes++;
+    // Stopping here is always an option.
+    double best = draw_stage(game, turn_state, alpha, beta, probability);
+    if (depth == 0 || turn_state.remaining_actions <= 0 || best >= beta) {
+      return best;
+    }
+    MoveList &moves = levels[depth];
+    get_player_choices(turn_state.active_role, game.get_state(), turn_state, &moves);
+    for (const Move &move : moves) {
+      Undo undo = game.apply(move, turn_state);
+      double value = count_cures(game.get_state()) == DISEASE_COLOR_COUNT ? 1 : decide(game, turn_state, depth - 1, std::max(alpha, best), beta, probability);
+      game.undo(undo, turn_state);
+      if (value > best) {
+        best = value;
+      }
+      if (best >= beta) {
+        search_stats.cutoffs++;
+        break;
+      }
+    }
+    return best;
+  }
+
+  double ExpectimaxPolicy::draw_stage(Game &game, const TurnState &turn_state, double alpha, double beta, double probability) {
+    if (turn_state.remaining_player_card_draws > 0) {
+      return draw_player_cards(game, turn_state, alpha, beta, probability);
+    }
+    // As in a simulated turn, hands are cut down and the rate is read once the
+    // player cards are drawn.
+    Undo undo = game.checkpoint(turn_state);
+    const GameState &state = game.get_state();
+    for (int i = 0; i < (int) state.players.size(); i++) {
+      player::Role role = state.players[i].role;
+      while (state.players[i].hand.contents.size() > HAND_LIMIT) {
+        game.discard(game.remove_player_card(role, weakest_card(role, state)));
+      }
+    }
+    TurnState drawing = turn_state;
+    if (drawing.remaining_infection_card_draws > 0) {
+      drawing.remaining_infection_card_draws = state.get_infection_rate();
+    }
+    double value = draw_infection_cards(game, drawing, alpha, beta, probability);
+    game.undo(undo);
+    return value;
+  }
+
+  double ExpectimaxPolicy::draw_player_cards(Game &game, const TurnState &turn_state, double alpha, double beta, double probability) {
+    const GameState &state = game.get_state();
+    search_stats.nodes++;
+    if (state.player_deck.remaining() == 0) {
+      return 0;
+    }
+    if (probability < options.probability_threshold) {
+      return evaluate(state);
+    }
+    uint64_t key = memo_key(state, turn_state, 0);
+    double value;
+    if (recall(key, alpha, beta, &value)) {
+      return value;
+    }
+    Outcomes outcomes;
+    int available = player_outcomes(state, &outcomes);
+    player::Role role = turn_state.active_role;
+    value = expect(outcomes, available, alpha, beta, probability, &search_stats, [&](const Outcome &outcome, double child_alpha, double child_beta, double child_probability) {
+      Undo undo = game.checkpoint(turn_state);
+      TurnState next = turn_state;
+      next.remaining_player_card_draws--;
+      game.draw_player_card(role, outcome.position);
+      card::Card drawn = state.get_player(role).hand.contents.back();
+      double result;
+      if (drawn.type() == card::epidemic) {
+        game.remove_player_card(role, drawn);
+        result = resolve_epidemic(game, next, child_alpha, child_beta, child_probability);
+      } else {
+        result = draw_stage(game, next, child_alpha, child_beta, child_probability);
+      }
+      game.undo(undo);
+      return result;
+    });
+    remember(key, alpha, beta, value);
+    return value;
+  }
+
+  double ExpectimaxPolicy::resolve_epidemic(Game &game, const TurnState &turn_state, double alpha, double beta, double probability) {
+    const GameState &state = game.get_state();
+    search_stats.nodes++;
+    // Outcomes are told apart by position, so a stacked layer is shuffled
+    // before its cards are grouped rather than when the first one is drawn.
+    Undo settled = game.checkpoint(turn_state);
+    game.shuffle_layer(card::infect, -1);
+    Outcomes outcomes;
+    int available = epidemic_outcomes(state, &outcomes);
+    double value = expect(outcomes, available, alpha, beta, probability, &search_stats, [&](const Outcome &outcome, double child_alpha, double child_beta, double child_probability) {
+      Undo undo = game.checkpoint(turn_state);
+      double result = game.epidemic(outcome.position) ? 0 : draw_stage(game, turn_state, child_alpha, child_beta, child_probability);
+      game.undo(undo);
+      return result;
+    });
+    game.undo(settled);
+    return value;
+  }
+
+  double ExpectimaxPolicy::draw_infection_cards(Game &game, const TurnState &turn_state, double alpha, double beta, double probability) {
+    const GameState &state = game.get_state();
+    search_stats.nodes++;
+    if (turn_state.remaining_infection_card_draws == 0 || state.infection_deck.remaining() == 0 || probability < options.probability_threshold) {
+      return evaluate(state);
+    }
+    uint64_t key = memo_key(state, turn_state, 1);
+    double value;
+    if (recall(key, alpha, beta, &value)) {
+      return value;
+    }
+    Undo settled = game.checkpoint(turn_state);
+    game.shuffle_layer(card::infect, 0);
+    Outcomes outcomes;
+    int available = infection_outcomes(state, &outcomes);
+    value = expect(outcomes, available, alpha, beta, probability, &search_stats, [&](const Outcome &outcome, double child_alpha, double child_beta, double child_probability) {
+      Undo undo = game.checkpoint(turn_state);
+      TurnState next = turn_state;
+      next.remaining_infection_card_draws--;
+      double result = game.draw_infection_card(outcome.position) ? 0 : draw_infection_cards(game, next, child_alpha, child_beta, child_probability);
+      game.undo(undo);
+      return result;
+    });
+    game.undo(settled);
+    remember(key, alpha, beta, value);
+    return value;
+  }
+
+  int ExpectimaxPolicy::choose(const MoveList &moves, GameStateView game_state, const TurnState &turn_state) {
+    if (!turn_state.event_cards_played) {
+      return NO_MOVE;
+    }
+    // Values are only reused within a search, since they depend on the
+    // probability each position was reached with.
+    memo.clear();
+    Game game{*game_state};
+    TurnState searching = turn_state;
+    int choice = NO_MOVE;
+    double best = draw_stage(game, searching, 0, 1, 1);
+    for (int i = 0; i < moves.size(); i++) {
+      Undo undo = game.apply(moves[i], searching);
+      double value = count_cures(game.get_state()) == DISEASE_COLOR_COUNT ? 1 : decide(game, searching, options.depth - 1, best, 1, 1);
+      game.undo(undo, searching);
+      if (value > best) {
+        best = value;
+        choice = i;
+      }
+    }
+    return choice;
+  }
+
+  card::Card ExpectimaxPolicy::choose_discard(player::Role role, GameStateView game_state) {
+    return weakest_card(role, game_state);
+  }
+
+  const ExpectimaxStats& ExpectimaxPolicy::stats() const {
+    return search_stats;
+  }
+}
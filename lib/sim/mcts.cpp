@@ -0,0 +1,388 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "sim/mcts.hpp"
+
+namespace gerryfudd::sim {
+  SearchOptions::SearchOptions(): iterations{1000}, milliseconds{0}, threads{1}, exploration{0.3}, rollout_turns{2} {}
+
+  Node create_node(const Move *move) {
+    Node node{};
+    node.pass = move == nullptr;
+    if (move != nullptr) {
+      node.move = *move;
+    }
+    node.first_child = NO_NODE;
+    node.next_sibling = NO_NODE;
+    return node;
+  }
+
+  bool matches(const Node &node, const Move *move) {
+    return move == nullptr ? node.pass : !node.pass && node.move == *move;
+  }
+
+  SearchTree::SearchTree() {
+    clear();
+  }
+  void SearchTree::clear() {
+    nodes.clear();
+    nodes.push_back(create_node(nullptr));
+  }
+  int SearchTree::root() const {
+    return 0;
+  }
+  Node& SearchTree::operator[](int index) {
+    return nodes[index];
+  }
+  const Node& SearchTree::operator[](int index) const {
+    return nodes[index];
+  }
+  int SearchTree::size() const {
+    return nodes.size();
+  }
+  // A nullptr move adds the child reached by passing.
+  int SearchTree::add_child(int parent, const Move *move) {
+    Node child = create_node(move);
+    child.next_sibling = nodes[parent].first_child;
+    nodes.push_back(child);
+    nodes[parent].first_child = nodes.size() - 1;
+    return nodes.size() - 1;
+  }
+  int SearchTree::find_child(int parent, const Move *move) const {
+    for (int child = nodes[parent].first_child; child != NO_NODE; child = nodes[child].next_sibling) {
+      if (matches(nodes[child], move)) {
+        return child;
+      }
+    }
+    return NO_NODE;
+  }
+  // Copies the children of nodes[from] below spare[to], keeping their order.
+  void SearchTree::copy_subtree(int from, int to) {
+    int previous = NO_NODE;
+    spare[to].first_child = NO_NODE;
+    for (int child = nodes[from].first_child; child != NO_NODE; child = nodes[child].next_sibling) {
+      int copy = spare.size();
+      spare.push_back(nodes[child]);
+      spare[copy].next_sibling = NO_NODE;
+      if (previous == NO_NODE) {
+        spare[to].first_child = copy;
+      } else {
+        spare[previous].next_sibling = copy;
+      }
+      previous = copy;
+      copy_subtree(child, copy);
+    }
+  }
+  void SearchTree::advance(int child) {
+    spare.clear();
+    spare.push_back(nodes[child]);
+    spare[0].next_sibling = NO_NODE;
+    copy_subtree(child, 0);
+    std::swap(nodes, spare);
+  }
+
+  // Packs the fields that tell moves apart, for sorting. Equal keys are
+  // confirmed by comparing the moves themselves.
+  uint64_t move_key(const Move &move) {
+    return uint64_t{(uint64_t) move.type} | uint64_t{(uint64_t) move.role} << 1 | uint64_t{(uint64_t) move.event} << 4
+      | uint64_t{(uint64_t) move.action} << 8 | uint64_t{(uint64_t) move.target_role} << 12 | uint64_t{(uint64_t) move.color} << 16
+      | uint64_t{move.from_contingency_card} << 20 | uint64_t{move.target_city} << 24 | uint64_t{move.source_city} << 40
+      | uint64_t{(uint64_t) (move.cards[0].id & 0xFF)} << 56;
+  }
+
+  // The policy an iteration plays with. It descends the tree while every move
+  // offered at a node has been tried, adds a node for the first untried move it
+  // meets, and from then on cures whenever it can and otherwise moves at random.
+  class TreeWalk: public Policy {
+    SearchTree *tree;
+    random::Generator *generator;
+    double exploration;
+    int node;
+    bool in_tree;
+    std::vector<std::pair<uint64_t, int>> children;
+    std::vector<std::pair<int, int>> offered;
+    std::vector<int> untried;
+    int find_offered(const Move&) const;
+    int roll_out(const MoveList&, const TurnState&);
+  public:
+    std::vector<int> path;
+    TreeWalk(SearchTree*, random::Generator*, double);
+    void begin(void);
+    int choose(const MoveList&, GameStateView, const TurnState&) override;
+    card::Card choose_discard(player::Role, GameStateView) override;
+  };
+
+  TreeWalk::TreeWalk(SearchTree *tree, random::Generator *generator, double exploration): tree{tree}, generator{generator}, exploration{exploration} {}
+
+  void TreeWalk::begin() {
+    node = tree->root();
+    in_tree = true;
+    path.clear();
+    path.push_back(node);
+  }
+
+  int TreeWalk::find_offered(const Move &move) const {
+    std::vector<std::pair<uint64_t, int>>::const_iterator cursor = std::lower_bound(children.begin(), children.end(), std::make_pair(move_key(move), NO_NODE));
+    for (; cursor != children.end() && cursor->first == move_key(move); cursor++) {
+      if ((*tree)[cursor->second].move == move) {
+        return cursor->second;
+      }
+    }
+    return NO_NODE;
+  }
+
+  // Cures, then treats, then wanders without spending cards. Events are kept.
+  int TreeWalk::roll_out(const MoveList &moves, const TurnState &turn_state) {
+    if (!turn_state.event_cards_played) {
+      return NO_MOVE;
+    }
+    int treat = NO_MOVE;
+    untried.clear();
+    for (int i = 0; i < moves.size(); i++) {
+      switch (moves[i].action)
+      {
+      case player::cure:
+        return i;
+      case player::treat:
+        treat = i;
+        break;
+      case player::drive:
+      case player::shuttle:
+        untried.push_back(i);
+        break;
+      default:
+        break;
+      }
+    }
+    if (treat != NO_MOVE) {
+      return treat;
+    }
+    return untried.empty() ? generator->below(moves.size()) : untried[generator->below(untried.size())];
+  }
+
+  int TreeWalk::choose(const MoveList &moves, GameStateView, const TurnState &turn_state) {
+    if (!in_tree) {
+      return roll_out(moves, turn_state);
+    }
+    Node &current = (*tree)[node];
+    if (!current.decided) {
+      current.decided = true;
+      current.chooser = moves[0].role;
+      current.event_cards_played = turn_state.event_cards_played;
+      current.remaining_actions = turn_state.remaining_actions;
+    }
+
+    children.clear();
+    int pass_child = NO_NODE;
+    for (int child = current.first_child; child != NO_NODE; child = (*tree)[child].next_sibling) {
+      if ((*tree)[child].pass) {
+        pass_child = child;
+      } else {
+        children.emplace_back(move_key((*tree)[child].move), child);
+      }
+    }
+    std::sort(children.begin(), children.end());
+    offered.clear();
+    untried.clear();
+    for (int i = 0; i < moves.size(); i++) {
+      int child = find_offered(moves[i]);
+      if (child == NO_NODE) {
+        untried.push_back(i);
+      } else {
+        offered.emplace_back(i, child);
+      }
+    }
+    if (!turn_state.event_cards_played) {
+      if (pass_child == NO_NODE) {
+        untried.push_back(NO_MOVE);
+      } else {
+        offered.emplace_back(NO_MOVE, pass_child);
+      }
+    }
+
+    for (const std::pair<int, int> &choice : offered) {
+      (*tree)[choice.second].availability++;
+    }
+    if (!untried.empty()) {
+      int choice = untried[generator->below(untried.size())];
+      node = tree->add_child(node, choice == NO_MOVE ? nullptr : &moves[choice]);
+      (*tree)[node].availability = 1;
+      path.push_back(node);
+      in_tree = false;
+      return choice;
+    }
+
+    int best = NO_MOVE;
+    double best_bound = -1;
+    for (const std::pair<int, int> &choice : offered) {
+      const Node &child = (*tree)[choice.second];
+      double bound = child.value / child.visits + exploration * std::sqrt(std::log(child.availability) / child.visits);
+      if (bound > best_bound) {
+        best = choice.first;
+        best_bound = bound;
+        node = choice.second;
+      }
+    }
+    path.push_back(node);
+    return best;
+  }
+
+  card::Card TreeWalk::choose_discard(player::Role role, GameStateView game_state) {
+    return weakest_card(role, game_state);
+  }
+
+  void determinize(GameState *state, random::Generator &generator) {
+    // The infection cards that epidemics put back are known to be on top, so
+    // each layer is shuffled in place.
+    int start = 0;
+    for (int layer = state->infection_deck.layer_count() - 1; layer >= 0; layer--) {
+      state->infection_deck.shuffle(start, start + state->infection_deck.layer_size(layer), generator);
+      start += state->infection_deck.layer_size(layer);
+    }
+    // Each epidemic was shuffled into its own pile, so one whose pile is still
+    // to be drawn stays in it. The other undrawn cards could be in any pile,
+    // so they are dealt at random across all of them. A deck that wasn't dealt
+    // in piles is shuffled whole.
+    int total = 0;
+    for (int size : state->epidemic_piles) {
+      total += size;
+    }
+    int drawn = total - state->player_deck.remaining();
+    if (state->epidemic_piles.empty() || drawn < 0) {
+      state->player_deck.shuffle(0, state->player_deck.remaining(), generator);
+    } else {
+      // The undrawn part of each pile whose epidemic hasn't been drawn, as
+      // [first, end) from the top of the deck, and where its epidemic is.
+      fixed::Vector<std::pair<int, int>, MAX_EPIDEMIC_COUNT> due;
+      fixed::Vector<int, MAX_EPIDEMIC_COUNT> positions;
+      int pile_start = 0;
+      for (int size : state->epidemic_piles) {
+        int first = std::max(pile_start, drawn) - drawn, end = pile_start + size - drawn;
+        for (int position = first; position < end; position++) {
+          if (state->player_deck.reveal(position).type() == card::epidemic) {
+            due.push_back({first, end});
+            positions.push_back(position);
+            break;
+          }
+        }
+        pile_start += size;
+      }
+      // Bottom pile first, so the positions above stay put.
+      fixed::Vector<card::Card, MAX_EPIDEMIC_COUNT> epidemics;
+      for (int i = due.size() - 1; i >= 0; i--) {
+        epidemics.push_back(state->player_deck.draw(positions[i]));
+      }
+      state->player_deck.shuffle(0, state->player_deck.remaining(), generator);
+      // Top pile first, so the cards above each pile are already in place.
+      for (int i = 0; i < due.size(); i++) {
+        state->player_deck.insert(epidemics[due.size() - 1 - i], due[i].first + generator.below(due[i].second - due[i].first));
+      }
+    }
+    state->generator = random::Generator{generator()};
+  }
+
+  double score(const GameState &state, const GameResult &result) {
+    if (result.won) {
+      return 1;
+    }
+    return result.loss_reason == no_loss ? evaluate(state) : evaluate(state) / 2;
+  }
+
+  MctsPolicy::MctsPolicy(SearchOptions options, uint64_t seed): options{options}, trees(options.threads) {
+    if (options.threads < 1) {
+      throw std::invalid_argument("A search needs at least one thread.");
+    }
+    if (options.iterations <= 0 && options.milliseconds <= 0) {
+      throw std::invalid_argument("A search needs an iteration or time budget.");
+    }
+    random::Generator seeder{seed};
+    for (int i = 0; i < options.threads; i++) {
+      generators.emplace_back(seeder());
+    }
+  }
+
+  // Starts over if the game has left the tree, as when it is driven by
+  // something other than this policy between choices.
+  void MctsPolicy::align(const MoveList &moves, const TurnState &turn_state) {
+    for (SearchTree &tree : trees) {
+      const Node &root = tree[tree.root()];
+      if (root.decided && (root.chooser != moves[0].role || root.event_cards_played != turn_state.event_cards_played || root.remaining_actions != turn_state.remaining_actions)) {
+        tree.clear();
+      }
+    }
+  }
+
+  void MctsPolicy::search(int thread, const MoveList &moves, const GameState &root_state, const TurnState &turn_state) {
+    SearchTree &tree = trees[thread];
+    random::Generator &generator = generators[thread];
+    TreeWalk walk{&tree, &generator, options.exploration};
+    Simulator simulator{&walk, options.rollout_turns};
+    int iterations = options.iterations / options.threads + (thread < options.iterations % options.threads);
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.milliseconds);
+    for (int i = 0; options.iterations <= 0 || i < iterations; i++) {
+      if (options.milliseconds > 0 && std::chrono::steady_clock::now() >= deadline) {
+        break;
+      }
+      GameState deal = root_state;
+      determinize(&deal, generator);
+      Game game{deal};
+      walk.begin();
+      GameResult result = simulator.play(game, turn_state, moves[0].role);
+      double value = score(game.get_state(), result);
+      for (int visited : walk.path) {
+        tree[visited].visits++;
+        tree[visited].value += value;
+      }
+    }
+  }
+
+  int MctsPolicy::choose(const MoveList &moves, GameStateView game_state, const TurnState &turn_state) {
+    align(moves, turn_state);
+    std::vector<std::thread> threads;
+    for (int i = 1; i < options.threads; i++) {
+      threads.emplace_back(&MctsPolicy::search, this, i, std::cref(moves), std::cref(*game_state), std::cref(turn_state));
+    }
+    search(0, moves, *game_state, turn_state);
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+
+    int best = NO_MOVE;
+    long best_visits = -1;
+    for (int i = turn_state.event_cards_played ? 0 : NO_MOVE; i < moves.size(); i++) {
+      long visits = 0;
+      for (const SearchTree &tree : trees) {
+        int child = tree.find_child(tree.root(), i == NO_MOVE ? nullptr : &moves[i]);
+        visits += child == NO_NODE ? 0 : tree[child].visits;
+      }
+      if (visits > best_visits) {
+        best = i;
+        best_visits = visits;
+      }
+    }
+    for (SearchTree &tree : trees) {
+      int child = tree.find_child(tree.root(), best == NO_MOVE ? nullptr : &moves[best]);
+      if (child == NO_NODE) {
+        tree.clear();
+      } else {
+        tree.advance(child);
+      }
+    }
+    return best;
+  }
+
+  card::Card MctsPolicy::choose_discard(player::Role role, GameStateView game_state) {
+    return weakest_card(role, game_state);
+  }
+
+  int MctsPolicy::root_visits() const {
+    int result = 0;
+    for (const SearchTree &tree : trees) {
+      result += tree[tree.root()].visits;
+    }
+    return result;
+  }
+}
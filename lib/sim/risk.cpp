@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sim/risk.hpp"
+
+// A group's cards are in the layer they started in, the discard pile or one of
+// the layers that epidemics put on top during the turns assessed.
+#define START_SLOT 0
+#define DISCARD_SLOT 1
+#define SLOT_COUNT (2 + 2 * RISK_TURN_LIMIT)
+#define STACK_CAPACITY (MAX_DECK_LAYERS + 2 * RISK_TURN_LIMIT)
+
+namespace gerryfudd::sim {
+  RiskReport::RiskReport(): turns{0}, epidemic_probability{0}, outbreak_loss_probability{0} {
+    draw_probability.fill(0);
+    outbreak_probability.fill(0);
+  }
+
+  // The cities whose cards start in the same layer, or the discard pile at -1,
+  // with the same cubes. The odds of one of their cards are kept by slot, cube
+  // count and outbreaks so far. Where cubes can't be placed, the cube count
+  // counts draws instead.
+  struct CardGroup {
+    int layer;
+    int cubes;
+    bool prevented;
+    double odds[SLOT_COUNT][MAX_CUBES_PER_CITY + 1][RISK_OUTBREAK_CAP + 1];
+    // Summaries of the odds: the chance of being drawn and of each number of
+    // outbreaks.
+    double drawn;
+    std::array<double, RISK_OUTBREAK_CAP + 1> outbreaks;
+  };
+
+  // The sizes of the infection deck's layers, bottom first, of which the first
+  // `original` were in the deck at the start.
+  struct LayerStack {
+    std::array<int, STACK_CAPACITY> sizes;
+    int count;
+    int original;
+    int discard;
+  };
+
+  // The player draws, counted from now, that are epidemics.
+  struct Schedule {
+    fixed::Vector<int, 2 * RISK_TURN_LIMIT> draws;
+    double probability;
+  };
+
+  // A pile whose epidemic is still to come and may be among the next draws,
+  // which are [first, last) of them.
+  struct EpidemicPile {
+    int first;
+    int last;
+    int undrawn;
+  };
+
+  int slot_of(const CardGroup &group, const LayerStack &stack, int layer) {
+    if (layer >= stack.original) {
+      return 2 + layer - stack.original;
+    }
+    return layer == group.layer ? START_SLOT : -1;
+  }
+
+  // Moves the given share of a slot's odds to the discard pile, as its card is
+  // drawn for an infection or as the bottom card of an epidemic.
+  void draw_from(CardGroup &group, int slot, double share, bool epidemic) {
+    for (int cubes = 0; cubes <= MAX_CUBES_PER_CITY; cubes++) {
+      for (int outbreaks = 0; outbreaks <= RISK_OUTBREAK_CAP; outbreaks++) {
+        double moved = group.odds[slot][cubes][outbreaks] * share;
+        if (moved == 0) {
+          continue;
+        }
+        group.odds[slot][cubes][outbreaks] -= moved;
+        int next_cubes = cubes, next_outbreaks = outbreaks;
+        if (group.prevented) {
+          next_cubes = std::min(cubes + 1, MAX_CUBES_PER_CITY);
+        } else if (epidemic) {
+          next_outbreaks = cubes > 0 ? std::min(outbreaks + 1, RISK_OUTBREAK_CAP) : outbreaks;
+          next_cubes = MAX_CUBES_PER_CITY;
+        } else if (cubes == MAX_CUBES_PER_CITY) {
+          next_outbreaks = std::min(outbreaks + 1, RISK_OUTBREAK_CAP);
+        } else {
+          next_cubes = cubes + 1;
+        }
+        group.odds[DISCARD_SLOT][next_cubes][next_outbreaks] += moved;
+      }
+    }
+  }
+
+  void infect(std::vector<CardGroup> &groups, LayerStack &stack, int draws) {
+    for (int layer = stack.count - 1; layer >= 0 && draws > 0; layer--) {
+      int taken = std::min(draws, stack.sizes[layer]);
+      if (taken == 0) {
+        continue;
+      }
+      for (CardGroup &group : groups) {
+        int slot = slot_of(group, stack, layer);
+        if (slot != -1) {
+          draw_from(group, slot, (double) taken / stack.sizes[layer], false);
+        }
+      }
+      stack.sizes[layer] -= taken;
+      stack.discard += taken;
+      draws -= taken;
+    }
+  }
+
+  void epidemic(std::vector<CardGroup> &groups, LayerStack &stack) {
+    int bottom = 0;
+    while (bottom < stack.count && stack.sizes[bottom] == 0) {
+      bottom++;
+    }
+    if (bottom == stack.count) {
+      return;
+    }
+    for (CardGroup &group : groups) {
+      int slot = slot_of(group, stack, bottom);
+      if (slot != -1) {
+        draw_from(group, slot, 1.0 / stack.sizes[bottom], true);
+      }
+    }
+    stack.sizes[bottom]--;
+    stack.discard++;
+
+    // The discard pile, now including the bottom card, becomes the top layer.
+    int top = stack.count++;
+    stack.sizes[top] = stack.discard;
+    stack.discard = 0;
+    for (CardGroup &group : groups) {
+      int slot = slot_of(group, stack, top);
+      for (int cubes = 0; cubes <= MAX_CUBES_PER_CITY; cubes++) {
+        for (int outbreaks = 0; outbreaks <= RISK_OUTBREAK_CAP; outbreaks++) {
+          group.odds[slot][cubes][outbreaks] = group.odds[DISCARD_SLOT][cubes][outbreaks];
+          group.odds[DISCARD_SLOT][cubes][outbreaks] = 0;
+        }
+      }
+    }
+  }
+
+  void place_epidemics(const fixed::Vector<EpidemicPile, MAX_EPIDEMIC_COUNT> &piles, int pile, Schedule schedule, std::vector<Schedule> *schedules) {
+    if (pile == piles.size()) {
+      schedules->push_back(schedule);
+      return;
+    }
+    const EpidemicPile &current = piles[pile];
+    for (int draw = current.first; draw < current.last; draw++) {
+      Schedule placed = schedule;
+      placed.draws.push_back(draw);
+      placed.probability /= current.undrawn;
+      place_epidemics(piles, pile + 1, placed, schedules);
+    }
+    if (current.last - current.first < current.undrawn) {
+      schedule.probability *= 1 - (double) (current.last - current.first) / current.undrawn;
+      place_epidemics(piles, pile + 1, schedule, schedules);
+    }
+  }
+
+  // Every way the epidemics may fall among the next draws. The piles are
+  // drawn in order, so a pile's epidemic has been drawn once as many
+  // epidemics have come as piles have been started.
+  void schedule_epidemics(const GameState &state, int draws, std::vector<Schedule> *schedules) {
+    int total = 0;
+    for (int size : state.epidemic_piles) {
+      total += size;
+    }
+    int drawn = total - state.player_deck.remaining();
+    fixed::Vector<EpidemicPile, MAX_EPIDEMIC_COUNT> piles;
+    int start = 0;
+    for (int i = 0; drawn >= 0 && i < state.epidemic_piles.size(); i++) {
+      int end = start + state.epidemic_piles[i];
+      bool epidemic_drawn = start < drawn && state.infection_rate_level > i;
+      int first = std::max(start, drawn), last = std::min(end, drawn + draws);
+      if (!epidemic_drawn && first < last) {
+        piles.push_back(EpidemicPile{first - drawn, last - drawn, end - first});
+      }
+      start = end;
+    }
+    place_epidemics(piles, 0, Schedule{{}, 1}, schedules);
+  }
+
+  // The outbreaks that an outbreak in a city sets off, itself included, on
+  // the current board.
+  int chain_length(const GameState &state, city::CityId origin) {
+    disease::DiseaseColor color = (*state.cities)[origin].color;
+    city::CitySet reached;
+    reached.insert(origin);
+    fixed::Vector<city::CityId, MAX_CITY_COUNT> pending;
+    pending.push_back(origin);
+    int result = 0;
+    while (!pending.empty()) {
+      city::CityId target = pending.back();
+      pending.pop_back();
+      result++;
+      for (city::CityId neighbor : state.cities->neighbors(target)) {
+        if (!reached.contains(neighbor) && state.board.saturated(color).contains(neighbor) && !state.prevent_placement(neighbor, color)) {
+          reached.insert(neighbor);
+          pending.push_back(neighbor);
+        }
+      }
+    }
+    return result;
+  }
+
+  int group_of(std::vector<CardGroup> &groups, const GameState &state, city::CityId city_id, int layer) {
+    disease::DiseaseColor color = (*state.cities)[city_id].color;
+    bool prevented = state.prevent_placement(city_id, color);
+    int cubes = prevented ? 0 : state.board.cube_count(city_id, color);
+    for (int i = 0; i < (int) groups.size(); i++) {
+      if (groups[i].layer == layer && groups[i].cubes == cubes && groups[i].prevented == prevented) {
+        return i;
+      }
+    }
+    CardGroup group{};
+    group.layer = layer;
+    group.cubes = cubes;
+    group.prevented = prevented;
+    groups.push_back(group);
+    return groups.size() - 1;
+  }
+
+  RiskReport assess_risk(const GameState &state, int turns) {
+    if (turns < 1 || turns > RISK_TURN_LIMIT) {
+      throw std::invalid_argument("Risk is assessed for 1 to " + std::to_string(RISK_TURN_LIMIT) + " turns.");
+    }
+    RiskReport result;
+    result.turns = turns;
+
+    std::vector<CardGroup> groups;
+    std::array<int, MAX_CITY_COUNT> city_groups;
+    city_groups.fill(-1);
+    const card::Deck &deck = state.infection_deck;
+    for (card::Card card : deck.get_discard_contents()) {
+      city_groups[card.city_id()] = group_of(groups, state, card.city_id(), -1);
+    }
+    for (int position = 0; position < deck.remaining(); position++) {
+      city::CityId city_id = deck.reveal(position).city_id();
+      city_groups[city_id] = group_of(groups, state, city_id, deck.layer_of(position));
+    }
+    LayerStack initial{};
+    initial.original = initial.count = deck.layer_count();
+    for (int layer = 0; layer < initial.count; layer++) {
+      initial.sizes[layer] = deck.layer_size(layer);
+    }
+    initial.discard = deck.get_discard_contents().size();
+
+    std::vector<Schedule> schedules;
+    schedule_epidemics(state, std::min(2 * turns, state.player_deck.remaining()), &schedules);
+    std::array<int, MAX_CITY_COUNT> chains;
+    chains.fill(0);
+    int outbreaks_left = OUTBREAK_LIMIT - state.outbreaks;
+
+    for (const Schedule &schedule : schedules) {
+      for (CardGroup &group : groups) {
+        std::fill(&group.odds[0][0][0], &group.odds[0][0][0] + SLOT_COUNT * (MAX_CUBES_PER_CITY + 1) * (RISK_OUTBREAK_CAP + 1), 0.0);
+        group.odds[group.layer == -1 ? DISCARD_SLOT : START_SLOT][group.cubes][0] = 1;
+      }
+      LayerStack stack = initial;
+      int level = state.infection_rate_level;
+      int next_epidemic = 0;
+      for (int turn = 0; turn < turns; turn++) {
+        for (; next_epidemic < schedule.draws.size() && schedule.draws[next_epidemic] / 2 == turn; next_epidemic++) {
+          epidemic(groups, stack);
+          level = std::min(level + 1, INFECTION_RATE_SIZE - 1);
+        }
+        infect(groups, stack, Game::infection_rate_escalation[level]);
+      }
+      if (!schedule.draws.empty()) {
+        result.epidemic_probability += schedule.probability;
+      }
+
+      // The total outbreaks, with every count from outbreaks_left up kept as one.
+      std::array<double, OUTBREAK_LIMIT + 1> totals{};
+      totals[0] = 1;
+      int reach = 0;
+      for (CardGroup &group : groups) {
+        group.outbreaks.fill(0);
+        double unchanged = 0;
+        for (int slot = 0; slot < SLOT_COUNT; slot++) {
+          unchanged += group.odds[slot][group.cubes][0];
+          for (int cubes = 0; cubes <= MAX_CUBES_PER_CITY; cubes++) {
+            for (int outbreaks = 0; outbreaks <= RISK_OUTBREAK_CAP; outbreaks++) {
+              group.outbreaks[outbreaks] += group.odds[slot][cubes][outbreaks];
+            }
+          }
+        }
+        group.drawn = 1 - unchanged;
+      }
+      for (city::CityId id = 0; id < state.cities->size(); id++) {
+        if (city_groups[id] == -1) {
+          continue;
+        }
+        const CardGroup &group = groups[city_groups[id]];
+        result.draw_probability[id] += schedule.probability * group.drawn;
+        double broken_out = 0;
+        for (int outbreaks = 1; outbreaks <= RISK_OUTBREAK_CAP; outbreaks++) {
+          broken_out += group.outbreaks[outbreaks];
+        }
+        result.outbreak_probability[id] += schedule.probability * broken_out;
+        if (broken_out == 0 || outbreaks_left <= 0) {
+          continue;
+        }
+        if (chains[id] == 0) {
+          chains[id] = chain_length(state, id);
+        }
+        std::array<double, OUTBREAK_LIMIT + 1> combined{};
+        for (int total = 0; total <= reach; total++) {
+          for (int outbreaks = 0; outbreaks <= RISK_OUTBREAK_CAP; outbreaks++) {
+            combined[std::min(total + outbreaks * chains[id], outbreaks_left)] += totals[total] * group.outbreaks[outbreaks];
+          }
+        }
+        totals = combined;
+        reach = std::min(reach + RISK_OUTBREAK_CAP * chains[id], outbreaks_left);
+      }
+      result.outbreak_loss_probability += schedule.probability * (outbreaks_left <= 0 ? 1 : totals[outbreaks_left]);
+    }
+    return result;
+  }
+}
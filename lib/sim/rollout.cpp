@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <span>
+#include "sim/rollout.hpp"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#define NO_DRAW -1
+
+namespace gerryfudd::sim {
+  // The same swaps as Deck's Fisher-Yates over [first, last).
+  void shuffle_range(fixed::Vector<city::CityId, DECK_CAPACITY> &deck, int first, int last, random::Generator &generator) {
+    for (int i = last - 1; i > first; i--) {
+      std::swap(deck[i], deck[first + generator.below(i - first + 1)]);
+    }
+  }
+
+  GameBatch::GameBatch(const GameState &state): cities{state.cities} {
+    int slots = state.cities->size() * DISEASE_COLOR_COUNT;
+    cube_lanes.resize(slots * BATCH_LANES);
+    prevented.resize(slots);
+    city_colors.resize(state.cities->size());
+    for (city::CityId id = 0; id < state.cities->size(); id++) {
+      city_colors[id] = (*state.cities)[id].color;
+      for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+        int slot = id * DISEASE_COLOR_COUNT + color;
+        prevented[slot] = state.prevent_placement(id, (disease::DiseaseColor) color);
+        std::fill_n(cube_lanes.begin() + slot * BATCH_LANES, BATCH_LANES, state.board.cube_count(id, (disease::DiseaseColor) color));
+      }
+    }
+    for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+      reserve_lanes[color].fill(state.diseases[color].reserve);
+    }
+    outbreak_lanes.fill(state.outbreaks);
+    rate_lanes.fill(state.infection_rate_level);
+    lost_lanes.fill(0);
+    for (int i = state.infection_deck.remaining() - 1; i >= 0; i--) {
+      decks[0].push_back(state.infection_deck.reveal(i).city_id());
+    }
+    // Game shuffles a stacked layer with its generator once the draws reach it.
+    random::Generator generator = state.generator;
+    int last = decks[0].size();
+    for (int layer = state.infection_deck.layer_count() - 1; layer >= 0; layer--) {
+      int first = last - state.infection_deck.layer_size(layer);
+      if (state.infection_deck.is_stacked(layer)) {
+        shuffle_range(decks[0], first, last, generator);
+      }
+      last = first;
+    }
+    decks.fill(decks[0]);
+  }
+  GameBatch::GameBatch(const GameState &state, random::Generator &generator): GameBatch(state) {
+    for (int lane = 0; lane < BATCH_LANES; lane++) {
+      int first = 0;
+      for (int layer = 0; layer < state.infection_deck.layer_count(); layer++) {
+        int last = first + state.infection_deck.layer_size(layer);
+        shuffle_range(decks[lane], first, last, generator);
+        first = last;
+      }
+    }
+  }
+
+  // The same walk as Game::place_disease, in one lane.
+  void GameBatch::place_disease(int lane, city::CityId city_id, disease::DiseaseColor color) {
+    fixed::Vector<city::CityId, OUTBREAK_STACK_CAPACITY> pending;
+    city::CitySet executed_outbreaks;
+    int32_t &reserve = reserve_lanes[color][lane];
+    pending.push_back(city_id);
+    while (!pending.empty()) {
+      city::CityId target = pending.back();
+      pending.pop_back();
+      int slot = target * DISEASE_COLOR_COUNT + color;
+      if (prevented[slot]) {
+        continue;
+      }
+      if (reserve <= 0) {
+        lost_lanes[lane] = 1;
+        return;
+      }
+      int32_t &cubes = cube_lanes[slot * BATCH_LANES + lane];
+      if (cubes == MAX_CUBES_PER_CITY) {
+        if (executed_outbreaks.contains(target)) {
+          continue;
+        }
+        if (++outbreak_lanes[lane] >= OUTBREAK_LIMIT) {
+          lost_lanes[lane] = 1;
+          return;
+        }
+        executed_outbreaks.insert(target);
+        std::span<const city::CityId> neighbors = cities->neighbors(target);
+        for (int i = neighbors.size() - 1; i >= 0; i--) {
+          pending.push_back(neighbors[i]);
+        }
+        continue;
+      }
+      reserve--;
+      cubes++;
+    }
+  }
+
+  // Places one cube in every lane that drew a card. With AVX2 the cube and
+  // reserve counts of eight lanes are gathered at once and checked against the
+  // outbreak threshold and the empty reserve together, leaving only the lanes
+  // that break out or lose for the scalar walk.
+  void GameBatch::draw(const Lanes &drawn) {
+    for (int group = 0; group < BATCH_LANES; group += 8) {
+#ifdef __AVX2__
+      const __m256i zero = _mm256_setzero_si256();
+      const __m256i one = _mm256_set1_epi32(1);
+      const __m256i lane = _mm256_add_epi32(_mm256_set1_epi32(group), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+      __m256i city = _mm256_loadu_si256((const __m256i*) (drawn.data() + group));
+      __m256i lost = _mm256_loadu_si256((const __m256i*) (lost_lanes.data() + group));
+      __m256i active = _mm256_and_si256(_mm256_cmpgt_epi32(city, _mm256_set1_epi32(NO_DRAW)), _mm256_cmpeq_epi32(lost, zero));
+      __m256i color = _mm256_mask_i32gather_epi32(zero, city_colors.data(), city, active, 4);
+      __m256i slot = _mm256_add_epi32(_mm256_mullo_epi32(city, _mm256_set1_epi32(DISEASE_COLOR_COUNT)), color);
+      __m256i blocked = _mm256_mask_i32gather_epi32(zero, prevented.data(), slot, active, 4);
+      active = _mm256_and_si256(active, _mm256_cmpeq_epi32(blocked, zero));
+
+      __m256i cube_index = _mm256_add_epi32(_mm256_mullo_epi32(slot, _mm256_set1_epi32(BATCH_LANES)), lane);
+      __m256i reserve_index = _mm256_add_epi32(_mm256_mullo_epi32(color, _mm256_set1_epi32(BATCH_LANES)), lane);
+      __m256i cubes = _mm256_mask_i32gather_epi32(zero, cube_lanes.data(), cube_index, active, 4);
+      __m256i reserves = _mm256_mask_i32gather_epi32(zero, reserve_lanes[0].data(), reserve_index, active, 4);
+      __m256i empty = _mm256_and_si256(active, _mm256_cmpgt_epi32(one, reserves));
+      __m256i saturated = _mm256_andnot_si256(empty, _mm256_and_si256(active, _mm256_cmpeq_epi32(cubes, _mm256_set1_epi32(MAX_CUBES_PER_CITY))));
+      __m256i placed = _mm256_andnot_si256(_mm256_or_si256(empty, saturated), active);
+      // The masks are -1 where set.
+      cubes = _mm256_sub_epi32(cubes, placed);
+      reserves = _mm256_add_epi32(reserves, placed);
+      _mm256_storeu_si256((__m256i*) (lost_lanes.data() + group), _mm256_or_si256(lost, _mm256_and_si256(empty, one)));
+
+      // AVX2 has no scatter, so the placed cubes are written back one by one.
+      alignas(32) int32_t cube_indices[8], cube_counts[8], reserve_counts[8], colors[8];
+      _mm256_store_si256((__m256i*) cube_indices, cube_index);
+      _mm256_store_si256((__m256i*) cube_counts, cubes);
+      _mm256_store_si256((__m256i*) reserve_counts, reserves);
+      _mm256_store_si256((__m256i*) colors, color);
+      int placed_lanes = _mm256_movemask_ps(_mm256_castsi256_ps(placed));
+      int saturated_lanes = _mm256_movemask_ps(_mm256_castsi256_ps(saturated));
+      for (int i = 0; i < 8; i++) {
+        if (placed_lanes & (1 << i)) {
+          cube_lanes[cube_indices[i]] = cube_counts[i];
+          reserve_lanes[colors[i]][group + i] = reserve_counts[i];
+        } else if (saturated_lanes & (1 << i)) {
+          place_disease(group + i, drawn[group + i], (disease::DiseaseColor) colors[i]);
+        }
+      }
+#else
+      for (int lane = group; lane < group + 8; lane++) {
+        if (drawn[lane] != NO_DRAW && !lost_lanes[lane]) {
+          place_disease(lane, drawn[lane], (disease::DiseaseColor) city_colors[drawn[lane]]);
+        }
+      }
+#endif
+    }
+  }
+
+  void GameBatch::infect() {
+    int most = 0;
+    for (int lane = 0; lane < BATCH_LANES; lane++) {
+      most = std::max(most, Game::infection_rate_escalation[rate_lanes[lane]]);
+    }
+    for (int i = 0; i < most; i++) {
+      Lanes drawn;
+      for (int lane = 0; lane < BATCH_LANES; lane++) {
+        drawn[lane] = NO_DRAW;
+        if (!lost_lanes[lane] && i < Game::infection_rate_escalation[rate_lanes[lane]] && !decks[lane].empty()) {
+          drawn[lane] = decks[lane].back();
+          decks[lane].pop_back();
+        }
+      }
+      draw(drawn);
+    }
+  }
+
+  int GameBatch::cube_count(int lane, city::CityId city_id, disease::DiseaseColor color) const {
+    return cube_lanes[(city_id * DISEASE_COLOR_COUNT + color) * BATCH_LANES + lane];
+  }
+  int GameBatch::reserve(int lane, disease::DiseaseColor color) const {
+    return reserve_lanes[color][lane];
+  }
+  int GameBatch::outbreaks(int lane) const {
+    return outbreak_lanes[lane];
+  }
+  int GameBatch::infection_rate_level(int lane) const {
+    return rate_lanes[lane];
+  }
+  int GameBatch::remaining(int lane) const {
+    return decks[lane].size();
+  }
+  bool GameBatch::lost(int lane) const {
+    return lost_lanes[lane];
+  }
+}
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <stdexcept>
+#include "sim/simulator.hpp"
+
+namespace gerryfudd::sim {
+  RandomPolicy::RandomPolicy(): RandomPolicy::RandomPolicy(0) {}
+  RandomPolicy::RandomPolicy(uint64_t seed): generator{seed} {}
+
+  int RandomPolicy::choose(const MoveList &moves, GameStateView, const TurnState &turn_state) {
+    if (!turn_state.event_cards_played) {
+      int choice = generator.below(moves.size() + 1);
+      return choice == moves.size() ? NO_MOVE : choice;
+    }
+    return moves.empty() ? NO_MOVE : generator.below(moves.size());
+  }
+
+  card::Card RandomPolicy::choose_discard(player::Role role, GameStateView game_state) {
+    const card::Hand &hand = game_state->get_player(role).hand;
+    return hand.contents[generator.below(hand.contents.size())];
+  }
+
+  std::string name_of(LossReason reason) {
+    switch (reason)
+    {
+    case no_loss:
+      return "none";
+    case outbreaks:
+      return "outbreaks";
+    case disease_cubes:
+      return "disease cubes";
+    case player_cards:
+      return "player cards";
+    default:
+      throw std::invalid_argument("This is not a loss reason.");
+    }
+  }
+
+  GameResult::GameResult(): won{false}, loss_reason{no_loss}, turns{0}, outbreaks{0}, cures{0} {}
+
+  Simulator::Simulator(Policy *policy): Simulator::Simulator(policy, NO_TURN_LIMIT) {}
+  Simulator::Simulator(Policy *policy, int turn_limit): policy{policy}, turn_limit{turn_limit}, move_buffer{std::make_unique<MoveList>()} {}
+  void Simulator::set_policy(Policy *next) {
+    policy = next;
+  }
+
+  player::Role next_role(const GameState &state, player::Role role) {
+    for (int i = 0; i < (int) state.players.size(); i++) {
+      if (state.players[i].role == role) {
+        return state.players[(i + 1) % state.players.size()].role;
+      }
+    }
+    throw std::invalid_argument("There is no player with this role.");
+  }
+
+  int count_cures(const GameState &state) {
+    int result = 0;
+    for (const disease::DiseaseStatus &status : state.diseases) {
+      result += status.cured;
+    }
+    return result;
+  }
+
+  double evaluate(const GameState &state) {
+    double reserve = 0, collected = 0;
+    for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+      reserve += (double) std::max(state.diseases[color].reserve, 0) / (DISEASE_COLOR_COUNT * DISEASE_RESERVE);
+      if (state.diseases[color].cured) {
+        continue;
+      }
+      int most = 0;
+      for (const player::Player &player : state.players) {
+        int held = 0;
+        for (card::Card card : player.hand.contents) {
+          held += card.type() == card::city && (*state.cities)[card.city_id()].color == color;
+        }
+        most = std::max(most, held);
+      }
+      collected += std::min(most, MAX_MOVE_CARDS) / (double) (MAX_MOVE_CARDS * DISEASE_COLOR_COUNT);
+    }
+    double progress = (1 - (double) state.outbreaks / OUTBREAK_LIMIT + reserve + collected) / 3;
+    return (count_cures(state) + progress) / (DISEASE_COLOR_COUNT + 1);
+  }
+
+  card::Card weakest_card(player::Role role, GameStateView game_state) {
+    const card::Hand &hand = game_state->get_player(role).hand;
+    int held[DISEASE_COLOR_COUNT] = {};
+    for (card::Card card : hand.contents) {
+      if (card.type() == card::city) {
+        held[(*game_state->cities)[card.city_id()].color]++;
+      }
+    }
+    card::Card result = hand.contents[0];
+    int fewest = HAND_CAPACITY + 1;
+    for (card::Card card : hand.contents) {
+      if (card.type() == card::city && held[(*game_state->cities)[card.city_id()].color] < fewest) {
+        result = card;
+        fewest = held[(*game_state->cities)[card.city_id()].color];
+      }
+    }
+    return result;
+  }
+
+  LossReason infection_loss_reason(const GameState &state) {
+    return state.outbreaks >= OUTBREAK_LIMIT ? outbreaks : disease_cubes;
+  }
+
+  // Any player may play an event card at the start of the active player's turn.
+  void Simulator::play_events(Game &game, TurnState &turn_state, int first_player, MoveList *moves) {
+    for (int i = first_player; i < (int) game.get_state().players.size(); i++) {
+      player::Role role = game.get_state().players[i].role;
+      get_player_choices(role, game.get_state(), turn_state, moves);
+      while (!moves->empty()) {
+        int choice = policy->choose(*moves, game.get_state(), turn_state);
+        if (choice == NO_MOVE) {
+          break;
+        }
+        game.apply((*moves)[choice], turn_state);
+        get_player_choices(role, game.get_state(), turn_state, moves);
+      }
+    }
+    turn_state.event_cards_played = true;
+  }
+
+  void Simulator::enforce_hand_limit(Game &game) {
+    for (int i = 0; i < (int) game.get_state().players.size(); i++) {
+      player::Role role = game.get_state().players[i].role;
+      while (game.get_state().players[i].hand.contents.size() > HAND_LIMIT) {
+        game.discard(game.remove_player_card(role, policy->choose_discard(role, game.get_state())));
+      }
+    }
+  }
+
+  GameResult Simulator::play(GameState initial_state) {
+    Game game{initial_state};
+    player::Role first_role = initial_state.players[0].role;
+    return play(game, TurnState{first_role, initial_state.get_infection_rate()}, first_role);
+  }
+
+  GameResult Simulator::play(Game &game, TurnState turn_state, player::Role chooser) {
+    GameResult result;
+    MoveList &moves = *move_buffer;
+    const GameState &state = game.get_state();
+    int first_event_player = 0;
+    while (state.players[first_event_player].role != chooser) {
+      first_event_player++;
+    }
+    for (int turn = 0; turn_limit == NO_TURN_LIMIT || turn < turn_limit; turn++) {
+      result.turns = turn + 1;
+      player::Role role = turn_state.active_role;
+
+      if (!turn_state.event_cards_played) {
+        play_events(game, turn_state, first_event_player, &moves);
+      }
+      first_event_player = 0;
+      while (turn_state.remaining_actions > 0) {
+        get_player_choices(role, state, turn_state, &moves);
+        int choice = moves.empty() ? NO_MOVE : policy->choose(moves, state, turn_state);
+        if (choice == NO_MOVE) {
+          break;
+        }
+        game.apply(moves[choice], turn_state);
+        if (count_cures(state) == DISEASE_COLOR_COUNT) {
+          result.won = true;
+          result.outbreaks = state.outbreaks;
+          result.cures = DISEASE_COLOR_COUNT;
+          return result;
+        }
+      }
+
+      for (; turn_state.remaining_player_card_draws > 0; turn_state.remaining_player_card_draws--) {
+        if (game.draw_player_card(role)) {
+          result.loss_reason = player_cards;
+          break;
+        }
+        card::Card drawn = state.get_player(role).hand.contents.back();
+        if (drawn.type() == card::epidemic) {
+          // Epidemic cards leave the game once they are resolved.
+          game.remove_player_card(role, drawn);
+          result.epidemic_turns.push_back(result.turns);
+          if (game.epidemic()) {
+            result.loss_reason = infection_loss_reason(state);
+            break;
+          }
+        }
+      }
+      if (result.loss_reason != no_loss) {
+        break;
+      }
+      enforce_hand_limit(game);
+
+      // One Quiet Night leaves no draws; otherwise epidemics may have raised the rate.
+      if (turn_state.remaining_infection_card_draws > 0) {
+        turn_state.remaining_infection_card_draws = state.get_infection_rate();
+      }
+      for (; turn_state.remaining_infection_card_draws > 0; turn_state.remaining_infection_card_draws--) {
+        if (game.draw_infection_card()) {
+          result.loss_reason = infection_loss_reason(state);
+          break;
+        }
+      }
+      if (result.loss_reason != no_loss) {
+        break;
+      }
+      turn_state = TurnState{next_role(state, role), state.get_infection_rate()};
+    }
+    result.outbreaks = state.outbreaks;
+    result.cures = count_cures(state);
+    return result;
+  }
+
+  GameResult Simulator::play(Difficulty difficulty, int player_count, uint64_t seed) {
+    return play(initialize_state(difficulty, player_count, seed));
+  }
+}
@@ -1,7 +1,5 @@
 #include <types/card.hpp>
-#include <random>
 #include <stdexcept>
-#include <iostream>
 
 namespace gerryfudd::types::card {
   std::string name_of(DeckType deck_type) {
@@ -33,121 +31,221 @@ namespace gerryfudd::types::card {
         throw std::invalid_argument("This is not a card type.");
     }
   }
-  Card::Card(std::string name, DeckType deck_type): Card::Card(name, deck_type, city) {}
-  Card::Card(std::string name, DeckType deck_type, CardType type): name{name}, deck_type{deck_type}, type{type} {}
-
+  Card::Card(): id{NO_CARD} {}
+  Card::Card(city::CityId city_id, DeckType deck_type): id(deck_type == infect ? city_id | INFECTION_CARD_FLAG : city_id) {}
+  Card::Card(CardType type): id(MAX_CITY_COUNT + type) {}
+  CardType Card::type() const {
+    return (id & ~INFECTION_CARD_FLAG) < MAX_CITY_COUNT ? city : (CardType) (id - MAX_CITY_COUNT);
+  }
+  DeckType Card::deck_type() const {
+    return id & INFECTION_CARD_FLAG ? infect : player;
+  }
+  city::CityId Card::city_id() const {
+    return type() == city ? id & ~INFECTION_CARD_FLAG : NO_CITY;
+  }
+  std::string name_of(Card card, const city::Graph &cities) {
+    if (card.type() == city) {
+      return cities.name_of(card.city_id());
+    }
+    return name_of(card.type());
+  }
 
   Hand::Hand(DeckType deck_type): deck_type{deck_type} {}
-  std::ostream& operator<<(std::ostream& out, const Hand &hand) {
-    out << name_of(hand.deck_type);
-    out << " hand: ";
-    bool middle = false;
-    for (auto cursor = hand.contents.rbegin(); cursor != hand.contents.rend(); cursor++) {
-      if (middle) {
-        out << ", ";
-      } else {
-        middle = true;
+  std::string to_string(const Hand &hand, const city::Graph &cities) {
+    std::string result = name_of(hand.deck_type);
+    result += " hand: ";
+    for (int i = hand.contents.size() - 1; i >= 0; i--) {
+      result += name_of(hand.contents[i], cities);
+      if (i > 0) {
+        result += ", ";
       }
-      out << cursor->name;
     }
-    return out;
+    return result;
   }
 
-  bool contains(Hand hand, std::string card_name) {
-    for (std::vector<Card>::iterator cursor = hand.contents.begin(); cursor != hand.contents.end(); cursor++) {
-      if (cursor->name == card_name) {
+  bool contains(const Hand &hand, Card card) {
+    for (Card held : hand.contents) {
+      if (held == card) {
         return true;
       }
     }
     return false;
   }
 
-  Deck::Deck(DeckType deck_type): deck_type{deck_type} {}
+  Deck::Deck(DeckType deck_type): deck_type{deck_type}, discard_hash{0} {}
   void Deck::discard(Card card) {
-    if (deck_type != card.deck_type) {
+    if (deck_type != card.deck_type()) {
       throw std::invalid_argument("This deck only accepts one type of card.");
     }
     discard_contents.push_back(card);
+    discard_hash ^= zobrist::key(zobrist::discard, card.id);
+  }
+  // Fisher-Yates over contents[first, last), swapping each slot with a random
+  // slot at or below it.
+  void shuffle_range(fixed::Deque<Card, DECK_CAPACITY> &contents, int first, int last, random::Generator &generator) {
+    for (int i = last - 1; i > first; i--) {
+      std::swap(contents[i], contents[first + generator.below(i - first + 1)]);
+    }
+  }
+  void Deck::shuffle(random::Generator &generator) {
+    stack();
+    shuffle_layer(layers.size() - 1, generator);
+  }
+  void Deck::stack() {
+    for (Card card : discard_contents) {
+      contents.push_back(card);
+    }
+    // Past the limit the two oldest layers are treated as one.
+    if (layers.size() == MAX_DECK_LAYERS) {
+      layers[1] += layers[0];
+      stacked[1] = stacked[0] || stacked[1];
+      layers.erase(layers.begin());
+      stacked.erase(stacked.begin());
+    }
+    layers.push_back(discard_contents.size());
+    stacked.push_back(true);
+    discard_contents.clear();
+    discard_hash = 0;
   }
-  int random(int options) {
-    std::random_device generator;
-    std::uniform_int_distribution<int> distribution(0,options-1);
-    return distribution(generator);
+  bool Deck::is_stacked(int layer) const {
+    return stacked[layer];
   }
-  void Deck::shuffle() {
-    int i;
-    while (discard_contents.size() > 0) {
-      i = random(discard_contents.size());
-      contents.push_back(discard_contents[i]);
-      discard_contents.erase(discard_contents.begin() + i);
+  int first_slot(const fixed::Vector<int, MAX_DECK_LAYERS> &layers, int layer) {
+    int result = 0;
+    for (int below = 0; below < layer; below++) {
+      result += layers[below];
     }
+    return result;
   }
-  void Deck::shuffle(int start, int end) {
-    std::vector<Card> tempSection;
-    auto content_addr = contents.end() - end;
-    int temp_i;
-    while (tempSection.size() < end - start) {
-      tempSection.push_back(*content_addr);
-      contents.erase(content_addr);
+  void Deck::shuffle_layer(int layer, random::Generator &generator) {
+    int first = first_slot(layers, layer);
+    shuffle_range(contents, first, first + layers[layer], generator);
+    stacked[layer] = false;
+  }
+  // Replays the swaps of the shuffle and makes them in reverse.
+  void Deck::unshuffle_layer(int layer, random::Generator generator) {
+    int first = first_slot(layers, layer);
+    int last = first + layers[layer];
+    fixed::Vector<int, DECK_CAPACITY> swaps;
+    for (int i = last - 1; i > first; i--) {
+      swaps.push_back(first + generator.below(i - first + 1));
     }
-    while (tempSection.size() > 0) {
-      temp_i = random(tempSection.size());
-      contents.insert(content_addr, tempSection[temp_i]);
-      tempSection.erase(tempSection.begin() + temp_i);
+    for (int i = first + 1; i < last; i++) {
+      std::swap(contents[i], contents[swaps[last - 1 - i]]);
     }
+    stacked[layer] = true;
+  }
+  void Deck::unshuffle() {
+    for (int i = 0; i < layers.back(); i++) {
+      contents.pop_back();
+    }
+    layers.pop_back();
+    stacked.pop_back();
+  }
+  void Deck::shuffle(int start, int end, random::Generator &generator) {
+    shuffle_range(contents, contents.size() - end, contents.size() - start, generator);
   }
   void Deck::insert(Card card, int position) {
-    contents.insert(contents.end() - position, card);
+    if (layers.empty()) {
+      layers.push_back(0);
+      stacked.push_back(false);
+    }
+    insert(card, position, position < remaining() ? layer_of(position) : 0);
+  }
+  void Deck::insert(Card card, int position, int layer) {
+    contents.insert(contents.size() - position, card);
+    layers[layer]++;
   }
 
   Card Deck::draw() {
     return draw(0);
   }
   Card Deck::draw(int i) {
-    std::vector<card::Card>::iterator cursor = contents.begin();
-    int place = 0;
-    while ((contents.size() - i - 1) % contents.size() > place) {
-      cursor++;
-      place++;
-    }
-    Card result = *cursor;
-    contents.erase(cursor);
+    Card result = reveal(i);
+    layers[layer_of(i)]--;
+    if (i == 0) {
+      contents.pop_back();
+    } else if (i == -1) {
+      contents.pop_front();
+    } else {
+      contents.erase((contents.size() - i - 1) % contents.size());
+    }
     return result;
   }
-  Card Deck::reveal(int position) {
+  Card Deck::reveal(int position) const {
     return contents[(contents.size() - position - 1) % contents.size()];
   }
-  int Deck::size() {
+  int Deck::size() const {
     return contents.size() + discard_contents.size();
   }
-  int Deck::remaining() {
+  int Deck::remaining() const {
     return contents.size();
   }
+  int Deck::layer_count() const {
+    return layers.size();
+  }
+  int Deck::layer_size(int layer) const {
+    return layers[layer];
+  }
+  int Deck::layer_of(int position) const {
+    if (position == -1) {
+      int layer = 0;
+      while (layers[layer] == 0) {
+        layer++;
+      }
+      return layer;
+    }
+    int layer = layers.size() - 1;
+    for (int above = layers[layer]; above <= position; above += layers[layer]) {
+      layer--;
+    }
+    return layer;
+  }
 
-  std::vector<Card> Deck::get_discard_contents() {
+  const fixed::Vector<Card, DECK_CAPACITY>& Deck::get_discard_contents() const {
     return discard_contents;
   }
-  Card Deck::remove_from_discard(std::string card_name) {
-    std::vector<Card>::iterator cursor;
-    for (cursor = discard_contents.begin(); cursor != discard_contents.end() && cursor->name != card_name; cursor++) {}
-    if (cursor == discard_contents.end()) {
-      throw std::invalid_argument("The card " + card_name + " is not in the discard pile.");
+  Card Deck::remove_from_discard(Card card) {
+    Card *cursor;
+    for (cursor = discard_contents.begin(); cursor != discard_contents.end() && *cursor != card; cursor++) {}
+    if (cursor == discard_contents.end() && card.type() == city) {
+      throw std::invalid_argument("This city's card is not in the discard pile.");
+    } else if (cursor == discard_contents.end()) {
+      throw std::invalid_argument("The card " + name_of(card.type()) + " is not in the discard pile.");
     }
-    Card result = *cursor;
     discard_contents.erase(cursor);
+    discard_hash ^= zobrist::key(zobrist::discard, card.id);
+    return card;
+  }
+  Card Deck::take_from_discard(int position) {
+    Card result = discard_contents[position];
+    discard_contents.erase(discard_contents.begin() + position);
+    discard_hash ^= zobrist::key(zobrist::discard, result.id);
     return result;
   }
+  void Deck::return_to_discard(Card card, int position) {
+    discard_contents.insert(position, card);
+    discard_hash ^= zobrist::key(zobrist::discard, card.id);
+  }
   Card Deck::draw_and_discard() {
     return draw_and_discard(0);
   }
   Card Deck::draw_and_discard(int i) {
     Card result = draw(i);
     discard_contents.push_back(result);
+    discard_hash ^= zobrist::key(zobrist::discard, result.id);
     return result;
   }
 
+  uint64_t Deck::get_discard_hash() const {
+    return discard_hash;
+  }
+
   void Deck::clear() {
     contents.clear();
+    layers.clear();
+    stacked.clear();
     discard_contents.clear();
+    discard_hash = 0;
   }
 }
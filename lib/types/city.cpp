@@ -1,16 +1,309 @@
 #include <types/city.hpp>
+#include <algorithm>
+#include <bit>
+#include <climits>
 #include <stdexcept>
 
 namespace gerryfudd::types::city {
   City::City(std::string name, disease::DiseaseColor color, int population):
     name{name}, color{color}, population{population} {}
-  
+
   City::City(): City::City("", disease::none, -1) {}
 
-  void attach(City *a, City *b) {
-    (*a).neighbors.push_back(*b);
-    (*b).neighbors.push_back(*a);
+  CitySet::iterator::iterator(const uint64_t *words, int word): words{words}, word{word}, remaining{word < CITY_SET_WORDS ? words[word] : 0} {
+    skip_empty_words();
+  }
+
+  void CitySet::iterator::skip_empty_words() {
+    while (remaining == 0 && word < CITY_SET_WORDS) {
+      if (++word < CITY_SET_WORDS) {
+        remaining = words[word];
+      }
+    }
+  }
+
+  CityId CitySet::iterator::operator*() const {
+    return word * 64 + std::countr_zero(remaining);
+  }
+
+  CitySet::iterator& CitySet::iterator::operator++() {
+    remaining &= remaining - 1;
+    skip_empty_words();
+    return *this;
+  }
+
+  bool CitySet::iterator::operator!=(const iterator& other) const {
+    return word != other.word || remaining != other.remaining;
+  }
+
+  CitySet::CitySet(): words{} {}
+
+  bool CitySet::contains(CityId id) const {
+    return (words[id / 64] >> (id % 64)) & 1;
+  }
+
+  void CitySet::insert(CityId id) {
+    words[id / 64] |= uint64_t{1} << (id % 64);
+  }
+
+  void CitySet::erase(CityId id) {
+    words[id / 64] &= ~(uint64_t{1} << (id % 64));
+  }
+
+  int CitySet::size() const {
+    int result = 0;
+    for (uint64_t word : words) {
+      result += std::popcount(word);
+    }
+    return result;
+  }
+
+  bool CitySet::empty() const {
+    for (uint64_t word : words) {
+      if (word != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  CitySet::iterator CitySet::begin() const {
+    return iterator(words.data(), 0);
+  }
+
+  CitySet::iterator CitySet::end() const {
+    return iterator(words.data(), CITY_SET_WORDS);
+  }
+
+  CitySet CitySet::operator&(const CitySet &other) const {
+    CitySet result;
+    for (int i = 0; i < CITY_SET_WORDS; i++) {
+      result.words[i] = words[i] & other.words[i];
+    }
+    return result;
+  }
+
+  CitySet CitySet::operator|(const CitySet &other) const {
+    CitySet result;
+    for (int i = 0; i < CITY_SET_WORDS; i++) {
+      result.words[i] = words[i] | other.words[i];
+    }
+    return result;
+  }
+
+  CitySet CitySet::operator~() const {
+    CitySet result;
+    for (int i = 0; i < CITY_SET_WORDS; i++) {
+      result.words[i] = ~words[i];
+    }
+    return result;
+  }
+
+  Board::Board(): cubes{}, zobrist_hash{0} {}
+
+  uint64_t cube_key(CityId id, disease::DiseaseColor color, int count) {
+    return count == 0 ? 0 : zobrist::key(zobrist::cubes, (uint64_t{id} * DISEASE_COLOR_COUNT + color) * (MAX_CUBES_PER_CITY + 1) + count);
+  }
+
+  int Board::cube_count(CityId id, disease::DiseaseColor color) const {
+    return (cubes[id] >> (2 * color)) & MAX_CUBES_PER_CITY;
+  }
+
+  int Board::cube_count(CityId id) const {
+    int result = 0;
+    for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+      result += cube_count(id, (disease::DiseaseColor) color);
+    }
+    return result;
+  }
+
+  void Board::set_cube_count(CityId id, disease::DiseaseColor color, int count) {
+    if (count < 0 || count > MAX_CUBES_PER_CITY) {
+      throw std::invalid_argument("A city can't hold " + std::to_string(count) + " cubes of one color.");
+    }
+    zobrist_hash ^= cube_key(id, color, cube_count(id, color)) ^ cube_key(id, color, count);
+    cubes[id] = (cubes[id] & ~(MAX_CUBES_PER_CITY << (2 * color))) | (count << (2 * color));
+    if (count > 0) {
+      infected_cities[color].insert(id);
+    } else {
+      infected_cities[color].erase(id);
+    }
+    if (count == MAX_CUBES_PER_CITY) {
+      saturated_cities[color].insert(id);
+    } else {
+      saturated_cities[color].erase(id);
+    }
+  }
+
+  CitySet Board::infected(disease::DiseaseColor color) const {
+    return infected_cities[color];
   }
 
-  CityState::CityState(): research_facility{false} {}
-}
\ No newline at end of file
+  CitySet Board::saturated(disease::DiseaseColor color) const {
+    return saturated_cities[color];
+  }
+
+  bool Board::research_facility(CityId id) const {
+    return research_facilities.contains(id);
+  }
+
+  void Board::set_research_facility(CityId id, bool present) {
+    if (present != research_facility(id)) {
+      zobrist_hash ^= zobrist::key(zobrist::research_facility, id);
+    }
+    if (present) {
+      research_facilities.insert(id);
+    } else {
+      research_facilities.erase(id);
+    }
+  }
+
+  CitySet Board::research_facility_locations() const {
+    return research_facilities;
+  }
+
+  uint64_t Board::hash() const {
+    return zobrist_hash;
+  }
+
+  Graph::Graph(): neighbor_offsets{0}, distances(MAX_CITY_COUNT * MAX_CITY_COUNT, NO_PATH) {
+    for (int i = 0; i < MAX_CITY_COUNT; i++) {
+      distances[i * MAX_CITY_COUNT + i] = 0;
+    }
+  }
+
+  Graph::Graph(const Graph& other):
+    cities{other.cities}, neighbor_offsets{other.neighbor_offsets}, neighbor_ids{other.neighbor_ids}, ids_by_name{other.ids_by_name}, distances{other.distances} {
+    link();
+  }
+
+  Graph& Graph::operator=(const Graph& other) {
+    cities = other.cities;
+    neighbor_offsets = other.neighbor_offsets;
+    neighbor_ids = other.neighbor_ids;
+    ids_by_name = other.ids_by_name;
+    distances = other.distances;
+    link();
+    return *this;
+  }
+
+  void Graph::link() {
+    for (CityId id = 0; id < cities.size(); id++) {
+      cities[id].neighbors = neighbors(id);
+    }
+  }
+
+  CityId Graph::add(City city) {
+    if (cities.size() >= MAX_CITY_COUNT) {
+      throw std::invalid_argument("This graph can't hold any more cities.");
+    }
+    if (ids_by_name.find(city.name) != ids_by_name.end()) {
+      throw std::invalid_argument("The city " + city.name + " is already on this graph.");
+    }
+    CityId id = cities.size();
+    ids_by_name[city.name] = id;
+    cities.push_back(city);
+    cities.back().neighbors = {};
+    neighbor_offsets.push_back(neighbor_offsets.back());
+    return id;
+  }
+
+  // The length of a path made of two legs joined by an edge, or INT_MAX if
+  // either leg doesn't exist.
+  int join_legs(int first, int second) {
+    return first == NO_PATH || second == NO_PATH ? INT_MAX : first + 1 + second;
+  }
+
+  void Graph::attach(CityId a, CityId b) {
+    // Append b to the end of a's neighbors and a to the end of b's neighbors.
+    neighbor_ids.insert(neighbor_ids.begin() + neighbor_offsets[a + 1], b);
+    for (size_t i = a + 1; i < neighbor_offsets.size(); i++) {
+      neighbor_offsets[i]++;
+    }
+    neighbor_ids.insert(neighbor_ids.begin() + neighbor_offsets[b + 1], a);
+    for (size_t i = b + 1; i < neighbor_offsets.size(); i++) {
+      neighbor_offsets[i]++;
+    }
+    link();
+
+    // A new edge can only shorten a path by routing it through that edge.
+    for (CityId i = 0; i < cities.size(); i++) {
+      int to_a = distances[i * MAX_CITY_COUNT + a], to_b = distances[i * MAX_CITY_COUNT + b];
+      if (to_a == NO_PATH && to_b == NO_PATH) {
+        continue;
+      }
+      for (CityId j = 0; j < cities.size(); j++) {
+        int through_edge = std::min(join_legs(to_a, distances[b * MAX_CITY_COUNT + j]), join_legs(to_b, distances[a * MAX_CITY_COUNT + j]));
+        int known = distances[i * MAX_CITY_COUNT + j];
+        if (through_edge == INT_MAX || (known != NO_PATH && through_edge >= known)) {
+          continue;
+        }
+        if (through_edge >= NO_PATH) {
+          throw std::invalid_argument("The cities " + cities[i].name + " and " + cities[j].name + " are too far apart to measure.");
+        }
+        distances[i * MAX_CITY_COUNT + j] = through_edge;
+      }
+    }
+  }
+
+  void Graph::load(std::vector<City> loaded, std::span<const int> offsets, std::span<const CityId> ids, std::span<const uint8_t> loaded_distances) {
+    if (!cities.empty()) {
+      throw std::invalid_argument("Cities may only be loaded onto an empty graph.");
+    }
+    if (loaded.size() > MAX_CITY_COUNT) {
+      throw std::invalid_argument("This graph can't hold any more cities.");
+    }
+    if (offsets.size() != loaded.size() + 1 || offsets.back() != (int) ids.size() || loaded_distances.size() != loaded.size() * loaded.size()) {
+      throw std::invalid_argument("The adjacency arrays don't match the cities being loaded.");
+    }
+    for (CityId id = 0; id < loaded.size(); id++) {
+      if (!ids_by_name.emplace(loaded[id].name, id).second) {
+        throw std::invalid_argument("The city " + loaded[id].name + " is already on this graph.");
+      }
+      for (CityId other = 0; other < loaded.size(); other++) {
+        distances[id * MAX_CITY_COUNT + other] = loaded_distances[id * loaded.size() + other];
+      }
+    }
+    cities = std::move(loaded);
+    neighbor_offsets.assign(offsets.begin(), offsets.end());
+    neighbor_ids.assign(ids.begin(), ids.end());
+    link();
+  }
+
+  int Graph::size() const {
+    return cities.size();
+  }
+
+  const City& Graph::operator[](CityId id) const {
+    return cities[id];
+  }
+
+  std::span<const CityId> Graph::neighbors(CityId id) const {
+    return std::span<const CityId>(neighbor_ids.data() + neighbor_offsets[id], neighbor_ids.data() + neighbor_offsets[id + 1]);
+  }
+
+  bool Graph::adjacent(CityId a, CityId b) const {
+    for (CityId neighbor : neighbors(a)) {
+      if (neighbor == b) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  int Graph::distance(CityId a, CityId b) const {
+    return distances[a * MAX_CITY_COUNT + b];
+  }
+
+  CityId Graph::id_of(std::string name) const {
+    std::map<std::string, CityId>::const_iterator found = ids_by_name.find(name);
+    if (found == ids_by_name.end()) {
+      throw std::invalid_argument("There is no city named " + name + ".");
+    }
+    return found->second;
+  }
+
+  std::string Graph::name_of(CityId id) const {
+    return cities[id].name;
+  }
+}
@@ -133,8 +133,8 @@ namespace gerryfudd::types::player {
       throw std::invalid_argument("This is an invalid combination of role and action.");
     }
   }
-  std::vector<ActionType> get_actions(Role role) {
-    std::vector<ActionType> result;
+  fixed::Vector<ActionType, ACTION_TYPE_COUNT> get_actions(Role role) {
+    fixed::Vector<ActionType, ACTION_TYPE_COUNT> result;
     result.push_back(drive);
     result.push_back(direct_flight);
     result.push_back(charter_flight);
@@ -158,7 +158,7 @@ namespace gerryfudd::types::player {
     }
     return result;
   }
-  std::vector<Role> get_roles(int player_count) {
+  std::vector<Role> get_roles(int player_count, random::Generator &generator) {
     std::vector<Role> result;
     std::vector<Role> remaining;
     remaining.push_back(contingency_planner);
@@ -170,7 +170,7 @@ namespace gerryfudd::types::player {
     remaining.push_back(researcher);
     int i;
     while (result.size() < player_count) {
-      i = card::random(remaining.size());
+      i = generator.below(remaining.size());
       result.push_back(remaining[i]);
       remaining.erase(remaining.begin() + i);
     }
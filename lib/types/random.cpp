@@ -0,0 +1,56 @@
+#include <types/random.hpp>
+#include <random>
+
+namespace gerryfudd::types::random {
+  uint64_t splitmix64(uint64_t &x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+  }
+
+  uint64_t entropy_seed() {
+    std::random_device device;
+    return (uint64_t{device()} << 32) | device();
+  }
+
+  Generator::Generator(): Generator::Generator(0) {}
+
+  Generator::Generator(uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+      state[i] = splitmix64(seed);
+    }
+  }
+
+  uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  uint64_t Generator::operator()() {
+    uint64_t result = rotl(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+  }
+
+  int Generator::below(int bound) {
+    // Lemire's multiply-shift reduction, rejecting the few low products that
+    // would bias the result.
+    uint32_t range = bound;
+    uint64_t product = ((*this)() >> 32) * range;
+    uint32_t low = product;
+    if (low < range) {
+      uint32_t threshold = -range % range;
+      while (low < threshold) {
+        product = ((*this)() >> 32) * range;
+        low = product;
+      }
+    }
+    return product >> 32;
+  }
+}
@@ -0,0 +1,9 @@
+if [ -d './out' ]; then
+  rm ./out/*
+else
+  mkdir ./out/
+fi
+
+/usr/bin/g++ -std=c++20 -O2 -I./include ./lib/**/*.cpp ./lib/*.cpp ./bench/*.cpp "$@" -o ./out/benchmark
+
+./out/benchmark | tee ./bench_output.txt
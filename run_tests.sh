@@ -4,6 +4,6 @@ else
   mkdir ./out/
 fi
 
-/usr/bin/g++ -std=c++20 -I./include -I./tests/include ./lib/**/*.cpp ./lib/*.cpp ./tests/**/*.cpp ./tests/*.cpp -lunwind -o ./out/testable
+/usr/bin/g++ -std=c++20 -I./include -I./tests/include ./lib/**/*.cpp ./lib/*.cpp ./tests/**/*.cpp ./tests/*.cpp -lunwind "$@" -o ./out/testable
 
 ./out/testable
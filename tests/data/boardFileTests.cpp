@@ -0,0 +1,182 @@
+#include <Framework.hpp>
+#include <Assertions.inl>
+#include <data/board_file.hpp>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <game.hpp>
+#include <sim/simulator.hpp>
+
+using namespace gerryfudd::test;
+using namespace gerryfudd::data;
+using namespace gerryfudd::types;
+
+std::string board_file_path(std::string name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+void write_binary_board(std::string text, std::string path) {
+  std::stringstream input(text);
+  std::ofstream output(path, std::ios::binary);
+  board::convert_board(input, output);
+}
+
+// A ring of cities, each also attached to the city opposite it.
+std::string ring_board(int city_count) {
+  std::stringstream text;
+  text << "# A synthetic ring" << std::endl;
+  for (int i = 0; i < city_count; i++) {
+    text << "city\t" << disease::name_of((disease::DiseaseColor) (i % 4)) << "\t" << 1000 * i << "\tCity " << i << std::endl;
+  }
+  for (int i = 0; i < city_count; i++) {
+    text << "edge\tCity " << i << "\tCity " << (i + 1) % city_count << std::endl;
+  }
+  for (int i = 0; i < city_count / 2; i += 5) {
+    text << "edge\tCity " << i << "\tCity " << i + city_count / 2 << std::endl;
+  }
+  return text.str();
+}
+
+TEST(board_file_round_trips_standard_board) {
+  std::shared_ptr<const city::Graph> standard = gerryfudd::core::GameState().cities;
+  std::stringstream text;
+  for (city::CityId id = 0; id < standard->size(); id++) {
+    const city::City &current = (*standard)[id];
+    text << "city\t" << disease::name_of(current.color) << "\t" << current.population << "\t" << current.name << std::endl;
+  }
+  for (city::CityId id = 0; id < standard->size(); id++) {
+    for (city::CityId neighbor : standard->neighbors(id)) {
+      if (id < neighbor) {
+        text << "edge\t" << standard->name_of(id) << "\t" << standard->name_of(neighbor) << std::endl;
+      }
+    }
+  }
+  std::string path = board_file_path("pandemic_standard_board.bin");
+  write_binary_board(text.str(), path);
+
+  city::Graph loaded;
+  board::load_board(path, &loaded);
+  std::filesystem::remove(path);
+
+  assert_equal(loaded.size(), standard->size());
+  for (city::CityId a = 0; a < standard->size(); a++) {
+    assert_equal(loaded.name_of(a), standard->name_of(a));
+    assert_equal(loaded[a].color, (*standard)[a].color);
+    assert_equal(loaded[a].population, (*standard)[a].population);
+    assert_equal(loaded.neighbors(a).size(), standard->neighbors(a).size());
+    for (city::CityId b = 0; b < standard->size(); b++) {
+      assert_equal(loaded.adjacent(a, b), standard->adjacent(a, b));
+      assert_equal(loaded.distance(a, b), standard->distance(a, b));
+    }
+  }
+}
+
+TEST(board_file_rejects_bad_text) {
+  std::stringstream input("city\tblue\t100\tA\nedge\tA\tB\n"), output;
+
+  bool exception_thrown = false;
+  try {
+    board::convert_board(input, output);
+  } catch (std::invalid_argument e) {
+    exception_thrown = true;
+    assert_equal<std::string>(e.what(), "Line 2 attaches a city that hasn't been listed.");
+  }
+  assert_true(exception_thrown, "Attaching an unknown city should throw.");
+}
+
+TEST(board_file_large_board) {
+  std::string path = board_file_path("pandemic_large_board.bin");
+  write_binary_board(ring_board(100), path);
+
+  std::shared_ptr<city::Graph> loaded = std::make_shared<city::Graph>();
+  bool exception_thrown = false;
+  try {
+    board::load_board(path, loaded.get());
+  } catch (std::invalid_argument e) {
+    exception_thrown = true;
+    assert_equal<std::string>(e.what(), "This board has 100 cities, but this build supports at most " + std::to_string(MAX_CITY_COUNT) + ". Rebuild with a larger -DMAX_CITY_COUNT.");
+  }
+  std::filesystem::remove(path);
+  assert_equal(exception_thrown, MAX_CITY_COUNT < 100);
+  if (exception_thrown) {
+    return;
+  }
+
+  assert_equal(loaded->size(), 100);
+  assert_equal(loaded->distance(0, 50), 1);
+  assert_equal(loaded->distance(0, 52), 3);
+  assert_equal(loaded->distance(0, 25), 25);
+  gerryfudd::sim::RandomPolicy policy{1};
+  gerryfudd::sim::Simulator simulator{&policy};
+  gerryfudd::sim::GameResult result = simulator.play(gerryfudd::core::initialize_state(loaded, 0, gerryfudd::core::easy, 4, 1));
+  assert_true(result.turns > 0, "A game should be playable on a large board.");
+}
+
+// A path of cities, each attached only to the ones before and after it.
+std::string line_board(int city_count) {
+  std::stringstream text;
+  for (int i = 0; i < city_count; i++) {
+    text << "city\tblue\t1\tCity " << i << std::endl;
+  }
+  for (int i = 1; i < city_count; i++) {
+    text << "edge\tCity " << i - 1 << "\tCity " << i << std::endl;
+  }
+  return text.str();
+}
+
+// Loads a text board, returning the loader's error or an empty string.
+std::string load_error(std::string text, city::Graph *graph) {
+  std::string path = board_file_path("pandemic_checked_board.bin");
+  write_binary_board(text, path);
+  std::string result;
+  try {
+    board::load_board(path, graph);
+  } catch (std::invalid_argument e) {
+    result = e.what();
+  }
+  std::filesystem::remove(path);
+  return result;
+}
+
+TEST(board_file_rejects_repeated_edges) {
+  city::Graph graph;
+  std::string error = load_error("city\tblue\t1\tA\ncity\tblue\t1\tB\nedge\tA\tB\nedge\tB\tA\n", &graph);
+
+  assert_equal<std::string>(error, "The board file " + board_file_path("pandemic_checked_board.bin") + " attaches B and A twice.");
+}
+
+#if MAX_CITY_COUNT > NO_PATH
+TEST(board_file_farthest_measurable_path) {
+  city::Graph longest;
+  assert_equal<std::string>(load_error(line_board(NO_PATH), &longest), "");
+  assert_equal(longest.distance(0, NO_PATH - 1), NO_PATH - 1);
+
+  city::Graph too_long;
+  assert_equal<std::string>(load_error(line_board(NO_PATH + 1), &too_long), "The board file " + board_file_path("pandemic_checked_board.bin") + " has cities too far apart to measure.");
+}
+#endif
+
+TEST(board_file_rejects_bad_populations_and_names) {
+  for (std::string population : {"4294967296", "99999999999999999999", "-1", "many"}) {
+    std::stringstream input("# Populations\ncity\tblue\t" + population + "\tA\n"), output;
+    bool exception_thrown = false;
+    try {
+      board::convert_board(input, output);
+    } catch (std::invalid_argument e) {
+      exception_thrown = true;
+      assert_equal<std::string>(e.what(), "Line 2 has a population that isn't a count up to 4294967295.");
+    }
+    assert_true(exception_thrown, "A population that doesn't fit should throw.");
+  }
+
+  std::stringstream input("city\tblue\t4294967295\t" + std::string(65536, 'A') + "\n"), output;
+  bool exception_thrown = false;
+  try {
+    board::convert_board(input, output);
+  } catch (std::invalid_argument e) {
+    exception_thrown = true;
+    assert_equal<std::string>(e.what(), "Line 1 has a name longer than 65535 bytes.");
+  }
+  assert_true(exception_thrown, "A name that doesn't fit should throw.");
+}
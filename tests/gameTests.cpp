@@ -1,6 +1,7 @@
 #include <Framework.hpp>
 #include <Assertions.inl>
 #include <game.hpp>
+#include <algorithm>
 #include <set>
 #include <data/city_data.hpp>
 
@@ -22,15 +23,22 @@ TEST(get_state) {
   assert_false(game_state.diseases[disease::yellow].cured, "Yellow is not cured at the start of the game.");
 }
 
+TEST(get_state_shares_city_graph) {
+  Game game;
+
+  assert_true(game.get_state().cities == game.get_state().cities, "Copies of the game state should share one city graph.");
+  assert_true(initialize_state().cities == GameState().cities, "Every game on the standard board should share one city graph.");
+}
+
 TEST(setup_initial_state) {
   GameState game_state = initialize_state();
 
-  assert_equal<int>(game_state.cities.size(), 48);
+  assert_equal<int>(game_state.cities->size(), 48);
 
-  city::City istanbul = game_state.cities["Istanbul"], 
-    montreal = game_state.cities["Montréal"],
-    ho_chi_minh_city = game_state.cities["Ho Chi Minh City"],
-    sao_paulo = game_state.cities["São Paulo"];
+  city::City istanbul = (*game_state.cities)[game_state.cities->id_of("Istanbul")], 
+    montreal = (*game_state.cities)[game_state.cities->id_of("Montréal")],
+    ho_chi_minh_city = (*game_state.cities)[game_state.cities->id_of("Ho Chi Minh City")],
+    sao_paulo = (*game_state.cities)[game_state.cities->id_of("São Paulo")];
   assert_equal<std::string>(istanbul.name, "Istanbul");
   assert_equal(istanbul.color, disease::black);
   assert_equal(istanbul.population, 13576000);
@@ -53,17 +61,36 @@ TEST(setup_initial_state) {
   assert_equal<int>(sao_paulo.neighbors.size(), 4);
 }
 
+TEST(setup_is_reproducible_from_seed) {
+  GameState first = initialize_state(medium, 3, 1234), second = initialize_state(medium, 3, 1234);
+
+  assert_equal<int>(first.players.size(), second.players.size());
+  for (int i = 0; i < (int) first.players.size(); i++) {
+    assert_equal(first.players[i].role, second.players[i].role);
+    assert_equal<int>(first.players[i].hand.contents.size(), second.players[i].hand.contents.size());
+    for (int j = 0; j < first.players[i].hand.contents.size(); j++) {
+      assert_true(first.players[i].hand.contents[j] == second.players[i].hand.contents[j], "Both games should deal the same hands.");
+    }
+  }
+  assert_equal(first.player_deck.remaining(), second.player_deck.remaining());
+  for (int i = 0; i < first.player_deck.remaining(); i++) {
+    assert_true(first.player_deck.reveal(i) == second.player_deck.reveal(i), "Both games should stack the player deck the same way.");
+  }
+  for (city::CityId id = 0; id < first.cities->size(); id++) {
+    assert_equal(first.board.cube_count(id), second.board.cube_count(id));
+  }
+  assert_true(first.generator == second.generator, "Both games should continue from the same generator state.");
+}
+
 TEST(setup_and_get_disease_counts) {
   GameState game_state = initialize_state();
 
   city::City current_city;
-  city::CityState current_state;
   int with_one = 0, with_two = 0, with_three = 0, current_count;
 
-  for (std::map<std::string, city::City>::iterator cursor = game_state.cities.begin(); cursor != game_state.cities.end(); cursor++) {
-    current_city = cursor->second;
-    current_state = game_state.board[cursor->first];
-    current_count = current_state.disease_count[current_city.color];
+  for (city::CityId id = 0; id < game_state.cities->size(); id++) {
+    current_city = (*game_state.cities)[id];
+    current_count = game_state.board.cube_count(id, current_city.color);
     switch (current_count)
     {
     case 1:
@@ -83,6 +110,10 @@ TEST(setup_and_get_disease_counts) {
   assert_equal(with_one, 3);
   assert_equal(with_two, 3);
   assert_equal(with_three, 3);
+  assert_equal(
+    game_state.board.saturated(disease::black).size() + game_state.board.saturated(disease::blue).size() + game_state.board.saturated(disease::red).size() + game_state.board.saturated(disease::yellow).size(),
+    3
+  );
 }
 
 TEST(setup_and_disease_reserve) {
@@ -101,27 +132,27 @@ TEST(setup_and_players) {
   GameState game_state;
   game_state = initialize_state(easy, 2);
   assert_equal<int>(game_state.players.size(), 2);
-  assert_equal<std::string>(game_state.player_locations[game_state.players[0].role], CDC_LOCATION);
-  assert_equal<std::string>(game_state.player_locations[game_state.players[1].role], CDC_LOCATION);
+  assert_equal(game_state.player_locations[game_state.players[0].role], game_state.cities->id_of(CDC_LOCATION));
+  assert_equal(game_state.player_locations[game_state.players[1].role], game_state.cities->id_of(CDC_LOCATION));
 
   game_state = initialize_state(easy, 3);
   assert_equal<int>(game_state.players.size(), 3);
-  assert_equal<std::string>(game_state.player_locations[game_state.players[0].role], CDC_LOCATION);
-  assert_equal<std::string>(game_state.player_locations[game_state.players[1].role], CDC_LOCATION);
-  assert_equal<std::string>(game_state.player_locations[game_state.players[2].role], CDC_LOCATION);
+  assert_equal(game_state.player_locations[game_state.players[0].role], game_state.cities->id_of(CDC_LOCATION));
+  assert_equal(game_state.player_locations[game_state.players[1].role], game_state.cities->id_of(CDC_LOCATION));
+  assert_equal(game_state.player_locations[game_state.players[2].role], game_state.cities->id_of(CDC_LOCATION));
 
   game_state = initialize_state(easy, 4);
   assert_equal<int>(game_state.players.size(), 4);
-  assert_equal<std::string>(game_state.player_locations[game_state.players[0].role], CDC_LOCATION);
-  assert_equal<std::string>(game_state.player_locations[game_state.players[1].role], CDC_LOCATION);
-  assert_equal<std::string>(game_state.player_locations[game_state.players[2].role], CDC_LOCATION);
-  assert_equal<std::string>(game_state.player_locations[game_state.players[3].role], CDC_LOCATION);
+  assert_equal(game_state.player_locations[game_state.players[0].role], game_state.cities->id_of(CDC_LOCATION));
+  assert_equal(game_state.player_locations[game_state.players[1].role], game_state.cities->id_of(CDC_LOCATION));
+  assert_equal(game_state.player_locations[game_state.players[2].role], game_state.cities->id_of(CDC_LOCATION));
+  assert_equal(game_state.player_locations[game_state.players[3].role], game_state.cities->id_of(CDC_LOCATION));
 }
 
 TEST(setup_and_get_research_facility) {
   GameState game_state = initialize_state();
 
-  assert_true(game_state.board[CDC_LOCATION].research_facility, "The CDC location starts with a research facility.");
+  assert_true(game_state.board.research_facility(game_state.cities->id_of(CDC_LOCATION)), "The CDC location starts with a research facility.");
   assert_equal(game_state.research_facility_reserve, 5);
 }
 
@@ -136,7 +167,7 @@ TEST(setup_get_player_by_role) {
     assert_equal<int>(cursor->hand.contents.size(), 2);
     assert_equal<int>(player_by_role.hand.contents.size(), 2);
     for (int j = 0; j < 2; j++) {
-      assert_equal(cursor->hand.contents[j].name, player_by_role.hand.contents[j].name); 
+      assert_true(cursor->hand.contents[j] == player_by_role.hand.contents[j], "Looking a player up by role should return their hand.");
     }
   }
 }
@@ -166,13 +197,11 @@ TEST(draw_infection_card) {
   );
 
   city::City current_city;
-  city::CityState current_state;
   int with_one = 0, with_two = 0, with_three = 0, current_count;
 
-  for (std::map<std::string, city::City>::iterator cursor = game_state.cities.begin(); cursor != game_state.cities.end(); cursor++) {
-    current_city = cursor->second;
-    current_state = game_state.board[cursor->first];
-    current_count = current_state.disease_count[current_city.color];
+  for (city::CityId id = 0; id < game_state.cities->size(); id++) {
+    current_city = (*game_state.cities)[id];
+    current_count = game_state.board.cube_count(id, current_city.color);
     switch (current_count)
     {
     case 1:
@@ -199,11 +228,11 @@ TEST(drive) {
   Game game{game_state};
   
   player::Role first_role = game_state.players[0].role;
-  city::City first_player_location = game_state.cities[game_state.player_locations[first_role]];
+  city::City first_player_location = (*game_state.cities)[game_state.player_locations[first_role]];
 
   assert_equal<std::string>(first_player_location.name, CDC_LOCATION);
 
-  std::string destination = first_player_location.neighbors[0].name;
+  city::CityId destination = game_state.cities->neighbors(game_state.player_locations[first_role])[0];
   game.drive(first_role, destination);
 
   game_state = game.get_state();
@@ -219,7 +248,7 @@ TEST(drive_requires_neighboring_city) {
   bool exception_thrown = false;
 
   try {
-    game.drive(first_role, "Istanbul");
+    game.drive(first_role, game_state.cities->id_of("Istanbul"));
   } catch (std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "This player can't drive to Istanbul");
@@ -229,13 +258,12 @@ TEST(drive_requires_neighboring_city) {
 
 TEST(drive_updates_protection_quarantine_specialist) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::quarantine_specialist));
-  game_state.player_locations[player::quarantine_specialist] = CDC_LOCATION;
+  game_state.player_locations[player::quarantine_specialist] = game_state.cities->id_of(CDC_LOCATION);
   Game game{game_state};
 
-  std::string destination = game_state.cities[CDC_LOCATION].neighbors[0].name;
+  city::CityId destination = game_state.cities->neighbors(game_state.cities->id_of(CDC_LOCATION))[0];
   game.drive(player::quarantine_specialist, destination);
 
   // The destination is protected
@@ -244,25 +272,61 @@ TEST(drive_updates_protection_quarantine_specialist) {
   assert_true(game.get_state().prevent_placement(destination, disease::red), "Quarantine specialist should prevent red cubes in the city they occupy.");
   assert_true(game.get_state().prevent_placement(destination, disease::yellow), "Quarantine specialist should prevent yellow cubes in the city they occupy.");
 
-  city::City destination_city = game.get_state().cities[destination];
-  for (std::vector<city::City>::iterator cursor = destination_city.neighbors.begin(); cursor != destination_city.neighbors.end(); cursor++) {
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::black), "Quarantine specialist should prevent black cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::blue), "Quarantine specialist should prevent blue cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::red), "Quarantine specialist should prevent red cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::yellow), "Quarantine specialist should prevent yellow cubes in all neighboring cities.");
+  for (city::CityId neighbor : game_state.cities->neighbors(destination)) {
+    assert_true(game.get_state().prevent_placement(neighbor, disease::black), "Quarantine specialist should prevent black cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::blue), "Quarantine specialist should prevent blue cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::red), "Quarantine specialist should prevent red cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::yellow), "Quarantine specialist should prevent yellow cubes in all neighboring cities.");
   }
 }
 
+TEST(cure_updates_protection_medic) {
+  GameState game_state{};
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+  game_state.board.set_research_facility(cdc_location, true);
+  game_state.players.push_back(player::Player(player::medic));
+  game_state.player_locations[player::medic] = cdc_location;
+  std::string to_discard[] {"Chicago", "Essen", "London", "Madrid", "Milan"};
+  city::CityId to_discard_ids[5];
+  for (int i = 0; i < 5; i++) {
+    to_discard_ids[i] = game_state.cities->id_of(to_discard[i]);
+    game_state.add_card(player::medic, card::Card(to_discard_ids[i], card::player));
+  }
+  Game game{game_state};
+  assert_false(game.get_state().prevent_placement(cdc_location, disease::blue), "Medic should not prevent blue cubes before blue is cured.");
+
+  game.cure(player::medic, to_discard_ids);
+
+  assert_true(game.get_state().prevent_placement(cdc_location, disease::blue), "Medic should prevent blue cubes once blue is cured.");
+  assert_false(game.get_state().prevent_placement(cdc_location, disease::black), "Medic should not prevent uncured black cubes.");
+}
+
+TEST(dispatcher_move_updates_protection_quarantine_specialist) {
+  GameState game_state{};
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+  city::CityId paris = game_state.cities->id_of("Paris");
+  game_state.players.push_back(player::Player(player::dispatcher));
+  game_state.players.push_back(player::Player(player::quarantine_specialist));
+  game_state.player_locations[player::dispatcher] = cdc_location;
+  game_state.player_locations[player::quarantine_specialist] = cdc_location;
+  game_state.add_card(player::dispatcher, card::Card(paris, card::player));
+  Game game{game_state};
+
+  game.dispatcher_direct_flight(player::quarantine_specialist, paris);
+
+  assert_false(game.get_state().prevent_placement(cdc_location, disease::blue), "Quarantine specialist no longer prevents cubes in the city they leave.");
+  assert_true(game.get_state().prevent_placement(paris, disease::blue), "Quarantine specialist should prevent cubes in the city they are moved to.");
+}
+
 TEST(drive_updates_protection_medic) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::medic));
-  game_state.player_locations[player::medic] = CDC_LOCATION;
+  game_state.player_locations[player::medic] = game_state.cities->id_of(CDC_LOCATION);
   game_state.diseases[disease::blue].cured = true;
   Game game{game_state};
 
-  std::string destination = game_state.cities[CDC_LOCATION].neighbors[0].name;
+  city::CityId destination = game_state.cities->neighbors(game_state.cities->id_of(CDC_LOCATION))[0];
   game.drive(player::medic, destination);
 
   // The destination is protected from blue disease only
@@ -271,60 +335,57 @@ TEST(drive_updates_protection_medic) {
   assert_false(game.get_state().prevent_placement(destination, disease::red), "Medic should not prevent red cubes in the city they occupy.");
   assert_false(game.get_state().prevent_placement(destination, disease::yellow), "Medic should not prevent yellow cubes in the city they occupy.");
 
-  city::City destination_city = game.get_state().cities[destination];
-  for (std::vector<city::City>::iterator cursor = destination_city.neighbors.begin(); cursor != destination_city.neighbors.end(); cursor++) {
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::black), "Medic should not prevent black cubes in any neighboring cities.");
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::blue), "Medic should not prevent blue cubes in any neighboring cities.");
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::red), "Medic should not prevent red cubes in any neighboring cities.");
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::yellow), "Medic should not prevent yellow cubes in any neighboring cities.");
+  for (city::CityId neighbor : game_state.cities->neighbors(destination)) {
+    assert_false(game.get_state().prevent_placement(neighbor, disease::black), "Medic should not prevent black cubes in any neighboring cities.");
+    assert_false(game.get_state().prevent_placement(neighbor, disease::blue), "Medic should not prevent blue cubes in any neighboring cities.");
+    assert_false(game.get_state().prevent_placement(neighbor, disease::red), "Medic should not prevent red cubes in any neighboring cities.");
+    assert_false(game.get_state().prevent_placement(neighbor, disease::yellow), "Medic should not prevent yellow cubes in any neighboring cities.");
   }
 }
 
 TEST(setup_with_quarantine_specialist) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
   game_state.players.push_back(player::Player(player::quarantine_specialist));
-  game_state.player_locations[player::quarantine_specialist] = CDC_LOCATION;
+  game_state.player_locations[player::quarantine_specialist] = game_state.cities->id_of(CDC_LOCATION);
   Game game{game_state};
 
-  city::City cdc_location = game.get_state().cities[CDC_LOCATION];
-  assert_true(game.get_state().prevent_placement(CDC_LOCATION, disease::black), "Quarantine specialist should prevent black cubes in the city they occupy.");
-  assert_true(game.get_state().prevent_placement(CDC_LOCATION, disease::blue), "Quarantine specialist should prevent blue cubes in the city they occupy.");
-  assert_true(game.get_state().prevent_placement(CDC_LOCATION, disease::red), "Quarantine specialist should prevent red cubes in the city they occupy.");
-  assert_true(game.get_state().prevent_placement(CDC_LOCATION, disease::yellow), "Quarantine specialist should prevent yellow cubes in the city they occupy.");
-
-  for (std::vector<city::City>::iterator cursor = cdc_location.neighbors.begin(); cursor != cdc_location.neighbors.end(); cursor++) {
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::black), "Quarantine specialist should prevent black cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::blue), "Quarantine specialist should prevent blue cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::red), "Quarantine specialist should prevent red cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::yellow), "Quarantine specialist should prevent yellow cubes in all neighboring cities.");
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+  assert_true(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::black), "Quarantine specialist should prevent black cubes in the city they occupy.");
+  assert_true(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::blue), "Quarantine specialist should prevent blue cubes in the city they occupy.");
+  assert_true(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::red), "Quarantine specialist should prevent red cubes in the city they occupy.");
+  assert_true(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::yellow), "Quarantine specialist should prevent yellow cubes in the city they occupy.");
+
+  for (city::CityId neighbor : game_state.cities->neighbors(cdc_location)) {
+    assert_true(game.get_state().prevent_placement(neighbor, disease::black), "Quarantine specialist should prevent black cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::blue), "Quarantine specialist should prevent blue cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::red), "Quarantine specialist should prevent red cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::yellow), "Quarantine specialist should prevent yellow cubes in all neighboring cities.");
   }
 }
 
 TEST(direct_flight_quarantine_specialist) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::quarantine_specialist));
-  game_state.player_locations[player::quarantine_specialist] = CDC_LOCATION;
-  std::string destination = "Istanbul";
+  game_state.player_locations[player::quarantine_specialist] = game_state.cities->id_of(CDC_LOCATION);
+  city::CityId destination = game_state.cities->id_of("Istanbul");
   game_state.add_card(player::quarantine_specialist, card::Card(destination, card::player));
   Game game{game_state};
 
   game.direct_flight(player::quarantine_specialist, destination);
 
   // The starting CDC location is unprotected
-  assert_false(game.get_state().prevent_placement(CDC_LOCATION, disease::black), "Quarantine specialist no longer prevents black cubes in the city they leave.");
-  assert_false(game.get_state().prevent_placement(CDC_LOCATION, disease::blue), "Quarantine specialist no longer prevents blue cubes in the city they leave.");
-  assert_false(game.get_state().prevent_placement(CDC_LOCATION, disease::red), "Quarantine specialist no longer prevents red cubes in the city they leave.");
-  assert_false(game.get_state().prevent_placement(CDC_LOCATION, disease::yellow), "Quarantine specialist no longer prevents yellow cubes in the city they leave.");
-
-  city::City cdc_location = game.get_state().cities[CDC_LOCATION];
-  for (std::vector<city::City>::iterator cursor = cdc_location.neighbors.begin(); cursor != cdc_location.neighbors.end(); cursor++) {
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::black), "Quarantine specialist no longer prevents black cubes in the neighbors of the city they leave.");
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::blue), "Quarantine specialist no longer prevents prevent blue cubes in the neighbors of the city they leave.");
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::red), "Quarantine specialist no longer prevents prevent red cubes in the neighbors of the city they leave.");
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::yellow), "Quarantine specialist no longer prevents prevent yellow cubes in the neighbors of the city they leave.");
+  assert_false(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::black), "Quarantine specialist no longer prevents black cubes in the city they leave.");
+  assert_false(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::blue), "Quarantine specialist no longer prevents blue cubes in the city they leave.");
+  assert_false(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::red), "Quarantine specialist no longer prevents red cubes in the city they leave.");
+  assert_false(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::yellow), "Quarantine specialist no longer prevents yellow cubes in the city they leave.");
+
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+  for (city::CityId neighbor : game_state.cities->neighbors(cdc_location)) {
+    assert_false(game.get_state().prevent_placement(neighbor, disease::black), "Quarantine specialist no longer prevents black cubes in the neighbors of the city they leave.");
+    assert_false(game.get_state().prevent_placement(neighbor, disease::blue), "Quarantine specialist no longer prevents prevent blue cubes in the neighbors of the city they leave.");
+    assert_false(game.get_state().prevent_placement(neighbor, disease::red), "Quarantine specialist no longer prevents prevent red cubes in the neighbors of the city they leave.");
+    assert_false(game.get_state().prevent_placement(neighbor, disease::yellow), "Quarantine specialist no longer prevents prevent yellow cubes in the neighbors of the city they leave.");
   }
 
   // The destination is protected
@@ -333,22 +394,20 @@ TEST(direct_flight_quarantine_specialist) {
   assert_true(game.get_state().prevent_placement(destination, disease::red), "Quarantine specialist should prevent red cubes in the city they occupy.");
   assert_true(game.get_state().prevent_placement(destination, disease::yellow), "Quarantine specialist should prevent yellow cubes in the city they occupy.");
 
-  city::City destination_city = game.get_state().cities[destination];
-  for (std::vector<city::City>::iterator cursor = destination_city.neighbors.begin(); cursor != destination_city.neighbors.end(); cursor++) {
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::black), "Quarantine specialist should prevent black cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::blue), "Quarantine specialist should prevent blue cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::red), "Quarantine specialist should prevent red cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::yellow), "Quarantine specialist should prevent yellow cubes in all neighboring cities.");
+  for (city::CityId neighbor : game_state.cities->neighbors(destination)) {
+    assert_true(game.get_state().prevent_placement(neighbor, disease::black), "Quarantine specialist should prevent black cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::blue), "Quarantine specialist should prevent blue cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::red), "Quarantine specialist should prevent red cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::yellow), "Quarantine specialist should prevent yellow cubes in all neighboring cities.");
   }
 }
 
 TEST(direct_flight_requires_card) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
-  std::string destination = "Istanbul";
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+  city::CityId destination = game_state.cities->id_of("Istanbul");
   Game game{game_state};
 
   bool exception_thrown = false;
@@ -363,27 +422,26 @@ TEST(direct_flight_requires_card) {
 
 TEST(charter_flight_quarantine_specialist) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::quarantine_specialist));
-  game_state.player_locations[player::quarantine_specialist] = CDC_LOCATION;
-  game_state.add_card(player::quarantine_specialist, card::Card(CDC_LOCATION, card::player));
+  game_state.player_locations[player::quarantine_specialist] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.add_card(player::quarantine_specialist, card::Card(game_state.cities->id_of(CDC_LOCATION), card::player));
   Game game{game_state};
-  std::string destination = "Istanbul";
+  city::CityId destination = game_state.cities->id_of("Istanbul");
   game.charter_flight(player::quarantine_specialist, destination);
 
   // The starting CDC location is unprotected
-  assert_false(game.get_state().prevent_placement(CDC_LOCATION, disease::black), "Quarantine specialist no longer prevents black cubes in the city they leave.");
-  assert_false(game.get_state().prevent_placement(CDC_LOCATION, disease::blue), "Quarantine specialist no longer prevents blue cubes in the city they leave.");
-  assert_false(game.get_state().prevent_placement(CDC_LOCATION, disease::red), "Quarantine specialist no longer prevents red cubes in the city they leave.");
-  assert_false(game.get_state().prevent_placement(CDC_LOCATION, disease::yellow), "Quarantine specialist no longer prevents yellow cubes in the city they leave.");
-
-  city::City cdc_location = game.get_state().cities[CDC_LOCATION];
-  for (std::vector<city::City>::iterator cursor = cdc_location.neighbors.begin(); cursor != cdc_location.neighbors.end(); cursor++) {
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::black), "Quarantine specialist no longer prevents black cubes in the neighbors of the city they leave.");
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::blue), "Quarantine specialist no longer prevents prevent blue cubes in the neighbors of the city they leave.");
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::red), "Quarantine specialist no longer prevents prevent red cubes in the neighbors of the city they leave.");
-    assert_false(game.get_state().prevent_placement(cursor->name, disease::yellow), "Quarantine specialist no longer prevents prevent yellow cubes in the neighbors of the city they leave.");
+  assert_false(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::black), "Quarantine specialist no longer prevents black cubes in the city they leave.");
+  assert_false(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::blue), "Quarantine specialist no longer prevents blue cubes in the city they leave.");
+  assert_false(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::red), "Quarantine specialist no longer prevents red cubes in the city they leave.");
+  assert_false(game.get_state().prevent_placement(game_state.cities->id_of(CDC_LOCATION), disease::yellow), "Quarantine specialist no longer prevents yellow cubes in the city they leave.");
+
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+  for (city::CityId neighbor : game_state.cities->neighbors(cdc_location)) {
+    assert_false(game.get_state().prevent_placement(neighbor, disease::black), "Quarantine specialist no longer prevents black cubes in the neighbors of the city they leave.");
+    assert_false(game.get_state().prevent_placement(neighbor, disease::blue), "Quarantine specialist no longer prevents prevent blue cubes in the neighbors of the city they leave.");
+    assert_false(game.get_state().prevent_placement(neighbor, disease::red), "Quarantine specialist no longer prevents prevent red cubes in the neighbors of the city they leave.");
+    assert_false(game.get_state().prevent_placement(neighbor, disease::yellow), "Quarantine specialist no longer prevents prevent yellow cubes in the neighbors of the city they leave.");
   }
 
   // The destination is protected
@@ -392,25 +450,23 @@ TEST(charter_flight_quarantine_specialist) {
   assert_true(game.get_state().prevent_placement(destination, disease::red), "Quarantine specialist should prevent red cubes in the city they occupy.");
   assert_true(game.get_state().prevent_placement(destination, disease::yellow), "Quarantine specialist should prevent yellow cubes in the city they occupy.");
 
-  city::City destination_city = game.get_state().cities[destination];
-  for (std::vector<city::City>::iterator cursor = destination_city.neighbors.begin(); cursor != destination_city.neighbors.end(); cursor++) {
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::black), "Quarantine specialist should prevent black cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::blue), "Quarantine specialist should prevent blue cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::red), "Quarantine specialist should prevent red cubes in all neighboring cities.");
-    assert_true(game.get_state().prevent_placement(cursor->name, disease::yellow), "Quarantine specialist should prevent yellow cubes in all neighboring cities.");
+  for (city::CityId neighbor : game_state.cities->neighbors(destination)) {
+    assert_true(game.get_state().prevent_placement(neighbor, disease::black), "Quarantine specialist should prevent black cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::blue), "Quarantine specialist should prevent blue cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::red), "Quarantine specialist should prevent red cubes in all neighboring cities.");
+    assert_true(game.get_state().prevent_placement(neighbor, disease::yellow), "Quarantine specialist should prevent yellow cubes in all neighboring cities.");
   }
 }
 
 TEST(charter_flight_requires_card) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
   game_state.players.push_back(player::Player(player::contingency_planner));
 
   Game game{game_state};
 
   bool exception_thrown = false;
   try {
-    game.charter_flight(player::contingency_planner, "Istanbul");
+    game.charter_flight(player::contingency_planner, game_state.cities->id_of("Istanbul"));
   } catch (std::invalid_argument e) {
     assert_equal<std::string>(e.what(), "This player doesn't have this card.");
     exception_thrown = true;
@@ -421,7 +477,7 @@ TEST(charter_flight_requires_card) {
 TEST(shuttle) {
   Game game{initialize_state()};
 
-  std::string destination = "Istanbul";
+  city::CityId destination = game.get_state().cities->id_of("Istanbul");
   game.place_research_facility(destination);
 
   game.shuttle(game.get_state().players[0].role, destination);
@@ -435,7 +491,7 @@ TEST(shuttle_requires_research_facility) {
 
   bool exception_thrown = false;
   try {
-    game.shuttle(game.get_state().players[0].role, "Istanbul");
+    game.shuttle(game.get_state().players[0].role, game.get_state().cities->id_of("Istanbul"));
   } catch(std::invalid_argument e) {
     exception_thrown = true;
   }
@@ -444,42 +500,40 @@ TEST(shuttle_requires_research_facility) {
 
 TEST(dispatcher_direct_flight) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::dispatcher));
-  game_state.player_locations[player::dispatcher] = CDC_LOCATION;
+  game_state.player_locations[player::dispatcher] = game_state.cities->id_of(CDC_LOCATION);
 
-  std::string destination = "Istanbul";
+  city::CityId destination = game_state.cities->id_of("Istanbul");
   player::Role other_role = player::contingency_planner;
 
   game_state.add_card(player::dispatcher, card::Card(destination, card::player));
 
   game_state.players.push_back(player::Player(other_role));
-  game_state.player_locations[other_role] = game_state.cities[CDC_LOCATION].neighbors[0].name;
+  game_state.player_locations[other_role] = game_state.cities->neighbors(game_state.cities->id_of(CDC_LOCATION))[0];
   Game game{game_state};
 
   game.dispatcher_direct_flight(other_role, destination);
 
-  assert_equal<std::string>(game.get_state().player_locations[other_role], destination);
+  assert_equal(game.get_state().player_locations[other_role], destination);
 }
 
 TEST(dispatcher_direct_flight_requires_card) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::dispatcher));
-  game_state.player_locations[player::dispatcher] = CDC_LOCATION;
+  game_state.player_locations[player::dispatcher] = game_state.cities->id_of(CDC_LOCATION);
 
-  std::string destination = "Istanbul";
+  city::CityId destination = game_state.cities->id_of("Istanbul");
   player::Role other_role = player::contingency_planner;
   
   game_state.players.push_back(player::Player(other_role));
-  game_state.player_locations[other_role] = game_state.cities[CDC_LOCATION].neighbors[0].name;
+  game_state.player_locations[other_role] = game_state.cities->neighbors(game_state.cities->id_of(CDC_LOCATION))[0];
   Game game{game_state};
 
   bool exception_thrown = false;
   try {
-    game.dispatcher_direct_flight(other_role, "Istanbul");
+    game.dispatcher_direct_flight(other_role, destination);
   } catch (std::invalid_argument e) {
     assert_equal<std::string>(e.what(), "This player doesn't have this card.");
     exception_thrown = true;
@@ -489,38 +543,36 @@ TEST(dispatcher_direct_flight_requires_card) {
 
 TEST(dispatcher_charter_flight) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::dispatcher));
-  game_state.player_locations[player::dispatcher] = CDC_LOCATION;
+  game_state.player_locations[player::dispatcher] = game_state.cities->id_of(CDC_LOCATION);
 
-  std::string destination = "Istanbul";
+  city::CityId destination = game_state.cities->id_of("Istanbul");
   player::Role other_role = player::contingency_planner;
 
   
   game_state.players.push_back(player::Player(other_role));
-  game_state.player_locations[other_role] = game_state.cities[CDC_LOCATION].neighbors[0].name;
+  game_state.player_locations[other_role] = game_state.cities->neighbors(game_state.cities->id_of(CDC_LOCATION))[0];
   game_state.add_card(player::dispatcher, card::Card(game_state.player_locations[other_role], card::player));
   Game game{game_state};
 
   game.dispatcher_charter_flight(other_role, destination);
 
-  assert_equal<std::string>(game.get_state().player_locations[other_role], destination);
+  assert_equal(game.get_state().player_locations[other_role], destination);
 }
 
 TEST(dispatcher_charter_flight_requires_card) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::dispatcher));
-  game_state.player_locations[player::dispatcher] = CDC_LOCATION;
+  game_state.player_locations[player::dispatcher] = game_state.cities->id_of(CDC_LOCATION);
 
-  std::string destination = "Istanbul";
+  city::CityId destination = game_state.cities->id_of("Istanbul");
   player::Role other_role = player::contingency_planner;
 
   
   game_state.players.push_back(player::Player(other_role));
-  game_state.player_locations[other_role] = game_state.cities[CDC_LOCATION].neighbors[0].name;
+  game_state.player_locations[other_role] = game_state.cities->neighbors(game_state.cities->id_of(CDC_LOCATION))[0];
   Game game{game_state};
 
   bool exception_thrown = false;
@@ -535,33 +587,31 @@ TEST(dispatcher_charter_flight_requires_card) {
 
 TEST(dispatcher_conference) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::dispatcher));
-  game_state.player_locations[player::dispatcher] = CDC_LOCATION;
+  game_state.player_locations[player::dispatcher] = game_state.cities->id_of(CDC_LOCATION);
 
-  std::string destination = "Istanbul";
+  city::CityId destination = game_state.cities->id_of("Istanbul");
   player::Role other_roles[] = {player::contingency_planner, player::medic };
 
   
   game_state.players.push_back(player::Player(other_roles[0]));
-  game_state.player_locations[other_roles[0]] = CDC_LOCATION;
+  game_state.player_locations[other_roles[0]] = game_state.cities->id_of(CDC_LOCATION);
   game_state.players.push_back(player::Player(other_roles[1]));
-  game_state.player_locations[other_roles[1]] = "Istanbul";
+  game_state.player_locations[other_roles[1]] = destination;
   Game game{game_state};
 
   game.dispatcher_conference(other_roles[0], other_roles[1]);
-  assert_equal<std::string>(game.get_state().player_locations[other_roles[0]], "Istanbul");
+  assert_equal(game.get_state().player_locations[other_roles[0]], destination);
 }
 
 TEST(treat) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
   player::Role non_medic = player::contingency_planner;
 
   game_state.players.push_back(player::Player(non_medic));
-  game_state.player_locations[non_medic] = CDC_LOCATION;
-  game_state.board[CDC_LOCATION].disease_count[disease::blue] = 3;
+  game_state.player_locations[non_medic] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.board.set_cube_count(game_state.cities->id_of(CDC_LOCATION), disease::blue, 3);
 
   Game game{game_state};
 
@@ -569,16 +619,15 @@ TEST(treat) {
   game.treat(non_medic, disease::blue);
 
   // Then there should be two disease markers left.
-  assert_equal(game.get_state().board[CDC_LOCATION].disease_count[disease::blue], 2);
+  assert_equal(game.get_state().board.cube_count(game.get_state().cities->id_of(CDC_LOCATION), disease::blue), 2);
 }
 
 TEST(treat_as_medic) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::medic));
-  game_state.player_locations[player::medic] = CDC_LOCATION;
-  game_state.board[CDC_LOCATION].disease_count[disease::blue] = 3;
+  game_state.player_locations[player::medic] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.board.set_cube_count(game_state.cities->id_of(CDC_LOCATION), disease::blue, 3);
 
   Game game{game_state};
 
@@ -586,19 +635,18 @@ TEST(treat_as_medic) {
   game.treat(player::medic, disease::blue);
 
   // Then there should be no disease markers left.
-  assert_equal(game.get_state().board[CDC_LOCATION].disease_count[disease::blue], 0);
+  assert_equal(game.get_state().board.cube_count(game.get_state().cities->id_of(CDC_LOCATION), disease::blue), 0);
 }
 
 TEST(share) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
-  game_state.add_card(player::contingency_planner, card::Card(CDC_LOCATION, card::player));
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.add_card(player::contingency_planner, card::Card(game_state.cities->id_of(CDC_LOCATION), card::player));
 
   game_state.players.push_back(player::Player(player::dispatcher));
-  game_state.player_locations[player::dispatcher] = CDC_LOCATION;
+  game_state.player_locations[player::dispatcher] = game_state.cities->id_of(CDC_LOCATION);
 
   Game game{game_state};
 
@@ -607,7 +655,7 @@ TEST(share) {
 
   assert_equal<int>(game.get_state().get_player(player::contingency_planner).hand.contents.size(), 0);
   assert_equal<int>(game.get_state().get_player(player::dispatcher).hand.contents.size(), 1);
-  assert_equal<std::string>(game.get_state().get_player(player::dispatcher).hand.contents[0].name, CDC_LOCATION);
+  assert_equal(game.get_state().get_player(player::dispatcher).hand.contents[0].city_id(), game_state.cities->id_of(CDC_LOCATION));
 }
 
 TEST(share_requires_card_of_city) {
@@ -620,7 +668,7 @@ TEST(share_requires_card_of_city) {
 
   // Ensure that the non-researcher doesn't have the starting location card.
   try {
-    game.remove_player_card(non_researcher, CDC_LOCATION);
+    game.remove_player_card(non_researcher, game_state.cities->id_of(CDC_LOCATION));
   } catch(std::invalid_argument) {} // Ignore the exception if the player doesn't have this card already.
 
   // Attempt to share the CDC_LOCATION card.
@@ -640,11 +688,11 @@ TEST(share_requires_same_city) {
   GameState game_state{};
   // Ensure that the player at index 0 has the starting location card.
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
-  game_state.add_card(player::contingency_planner, card::Card(CDC_LOCATION, card::player));
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.add_card(player::contingency_planner, card::Card(game_state.cities->id_of(CDC_LOCATION), card::player));
 
   game_state.players.push_back(player::Player(player::dispatcher));
-  game_state.player_locations[player::dispatcher] = "Istanbul";
+  game_state.player_locations[player::dispatcher] = game_state.cities->id_of("Istanbul");
 
   Game game{game_state};
 
@@ -666,22 +714,22 @@ TEST(share_as_researcher) {
   std::string non_starting_location = "Istanbul";
 
   game_state.players.push_back(player::Player(player::researcher));
-  game_state.player_locations[player::researcher] = CDC_LOCATION;
+  game_state.player_locations[player::researcher] = game_state.cities->id_of(CDC_LOCATION);
   // Ensure that the researcher has some card other than the starting location and that the non-researcher doesn't have this card.
-  game_state.add_card(player::researcher, card::Card(non_starting_location, card::player));
+  game_state.add_card(player::researcher, card::Card(game_state.cities->id_of(non_starting_location), card::player));
 
   player::Role non_researcher = player::contingency_planner;
   game_state.players.push_back(player::Player(non_researcher));
-  game_state.player_locations[non_researcher] = CDC_LOCATION;
+  game_state.player_locations[non_researcher] = game_state.cities->id_of(CDC_LOCATION);
 
   Game game{game_state};
 
   // Share the non-starting location card.
-  game.researcher_share(non_starting_location, non_researcher);
+  game.researcher_share(game_state.cities->id_of(non_starting_location), non_researcher);
 
   assert_equal<int>(game.get_state().get_player(player::researcher).hand.contents.size(), 0);
   assert_equal<int>(game.get_state().get_player(non_researcher).hand.contents.size(), 1);
-  assert_equal<std::string>(game.get_state().get_player(non_researcher).hand.contents[0].name, non_starting_location);
+  assert_equal(game.get_state().get_player(non_researcher).hand.contents[0].city_id(), game_state.cities->id_of(non_starting_location));
 }
 
 TEST(share_as_researcher_requires_same_city) {
@@ -689,20 +737,20 @@ TEST(share_as_researcher_requires_same_city) {
   std::string non_starting_location = "Istanbul";
 
   game_state.players.push_back(player::Player(player::researcher));
-  game_state.player_locations[player::researcher] = CDC_LOCATION;
+  game_state.player_locations[player::researcher] = game_state.cities->id_of(CDC_LOCATION);
   // Ensure that the researcher has some card other than the starting location and that the non-researcher doesn't have this card.
-  game_state.add_card(player::researcher, card::Card(CDC_LOCATION, card::player));
+  game_state.add_card(player::researcher, card::Card(game_state.cities->id_of(CDC_LOCATION), card::player));
 
   player::Role non_researcher = player::contingency_planner;
   game_state.players.push_back(player::Player(non_researcher));
-  game_state.player_locations[non_researcher] = non_starting_location;
+  game_state.player_locations[non_researcher] = game_state.cities->id_of(non_starting_location);
 
   Game game{game_state};
 
   // Attempt to share the CDC_LOCATION card.
   bool exception_thrown = false;
   try {
-    game.researcher_share(CDC_LOCATION, non_researcher);
+    game.researcher_share(game_state.cities->id_of(CDC_LOCATION), non_researcher);
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "Players must be in the same city to share cards.");
@@ -714,21 +762,24 @@ TEST(share_as_researcher_requires_same_city) {
 
 TEST(cure_requires_five_cards_in_hand) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(game_state.cities->id_of(CDC_LOCATION), true);
 
   // Suppose that the contingency planner has four of these cards.
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
   std::string to_discard[] {"Algeirs", "Baghdad", "Cairo", "Chennai", "Delhi"};
+  city::CityId to_discard_ids[5];
+  for (int i = 0; i < 5; i++) {
+    to_discard_ids[i] = game_state.cities->id_of(to_discard[i]);
+  }
   for (int i = 0; i < 4; i++) {
-    game_state.add_card(player::contingency_planner, card::Card(to_discard[i], card::player));
+    game_state.add_card(player::contingency_planner, card::Card(to_discard_ids[i], card::player));
   }
   Game game{game_state};
   
   bool exception_thrown = false;
   try {
-    game.cure(player::contingency_planner, to_discard);
+    game.cure(player::contingency_planner, to_discard_ids);
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "This player doesn't have this card.");
@@ -738,27 +789,30 @@ TEST(cure_requires_five_cards_in_hand) {
   // The player's hand shouldn't be different after a failure.
   assert_equal<int>(game.get_state().get_player(player::contingency_planner).hand.contents.size(), 4);
   for (int i = 0; i < 4; i++) {
-    assert_equal<std::string>(game.get_state().get_player(player::contingency_planner).hand.contents[i].name, to_discard[i]);
+    assert_equal(game.get_state().get_player(player::contingency_planner).hand.contents[i].city_id(), to_discard_ids[i]);
   }
 }
 
 TEST(cure_requires_five_cards_of_the_same_color) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(game_state.cities->id_of(CDC_LOCATION), true);
 
   // Suppose that the contingency planner has four of these cards.
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
   std::string to_discard[] {"Algeirs", "Baghdad", "Cairo", "Chennai", "Atlanta"};
+  city::CityId to_discard_ids[5];
+  for (int i = 0; i < 5; i++) {
+    to_discard_ids[i] = game_state.cities->id_of(to_discard[i]);
+  }
   for (int i = 0; i < 5; i++) {
-    game_state.add_card(player::contingency_planner, card::Card(to_discard[i], card::player));
+    game_state.add_card(player::contingency_planner, card::Card(to_discard_ids[i], card::player));
   }
   Game game{game_state};
   
   bool exception_thrown = false;
   try {
-    game.cure(game.get_state().players[0].role, to_discard);
+    game.cure(game.get_state().players[0].role, to_discard_ids);
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "Curing a disease requires that all discarded cards share a color.");
@@ -768,26 +822,29 @@ TEST(cure_requires_five_cards_of_the_same_color) {
   // The player's hand shouldn't be different after a failure.
   assert_equal<int>(game.get_state().get_player(player::contingency_planner).hand.contents.size(), 5);
   for (int i = 0; i < 5; i++) {
-    assert_equal<std::string>(game.get_state().get_player(player::contingency_planner).hand.contents[i].name, to_discard[i]);
+    assert_equal(game.get_state().get_player(player::contingency_planner).hand.contents[i].city_id(), to_discard_ids[i]);
   }
 }
 
 TEST(cure_requires_research_facility) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   // Suppose that the contingency planner has four of these cards.
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
   std::string to_discard[] {"Algeirs", "Baghdad", "Cairo", "Chennai", "Delhi"};
+  city::CityId to_discard_ids[5];
+  for (int i = 0; i < 5; i++) {
+    to_discard_ids[i] = game_state.cities->id_of(to_discard[i]);
+  }
   for (int i = 0; i < 5; i++) {
-    game_state.add_card(player::contingency_planner, card::Card(to_discard[i], card::player));
+    game_state.add_card(player::contingency_planner, card::Card(to_discard_ids[i], card::player));
   }
   Game game{game_state};
   
   bool exception_thrown = false;
   try {
-    game.cure(game.get_state().players[0].role, to_discard);
+    game.cure(game.get_state().players[0].role, to_discard_ids);
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "Curing a disease may only occur in a city with a research facility.");
@@ -797,26 +854,29 @@ TEST(cure_requires_research_facility) {
   // The player's hand shouldn't be different after a failure.
   assert_equal<int>(game.get_state().get_player(player::contingency_planner).hand.contents.size(), 5);
   for (int i = 0; i < 5; i++) {
-    assert_equal<std::string>(game.get_state().get_player(player::contingency_planner).hand.contents[i].name, to_discard[i]);
+    assert_equal(game.get_state().get_player(player::contingency_planner).hand.contents[i].city_id(), to_discard_ids[i]);
   }
 }
 
 TEST(cure) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(game_state.cities->id_of(CDC_LOCATION), true);
 
   // Suppose that the contingency planner has four of these cards.
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
   std::string to_discard[] {"Algeirs", "Baghdad", "Cairo", "Chennai", "Delhi"};
+  city::CityId to_discard_ids[5];
+  for (int i = 0; i < 5; i++) {
+    to_discard_ids[i] = game_state.cities->id_of(to_discard[i]);
+  }
   for (int i = 0; i < 5; i++) {
-    game_state.add_card(player::contingency_planner, card::Card(to_discard[i], card::player));
+    game_state.add_card(player::contingency_planner, card::Card(to_discard_ids[i], card::player));
   }
   Game game{game_state};
   
   // Cure the disease
-  game.cure(player::contingency_planner, to_discard);
+  game.cure(player::contingency_planner, to_discard_ids);
 
   // The player's hand should have discarded the cards.
   assert_equal<int>(game.get_state().get_player(player::contingency_planner).hand.contents.size(), 0);
@@ -825,21 +885,24 @@ TEST(cure) {
 
 TEST(cure_as_scientist_requires_four_cards_in_hand) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(game_state.cities->id_of(CDC_LOCATION), true);
 
   // Suppose that the contingency planner has four of these cards.
   game_state.players.push_back(player::Player(player::scientist));
-  game_state.player_locations[player::scientist] = CDC_LOCATION;
+  game_state.player_locations[player::scientist] = game_state.cities->id_of(CDC_LOCATION);
   std::string to_discard[] {"Algeirs", "Baghdad", "Cairo", "Chennai"};
+  city::CityId to_discard_ids[4];
+  for (int i = 0; i < 4; i++) {
+    to_discard_ids[i] = game_state.cities->id_of(to_discard[i]);
+  }
   for (int i = 0; i < 3; i++) {
-    game_state.add_card(player::scientist, card::Card(to_discard[i], card::player));
+    game_state.add_card(player::scientist, card::Card(to_discard_ids[i], card::player));
   }
   Game game{game_state};
   
   bool exception_thrown = false;
   try {
-    game.scientist_cure(to_discard);
+    game.scientist_cure(to_discard_ids);
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "This player doesn't have this card.");
@@ -849,27 +912,30 @@ TEST(cure_as_scientist_requires_four_cards_in_hand) {
   // The player's hand shouldn't be different after a failure.
   assert_equal<int>(game.get_state().get_player(player::scientist).hand.contents.size(), 3);
   for (int i = 0; i < 3; i++) {
-    assert_equal<std::string>(game.get_state().get_player(player::scientist).hand.contents[i].name, to_discard[i]);
+    assert_equal(game.get_state().get_player(player::scientist).hand.contents[i].city_id(), to_discard_ids[i]);
   }
 }
 
 TEST(cure_as_scientist_requires_four_cards_of_the_same_color) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(game_state.cities->id_of(CDC_LOCATION), true);
 
   // Suppose that the contingency planner has four of these cards.
   game_state.players.push_back(player::Player(player::scientist));
-  game_state.player_locations[player::scientist] = CDC_LOCATION;
+  game_state.player_locations[player::scientist] = game_state.cities->id_of(CDC_LOCATION);
   std::string to_discard[] {"Algeirs", "Baghdad", "Cairo", "Atlanta"};
+  city::CityId to_discard_ids[4];
+  for (int i = 0; i < 4; i++) {
+    to_discard_ids[i] = game_state.cities->id_of(to_discard[i]);
+  }
   for (int i = 0; i < 4; i++) {
-    game_state.add_card(player::scientist, card::Card(to_discard[i], card::player));
+    game_state.add_card(player::scientist, card::Card(to_discard_ids[i], card::player));
   }
   Game game{game_state};
   
   bool exception_thrown = false;
   try {
-    game.scientist_cure(to_discard);
+    game.scientist_cure(to_discard_ids);
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "Curing a disease requires that all discarded cards share a color.");
@@ -879,26 +945,29 @@ TEST(cure_as_scientist_requires_four_cards_of_the_same_color) {
   // The player's hand shouldn't be different after a failure.
   assert_equal<int>(game.get_state().get_player(player::scientist).hand.contents.size(), 4);
   for (int i = 0; i < 4; i++) {
-    assert_equal<std::string>(game.get_state().get_player(player::scientist).hand.contents[i].name, to_discard[i]);
+    assert_equal(game.get_state().get_player(player::scientist).hand.contents[i].city_id(), to_discard_ids[i]);
   }
 }
 
 TEST(cure_as_scientist_requires_research_facility) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   // Suppose that the contingency planner has four of these cards.
   game_state.players.push_back(player::Player(player::scientist));
-  game_state.player_locations[player::scientist] = CDC_LOCATION;
+  game_state.player_locations[player::scientist] = game_state.cities->id_of(CDC_LOCATION);
   std::string to_discard[] {"Algeirs", "Baghdad", "Cairo", "Chennai"};
+  city::CityId to_discard_ids[4];
+  for (int i = 0; i < 4; i++) {
+    to_discard_ids[i] = game_state.cities->id_of(to_discard[i]);
+  }
   for (int i = 0; i < 4; i++) {
-    game_state.add_card(player::scientist, card::Card(to_discard[i], card::player));
+    game_state.add_card(player::scientist, card::Card(to_discard_ids[i], card::player));
   }
   Game game{game_state};
   
   bool exception_thrown = false;
   try {
-    game.scientist_cure(to_discard);
+    game.scientist_cure(to_discard_ids);
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "Curing a disease may only occur in a city with a research facility.");
@@ -908,26 +977,29 @@ TEST(cure_as_scientist_requires_research_facility) {
   // The player's hand shouldn't be different after a failure.
   assert_equal<int>(game.get_state().get_player(player::scientist).hand.contents.size(), 4);
   for (int i = 0; i < 4; i++) {
-    assert_equal<std::string>(game.get_state().get_player(player::scientist).hand.contents[i].name, to_discard[i]);
+    assert_equal(game.get_state().get_player(player::scientist).hand.contents[i].city_id(), to_discard_ids[i]);
   }
 }
 
 TEST(cure_as_scientist) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(game_state.cities->id_of(CDC_LOCATION), true);
 
   // Suppose that the contingency planner has four of these cards.
   game_state.players.push_back(player::Player(player::scientist));
-  game_state.player_locations[player::scientist] = CDC_LOCATION;
+  game_state.player_locations[player::scientist] = game_state.cities->id_of(CDC_LOCATION);
   std::string to_discard[] {"Algeirs", "Baghdad", "Cairo", "Chennai"};
+  city::CityId to_discard_ids[4];
   for (int i = 0; i < 4; i++) {
-    game_state.add_card(player::scientist, card::Card(to_discard[i], card::player));
+    to_discard_ids[i] = game_state.cities->id_of(to_discard[i]);
+  }
+  for (int i = 0; i < 4; i++) {
+    game_state.add_card(player::scientist, card::Card(to_discard_ids[i], card::player));
   }
   Game game{game_state};
   
   // Cure the disease
-  game.scientist_cure(to_discard);
+  game.scientist_cure(to_discard_ids);
 
   // The scientist's hand should have discarded the cards.
   assert_equal<int>(game.get_state().get_player(player::scientist).hand.contents.size(), 0);
@@ -936,13 +1008,13 @@ TEST(cure_as_scientist) {
 TEST(reclaim_requires_event_type) {
   GameState game_state{};
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
-  game_state.player_deck.discard(card::Card(CDC_LOCATION, card::player));
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.player_deck.discard(card::Card(game_state.cities->id_of(CDC_LOCATION), card::player));
   Game game{game_state};
   
   bool exception_thrown = false;
   try {
-    game.reclaim(CDC_LOCATION);
+    game.reclaim(card::Card(game_state.cities->id_of(CDC_LOCATION), card::player));
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "City cards may not be reclaimed.");
@@ -952,12 +1024,12 @@ TEST(reclaim_requires_event_type) {
 TEST(reclaim_requires_card_in_discard) {
   GameState game_state{};
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
   Game game{game_state};
   
   bool exception_thrown = false;
   try {
-    game.reclaim(ONE_QUIET_NIGHT);
+    game.reclaim(card::Card(card::one_quiet_night));
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "The card One Quiet Night is not in the discard pile.");
@@ -967,46 +1039,46 @@ TEST(reclaim_requires_card_in_discard) {
 TEST(reclaim) {
   GameState game_state{};
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
-  game_state.player_deck.discard(card::Card(ONE_QUIET_NIGHT, card::player, card::one_quiet_night));
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.player_deck.discard(card::Card(card::one_quiet_night));
   Game game{game_state};
 
-  assert_false(card::contains(game.get_state().contingency_card, ONE_QUIET_NIGHT), "The event card should not be on the contingency planner card initially.");
+  assert_false(card::contains(game.get_state().contingency_card, card::Card(card::one_quiet_night)), "The event card should not be on the contingency planner card initially.");
   assert_equal<int>(game.get_state().player_deck.get_discard_contents().size(), 1);
 
 
-  game.reclaim(ONE_QUIET_NIGHT);
-  assert_true(card::contains(game.get_state().contingency_card, ONE_QUIET_NIGHT), "The event card should be on the contingency planner card after reclaiming it.");
+  game.reclaim(card::Card(card::one_quiet_night));
+  assert_true(card::contains(game.get_state().contingency_card, card::Card(card::one_quiet_night)), "The event card should be on the contingency planner card after reclaiming it.");
   assert_equal<int>(game.get_state().player_deck.get_discard_contents().size(), 0);
 }
 TEST(reclaim_limited_to_one) {
   GameState game_state{};
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
-  game_state.player_deck.discard(card::Card(ONE_QUIET_NIGHT, card::player, card::one_quiet_night));
-  game_state.player_deck.discard(card::Card(RESILIENT_POPULATION, card::player, card::resilient_population));
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.player_deck.discard(card::Card(card::one_quiet_night));
+  game_state.player_deck.discard(card::Card(card::resilient_population));
   Game game{game_state};
 
   assert_equal<int>(game.get_state().player_deck.get_discard_contents().size(), 2);
 
-  game.reclaim(ONE_QUIET_NIGHT);
-  assert_true(card::contains(game.get_state().contingency_card, ONE_QUIET_NIGHT), "The reclaimed event card should be on the contingency planner card after reclaiming it.");
-  assert_false(card::contains(game.get_state().contingency_card, RESILIENT_POPULATION), "The other event card should not be on the contingency planner card.");
+  game.reclaim(card::Card(card::one_quiet_night));
+  assert_true(card::contains(game.get_state().contingency_card, card::Card(card::one_quiet_night)), "The reclaimed event card should be on the contingency planner card after reclaiming it.");
+  assert_false(card::contains(game.get_state().contingency_card, card::Card(card::resilient_population)), "The other event card should not be on the contingency planner card.");
 
-  game.reclaim(RESILIENT_POPULATION);
-  assert_false(card::contains(game.get_state().contingency_card, ONE_QUIET_NIGHT), "The old event card should be evicted from the contingency planner card after reclaiming it.");
-  assert_true(card::contains(game.get_state().contingency_card, RESILIENT_POPULATION), "The newly reclaimed event card should be on the contingency planner card.");
+  game.reclaim(card::Card(card::resilient_population));
+  assert_false(card::contains(game.get_state().contingency_card, card::Card(card::one_quiet_night)), "The old event card should be evicted from the contingency planner card after reclaiming it.");
+  assert_true(card::contains(game.get_state().contingency_card, card::Card(card::resilient_population)), "The newly reclaimed event card should be on the contingency planner card.");
 
   assert_equal<int>(game.get_state().player_deck.get_discard_contents().size(), 0);
 }
 TEST(reclaim_requires_contingency_planner) {
   GameState game_state{};
-  game_state.player_deck.discard(card::Card(ONE_QUIET_NIGHT, card::player, card::one_quiet_night));
+  game_state.player_deck.discard(card::Card(card::one_quiet_night));
   Game game{game_state};
   
   bool exception_thrown = false;
   try {
-    game.reclaim(ONE_QUIET_NIGHT);
+    game.reclaim(card::Card(card::one_quiet_night));
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "Reclaim is not usable without a Contingency Planner.");
@@ -1016,15 +1088,14 @@ TEST(reclaim_requires_contingency_planner) {
 
 TEST(company_plane_requires_operations_expert) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(game_state.cities->id_of(CDC_LOCATION), true);
 
   Game game{game_state};
   
   bool exception_thrown = false;
   try {
-    game.company_plane("Istanbul", "Madrid");
+    game.company_plane(game_state.cities->id_of("Istanbul"), game_state.cities->id_of("Madrid"));
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "Company plane is not usable without an Operations Expert.");
@@ -1034,19 +1105,18 @@ TEST(company_plane_requires_operations_expert) {
 
 TEST(company_plane_requires_discarded_card) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(game_state.cities->id_of(CDC_LOCATION), true);
 
   game_state.players.push_back(player::Player(player::operations_expert));
-  game_state.player_locations[player::operations_expert] = CDC_LOCATION;
+  game_state.player_locations[player::operations_expert] = game_state.cities->id_of(CDC_LOCATION);
   Game game{game_state};
 
-  std::string to_discard = "Madrid";
+  city::CityId to_discard = game_state.cities->id_of("Madrid");
   
   bool exception_thrown = false;
   try {
-    game.company_plane("Istanbul", to_discard);
+    game.company_plane(game_state.cities->id_of("Istanbul"), to_discard);
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "This player does not have this card.");
@@ -1056,17 +1126,16 @@ TEST(company_plane_requires_discarded_card) {
 
 TEST(company_plane_requires_research_facility) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::operations_expert));
-  game_state.player_locations[player::operations_expert] = CDC_LOCATION;
-  std::string to_discard = "Madrid";
+  game_state.player_locations[player::operations_expert] = game_state.cities->id_of(CDC_LOCATION);
+  city::CityId to_discard = game_state.cities->id_of("Madrid");
   game_state.add_card(player::operations_expert, card::Card(to_discard, card::player));
   Game game{game_state};
   
   bool exception_thrown = false;
   try {
-    game.company_plane("Istanbul", to_discard);
+    game.company_plane(game_state.cities->id_of("Istanbul"), to_discard);
   } catch(std::invalid_argument e) {
     exception_thrown = true;
     assert_equal<std::string>(e.what(), "Company plane requires the Operations Expert to be in a city with a research facility.");
@@ -1076,40 +1145,38 @@ TEST(company_plane_requires_research_facility) {
 
 TEST(company_plane) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(game_state.cities->id_of(CDC_LOCATION), true);
 
   game_state.players.push_back(player::Player(player::operations_expert));
-  game_state.player_locations[player::operations_expert] = CDC_LOCATION;
-  std::string destination = "Istanbul", to_discard = "Madrid";
+  game_state.player_locations[player::operations_expert] = game_state.cities->id_of(CDC_LOCATION);
+  city::CityId destination = game_state.cities->id_of("Istanbul"), to_discard = game_state.cities->id_of("Madrid");
   game_state.add_card(player::operations_expert, card::Card(to_discard, card::player));
   Game game{game_state};
   
   // Take the company plane
   game.company_plane(destination, to_discard);
 
-  assert_false(card::contains(game.get_state().get_player(player::operations_expert).hand, to_discard), "The discarded card should be removed from the Operations Expert's hand.");
-  assert_equal(game.get_state().player_deck.get_discard_contents().back().name, to_discard);
+  assert_false(card::contains(game.get_state().get_player(player::operations_expert).hand, card::Card(to_discard, card::player)), "The discarded card should be removed from the Operations Expert's hand.");
+  assert_equal(game.get_state().player_deck.get_discard_contents().back().city_id(), to_discard);
   assert_equal(game.get_state().player_locations[player::operations_expert], destination);
 }
 
 TEST(epidemic) {
   GameState game_state{};
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
-  card::Card bottom_card = card::Card(CDC_LOCATION, card::infect);
+  card::Card bottom_card = card::Card(game_state.cities->id_of(CDC_LOCATION), card::infect);
   disease::DiseaseColor color = disease::blue;
   game_state.infection_deck.insert(bottom_card, 0);
-  game_state.infection_deck.insert(card::Card("Istanbul", card::infect), 0);
+  game_state.infection_deck.insert(card::Card(game_state.cities->id_of("Istanbul"), card::infect), 0);
 
-  game_state.infection_deck.discard(card::Card("Algeirs", card::infect));
-  game_state.infection_deck.discard(card::Card("Baghdad", card::infect));
-  game_state.infection_deck.discard(card::Card("Cairo", card::infect));
-  game_state.infection_deck.discard(card::Card("Chennai", card::infect));
-  std::vector<card::Card> infection_discard_before = game_state.infection_deck.get_discard_contents();
+  game_state.infection_deck.discard(card::Card(game_state.cities->id_of("Algeirs"), card::infect));
+  game_state.infection_deck.discard(card::Card(game_state.cities->id_of("Baghdad"), card::infect));
+  game_state.infection_deck.discard(card::Card(game_state.cities->id_of("Cairo"), card::infect));
+  game_state.infection_deck.discard(card::Card(game_state.cities->id_of("Chennai"), card::infect));
+  fixed::Vector<card::Card, DECK_CAPACITY> infection_discard_before = game_state.infection_deck.get_discard_contents();
   for (int i = 0; i < 4; i++) {
-    game_state.board[infection_discard_before[i].name].disease_count[disease::black] = 1;
+    game_state.board.set_cube_count(infection_discard_before[i].city_id(), disease::black, 1);
   }
   game_state.diseases[disease::black].reserve = DISEASE_RESERVE - 4;
   game_state.diseases[disease::blue].reserve = DISEASE_RESERVE;
@@ -1119,7 +1186,7 @@ TEST(epidemic) {
   GameState game_state_before = game.get_state();
 
 
-  assert_equal(game_state_before.board[CDC_LOCATION].disease_count[color], 0);
+  assert_equal(game_state_before.board.cube_count(game_state.cities->id_of(CDC_LOCATION), color), 0);
   assert_equal(game_state_before.infection_rate_level, 0);
 
 
@@ -1129,7 +1196,7 @@ TEST(epidemic) {
   assert_false(game.epidemic(), "The first epidemic of the game shouldn't result in a loss.");
 
   GameState game_state_after = game.get_state();
-  assert_equal(game_state_after.board[CDC_LOCATION].disease_count[color], 3);
+  assert_equal(game_state_after.board.cube_count(game_state.cities->id_of(CDC_LOCATION), color), 3);
   assert_equal(game_state_after.diseases[color].reserve, DISEASE_RESERVE - 3);
   assert_equal(game_state_after.infection_rate_level, 1);
 
@@ -1137,7 +1204,7 @@ TEST(epidemic) {
 
   struct CardCompare {
     bool operator() (const card::Card& lhs, const card::Card& rhs) const {
-      return lhs.name < rhs.name;
+      return lhs.id < rhs.id;
     }
   };
   std::set<card::Card, CardCompare> expected_top_five(infection_discard_before.begin(), infection_discard_before.end());
@@ -1149,42 +1216,47 @@ TEST(epidemic) {
     assert_false(cursor == expected_top_five.end(), "All of the top five infection cards should come from the discard.");
     expected_top_five.erase(cursor);
   }
+  assert_equal(game_state_after.infection_deck.layer_count(), 2);
+  assert_equal(game_state_after.infection_deck.layer_size(1), 5);
+  assert_equal(game_state_after.infection_deck.layer_of(5), 0);
+  assert_true(game_state_after.infection_deck.is_stacked(1), "The intensified layer is only shuffled once it is drawn from.");
 }
 
 TEST(get_player_choice_no_event_card) {
   GameState game_state{};
 
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
-  game_state.players.back().hand.contents.push_back(card::Card(CDC_LOCATION, card::player));
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.players.back().hand.contents.push_back(card::Card(game_state.cities->id_of(CDC_LOCATION), card::player));
 
   TurnState turn_state{player::contingency_planner, game_state.get_infection_rate()};
 
-  assert_equal<int>(get_player_choices(player::contingency_planner, game_state, turn_state).size(), 0);
+  MoveList choices;
+  get_player_choices(player::contingency_planner, game_state, turn_state, &choices);
+  assert_equal<int>(choices.size(), 0);
 }
 
 TEST(get_player_choice_one_quiet_night) {
   GameState game_state{};
 
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
   game_state.players.push_back(player::Player(player::dispatcher));
-  game_state.player_locations[player::dispatcher] = CDC_LOCATION;
-  game_state.add_card(player::dispatcher, card::Card(ONE_QUIET_NIGHT, card::player, card::one_quiet_night));
+  game_state.player_locations[player::dispatcher] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.add_card(player::dispatcher, card::Card(card::one_quiet_night));
 
   TurnState turn_state{player::contingency_planner, game_state.get_infection_rate()};
 
-  std::vector<PlayerChoice> choices = get_player_choices(player::dispatcher, game_state, turn_state);
+  MoveList choices;
+  get_player_choices(player::dispatcher, game_state, turn_state, &choices);
   assert_equal<int>(choices.size(), 1);
   std::string expected_propmpt = "Play ";
   expected_propmpt += ONE_QUIET_NIGHT;
   expected_propmpt += " to skip the next infect step.";
-  assert_equal<std::string>(choices[0].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[0], game_state), expected_propmpt);
 
   Game game{game_state};
-  assert_false(choices[0].effect(game, turn_state), "Playing an event card shouldn't win the game.");
+  game.apply(choices[0], turn_state);
   assert_equal<int>(game.get_state().get_player(player::dispatcher).hand.contents.size(), 0);
   assert_equal(turn_state.remaining_infection_card_draws, 0);
 }
@@ -1192,137 +1264,131 @@ TEST(get_player_choice_one_quiet_night) {
 TEST(get_player_choice_resilient_population) {
   GameState game_state{};
 
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
-  game_state.infection_deck.discard(card::Card(CDC_LOCATION, card::infect));
-  game_state.infection_deck.discard(card::Card("Istanbul", card::infect));
+  game_state.infection_deck.discard(card::Card(game_state.cities->id_of(CDC_LOCATION), card::infect));
+  game_state.infection_deck.discard(card::Card(game_state.cities->id_of("Istanbul"), card::infect));
 
   game_state.players.push_back(player::Player(player::operations_expert));
-  game_state.player_locations[player::operations_expert] = CDC_LOCATION;
-  game_state.players.back().hand.contents.push_back(card::Card(RESILIENT_POPULATION, card::player, card::resilient_population));
+  game_state.player_locations[player::operations_expert] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.players.back().hand.contents.push_back(card::Card(card::resilient_population));
 
   TurnState turn_state{player::medic, game_state.get_infection_rate()};
 
   // Confirm the correct prompts.
-  std::vector<PlayerChoice> choices = get_player_choices(player::operations_expert, game_state, turn_state);
+  MoveList choices;
+  get_player_choices(player::operations_expert, game_state, turn_state, &choices);
   assert_equal<int>(choices.size(), 2);
   std::string expected_propmpt = "Play ";
   expected_propmpt += RESILIENT_POPULATION;
   expected_propmpt += " to remove ";
   expected_propmpt += CDC_LOCATION;
   expected_propmpt += " from the infection discard.";
-  assert_equal<std::string>(choices[0].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[0], game_state), expected_propmpt);
 
   expected_propmpt = "Play ";
   expected_propmpt += RESILIENT_POPULATION;
   expected_propmpt += " to remove Istanbul from the infection discard.";
-  assert_equal<std::string>(choices[1].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[1], game_state), expected_propmpt);
 
   // Perform one of these choices and confirm that it affects the game correctly.
   Game game{game_state};
-  assert_false(choices[0].effect(game, turn_state), "Playing an event card shouldn't win the game.");
+  game.apply(choices[0], turn_state);
   assert_equal<int>(game.get_state().get_player(player::operations_expert).hand.contents.size(), 0);
   assert_equal<int>(game.get_state().infection_deck.get_discard_contents().size(), 1);
-  assert_equal<std::string>(game.get_state().infection_deck.get_discard_contents()[0].name, "Istanbul");
+  assert_equal(game.get_state().infection_deck.get_discard_contents()[0].city_id(), game_state.cities->id_of("Istanbul"));
 }
 
 TEST(get_player_choice_government_grant) {
-  GameState game_state{};
-
   // Don't populate the full board so we don't end up with a huge number of choices.
-  game_state.cities[CDC_LOCATION] = city::City(CDC_LOCATION, disease::blue, 4715000);
-  game_state.board[CDC_LOCATION] = city::CityState();
-  game_state.cities["Chicago"] = city::City("Chicago", disease::blue, 9121000);
-  game_state.board["Chicago"] = city::CityState();
-  game_state.cities["Miami"] = city::City("Miami", disease::yellow, 5582000);
-  game_state.board["Miami"] = city::CityState();
-  game_state.cities["San Francisco"] = city::City("San Francisco", disease::blue, 5864000);
-  game_state.board["San Francisco"] = city::CityState();
-  attach(&game_state.cities[CDC_LOCATION], &game_state.cities["Chicago"]);
-  attach(&game_state.cities[CDC_LOCATION], &game_state.cities["Miami"]);
-  attach(&game_state.cities["Chicago"], &game_state.cities["San Francisco"]);
+  city::Graph cities;
+  city::CityId atlanta = cities.add(city::City(CDC_LOCATION, disease::blue, 4715000)),
+    chicago = cities.add(city::City("Chicago", disease::blue, 9121000)),
+    miami = cities.add(city::City("Miami", disease::yellow, 5582000)),
+    san_francisco = cities.add(city::City("San Francisco", disease::blue, 5864000));
+  cities.attach(atlanta, chicago);
+  cities.attach(atlanta, miami);
+  cities.attach(chicago, san_francisco);
+  GameState game_state{cities};
 
   // Start with a research facility at the starting location.
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(atlanta, true);
 
   game_state.players.push_back(player::Player(player::quarantine_specialist));
-  game_state.player_locations[player::quarantine_specialist] = CDC_LOCATION;
-  game_state.add_card(player::quarantine_specialist, card::Card(GOVERNMENT_GRANT, card::player, card::government_grant));
+  game_state.player_locations[player::quarantine_specialist] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.add_card(player::quarantine_specialist, card::Card(card::government_grant));
 
   TurnState turn_state{player::medic, game_state.get_infection_rate()};
 
-  std::vector<PlayerChoice> choices = get_player_choices(player::quarantine_specialist, game_state, turn_state);
+  MoveList choices;
+  get_player_choices(player::quarantine_specialist, game_state, turn_state, &choices);
   assert_equal<int>(choices.size(), 3);
   std::string expected_propmpt = "Play ";
   expected_propmpt += GOVERNMENT_GRANT;
   expected_propmpt += " to place a research facility in Chicago.";
-  assert_equal<std::string>(choices[0].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[0], game_state), expected_propmpt);
 
   expected_propmpt = "Play ";
   expected_propmpt += GOVERNMENT_GRANT;
   expected_propmpt += " to place a research facility in Miami.";
-  assert_equal<std::string>(choices[1].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[1], game_state), expected_propmpt);
 
   expected_propmpt = "Play ";
   expected_propmpt += GOVERNMENT_GRANT;
   expected_propmpt += " to place a research facility in San Francisco.";
-  assert_equal<std::string>(choices[2].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[2], game_state), expected_propmpt);
 
   Game game{game_state};
-  assert_false(choices[0].effect(game, turn_state), "Playing an event card shouldn't win the game.");
+  game.apply(choices[0], turn_state);
   assert_equal<int>(game.get_state().get_player(player::quarantine_specialist).hand.contents.size(), 0);
-  assert_true(game.get_state().board["Chicago"].research_facility, "Chicago should gain a research facility from playing this card.");
+  assert_true(game.get_state().board.research_facility(chicago), "Chicago should gain a research facility from playing this card.");
 }
 
 TEST(get_player_choice_airlift) {
-  GameState game_state{};
-
   // Don't populate the full board so we don't end up with a huge number of choices.
-  game_state.cities[CDC_LOCATION] = city::City(CDC_LOCATION, disease::blue, 4715000);
-  game_state.board[CDC_LOCATION] = city::CityState();
-  game_state.cities["Chicago"] = city::City("Chicago", disease::blue, 9121000);
-  game_state.board["Chicago"] = city::CityState();
-  game_state.cities["Miami"] = city::City("Miami", disease::yellow, 5582000);
-  game_state.board["Miami"] = city::CityState();
-  game_state.cities["San Francisco"] = city::City("San Francisco", disease::blue, 5864000);
-  game_state.board["San Francisco"] = city::CityState();
-  attach(&game_state.cities[CDC_LOCATION], &game_state.cities["Chicago"]);
-  attach(&game_state.cities[CDC_LOCATION], &game_state.cities["Miami"]);
-  attach(&game_state.cities["Chicago"], &game_state.cities["San Francisco"]);
+  city::Graph cities;
+  city::CityId atlanta = cities.add(city::City(CDC_LOCATION, disease::blue, 4715000)),
+    chicago = cities.add(city::City("Chicago", disease::blue, 9121000)),
+    miami = cities.add(city::City("Miami", disease::yellow, 5582000)),
+    san_francisco = cities.add(city::City("San Francisco", disease::blue, 5864000));
+  cities.attach(atlanta, chicago);
+  cities.attach(atlanta, miami);
+  cities.attach(chicago, san_francisco);
+  GameState game_state{cities};
 
   // Start with a research facility at the starting location.
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(atlanta, true);
 
   game_state.players.push_back(player::Player(player::scientist));
-  game_state.player_locations[player::scientist] = CDC_LOCATION;
-  game_state.add_card(player::scientist, card::Card(AIRLIFT, card::player, card::airlift));
+  game_state.player_locations[player::scientist] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.add_card(player::scientist, card::Card(card::airlift));
   game_state.players.push_back(player::Player(player::researcher));
-  game_state.player_locations[player::researcher] = "San Francisco";
+  game_state.player_locations[player::researcher] = san_francisco;
 
   TurnState turn_state{player::medic, game_state.get_infection_rate()};
 
-  std::vector<PlayerChoice> choices = get_player_choices(player::scientist, game_state, turn_state);
+  MoveList choices;
+  get_player_choices(player::scientist, game_state, turn_state, &choices);
   assert_equal<int>(choices.size(), 6);
   std::string expected_propmpt = "Play ";
   expected_propmpt += AIRLIFT;
   expected_propmpt += " to move the ";
   expected_propmpt += SCIENTIST;
   expected_propmpt += " to Chicago.";
-  assert_equal<std::string>(choices[0].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[0], game_state), expected_propmpt);
 
   expected_propmpt = "Play ";
   expected_propmpt += AIRLIFT;
   expected_propmpt += " to move the ";
   expected_propmpt += SCIENTIST;
   expected_propmpt += " to Miami.";
-  assert_equal<std::string>(choices[1].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[1], game_state), expected_propmpt);
 
   expected_propmpt = "Play ";
   expected_propmpt += AIRLIFT;
   expected_propmpt += " to move the ";
   expected_propmpt += SCIENTIST;
   expected_propmpt += " to San Francisco.";
-  assert_equal<std::string>(choices[2].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[2], game_state), expected_propmpt);
 
   expected_propmpt = "Play ";
   expected_propmpt += AIRLIFT;
@@ -1331,47 +1397,48 @@ TEST(get_player_choice_airlift) {
   expected_propmpt += " to ";
   expected_propmpt += CDC_LOCATION;
   expected_propmpt += ".";
-  assert_equal<std::string>(choices[3].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[3], game_state), expected_propmpt);
 
   expected_propmpt = "Play ";
   expected_propmpt += AIRLIFT;
   expected_propmpt += " to move the ";
   expected_propmpt += RESEARCHER;
   expected_propmpt += " to Chicago.";
-  assert_equal<std::string>(choices[4].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[4], game_state), expected_propmpt);
 
   expected_propmpt = "Play ";
   expected_propmpt += AIRLIFT;
   expected_propmpt += " to move the ";
   expected_propmpt += RESEARCHER;
   expected_propmpt += " to Miami.";
-  assert_equal<std::string>(choices[5].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[5], game_state), expected_propmpt);
 
   Game game{game_state};
-  assert_false(choices[0].effect(game, turn_state), "Playing an event card shouldn't win the game.");
+  game.apply(choices[0], turn_state);
   assert_equal<int>(game.get_state().get_player(player::scientist).hand.contents.size(), 0);
-  assert_equal<std::string>(game.get_state().player_locations[player::scientist], "Chicago");
+  assert_equal(game.get_state().player_locations[player::scientist], chicago);
 }
 
 TEST(get_player_choice_cp_one_quiet_night) {
   GameState game_state{};
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
-  game_state.contingency_card.contents.push_back(card::Card(ONE_QUIET_NIGHT, card::player, card::one_quiet_night));
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.contingency_card.contents.push_back(card::Card(card::one_quiet_night));
 
   TurnState turn_state{player::medic, game_state.get_infection_rate()};
 
-  std::vector<PlayerChoice> choices = get_player_choices(player::contingency_planner, game_state, turn_state);
+  MoveList choices;
+  get_player_choices(player::contingency_planner, game_state, turn_state, &choices);
 
   assert_equal<int>(choices.size(), 1);
   std::string expected_prompt = "Use ";
   expected_prompt += ONE_QUIET_NIGHT;
   expected_prompt += " from your role card to skip the next infect step.";
-  assert_equal<std::string>(choices[0].prompt, expected_prompt);
+  assert_equal<std::string>(describe(choices[0], game_state), expected_prompt);
 
   Game game{game_state};
 
-  choices[0].effect(game, turn_state);
+  game.apply(choices[0], turn_state);
   assert_equal<int>(game.get_state().contingency_card.contents.size(), 0);
   assert_equal<int>(turn_state.remaining_infection_card_draws, 0);
 }
@@ -1379,137 +1446,131 @@ TEST(get_player_choice_cp_one_quiet_night) {
 TEST(get_player_choice_cp_resilient_population) {
   GameState game_state{};
 
-  gerryfudd::data::city::load_cities(&game_state.cities);
 
-  game_state.infection_deck.discard(card::Card(CDC_LOCATION, card::infect));
-  game_state.infection_deck.discard(card::Card("Istanbul", card::infect));
+  game_state.infection_deck.discard(card::Card(game_state.cities->id_of(CDC_LOCATION), card::infect));
+  game_state.infection_deck.discard(card::Card(game_state.cities->id_of("Istanbul"), card::infect));
 
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
-  game_state.contingency_card.contents.push_back(card::Card(RESILIENT_POPULATION, card::player, card::resilient_population));
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.contingency_card.contents.push_back(card::Card(card::resilient_population));
 
   TurnState turn_state{player::contingency_planner, game_state.get_infection_rate()};
 
   // Confirm the correct prompts.
-  std::vector<PlayerChoice> choices = get_player_choices(player::contingency_planner, game_state, turn_state);
+  MoveList choices;
+  get_player_choices(player::contingency_planner, game_state, turn_state, &choices);
   assert_equal<int>(choices.size(), 2);
   std::string expected_propmpt = "Use ";
   expected_propmpt += RESILIENT_POPULATION;
   expected_propmpt += " from your role card to remove ";
   expected_propmpt += CDC_LOCATION;
   expected_propmpt += " from the infection discard.";
-  assert_equal<std::string>(choices[0].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[0], game_state), expected_propmpt);
 
   expected_propmpt = "Use ";
   expected_propmpt += RESILIENT_POPULATION;
   expected_propmpt += " from your role card to remove Istanbul from the infection discard.";
-  assert_equal<std::string>(choices[1].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[1], game_state), expected_propmpt);
 
   // Perform one of these choices and confirm that it affects the game correctly.
   Game game{game_state};
-  assert_false(choices[0].effect(game, turn_state), "Playing an event card shouldn't win the game.");
+  game.apply(choices[0], turn_state);
   assert_equal<int>(game.get_state().contingency_card.contents.size(), 0);
   assert_equal<int>(game.get_state().infection_deck.get_discard_contents().size(), 1);
-  assert_equal<std::string>(game.get_state().infection_deck.get_discard_contents()[0].name, "Istanbul");
+  assert_equal(game.get_state().infection_deck.get_discard_contents()[0].city_id(), game_state.cities->id_of("Istanbul"));
 }
 
 TEST(get_player_choice_cp_government_grant) {
-  GameState game_state{};
-
   // Don't populate the full board so we don't end up with a huge number of choices.
-  game_state.cities[CDC_LOCATION] = city::City(CDC_LOCATION, disease::blue, 4715000);
-  game_state.board[CDC_LOCATION] = city::CityState();
-  game_state.cities["Chicago"] = city::City("Chicago", disease::blue, 9121000);
-  game_state.board["Chicago"] = city::CityState();
-  game_state.cities["Miami"] = city::City("Miami", disease::yellow, 5582000);
-  game_state.board["Miami"] = city::CityState();
-  game_state.cities["San Francisco"] = city::City("San Francisco", disease::blue, 5864000);
-  game_state.board["San Francisco"] = city::CityState();
-  attach(&game_state.cities[CDC_LOCATION], &game_state.cities["Chicago"]);
-  attach(&game_state.cities[CDC_LOCATION], &game_state.cities["Miami"]);
-  attach(&game_state.cities["Chicago"], &game_state.cities["San Francisco"]);
+  city::Graph cities;
+  city::CityId atlanta = cities.add(city::City(CDC_LOCATION, disease::blue, 4715000)),
+    chicago = cities.add(city::City("Chicago", disease::blue, 9121000)),
+    miami = cities.add(city::City("Miami", disease::yellow, 5582000)),
+    san_francisco = cities.add(city::City("San Francisco", disease::blue, 5864000));
+  cities.attach(atlanta, chicago);
+  cities.attach(atlanta, miami);
+  cities.attach(chicago, san_francisco);
+  GameState game_state{cities};
 
   // Start with a research facility at the starting location.
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(atlanta, true);
 
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
-  game_state.contingency_card.contents.push_back(card::Card(GOVERNMENT_GRANT, card::player, card::government_grant));
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.contingency_card.contents.push_back(card::Card(card::government_grant));
 
   TurnState turn_state{player::contingency_planner, game_state.get_infection_rate()};
 
-  std::vector<PlayerChoice> choices = get_player_choices(player::contingency_planner, game_state, turn_state);
+  MoveList choices;
+  get_player_choices(player::contingency_planner, game_state, turn_state, &choices);
   assert_equal<int>(choices.size(), 3);
   std::string expected_propmpt = "Use ";
   expected_propmpt += GOVERNMENT_GRANT;
   expected_propmpt += " from your role card to place a research facility in Chicago.";
-  assert_equal<std::string>(choices[0].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[0], game_state), expected_propmpt);
 
   expected_propmpt = "Use ";
   expected_propmpt += GOVERNMENT_GRANT;
   expected_propmpt += " from your role card to place a research facility in Miami.";
-  assert_equal<std::string>(choices[1].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[1], game_state), expected_propmpt);
 
   expected_propmpt = "Use ";
   expected_propmpt += GOVERNMENT_GRANT;
   expected_propmpt += " from your role card to place a research facility in San Francisco.";
-  assert_equal<std::string>(choices[2].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[2], game_state), expected_propmpt);
 
   Game game{game_state};
-  assert_false(choices[0].effect(game, turn_state), "Playing an event card shouldn't win the game.");
+  game.apply(choices[0], turn_state);
   assert_equal<int>(game.get_state().contingency_card.contents.size(), 0);
-  assert_true(game.get_state().board["Chicago"].research_facility, "Chicago should gain a research facility from playing this card.");
+  assert_true(game.get_state().board.research_facility(chicago), "Chicago should gain a research facility from playing this card.");
 }
 
 TEST(get_player_choice_cp_airlift) {
-  GameState game_state{};
-
   // Don't populate the full board so we don't end up with a huge number of choices.
-  game_state.cities[CDC_LOCATION] = city::City(CDC_LOCATION, disease::blue, 4715000);
-  game_state.board[CDC_LOCATION] = city::CityState();
-  game_state.cities["Chicago"] = city::City("Chicago", disease::blue, 9121000);
-  game_state.board["Chicago"] = city::CityState();
-  game_state.cities["Miami"] = city::City("Miami", disease::yellow, 5582000);
-  game_state.board["Miami"] = city::CityState();
-  game_state.cities["San Francisco"] = city::City("San Francisco", disease::blue, 5864000);
-  game_state.board["San Francisco"] = city::CityState();
-  attach(&game_state.cities[CDC_LOCATION], &game_state.cities["Chicago"]);
-  attach(&game_state.cities[CDC_LOCATION], &game_state.cities["Miami"]);
-  attach(&game_state.cities["Chicago"], &game_state.cities["San Francisco"]);
+  city::Graph cities;
+  city::CityId atlanta = cities.add(city::City(CDC_LOCATION, disease::blue, 4715000)),
+    chicago = cities.add(city::City("Chicago", disease::blue, 9121000)),
+    miami = cities.add(city::City("Miami", disease::yellow, 5582000)),
+    san_francisco = cities.add(city::City("San Francisco", disease::blue, 5864000));
+  cities.attach(atlanta, chicago);
+  cities.attach(atlanta, miami);
+  cities.attach(chicago, san_francisco);
+  GameState game_state{cities};
 
   // Start with a research facility at the starting location.
-  game_state.board[CDC_LOCATION].research_facility = true;
+  game_state.board.set_research_facility(atlanta, true);
 
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
-  game_state.contingency_card.contents.push_back(card::Card(AIRLIFT, card::player, card::airlift));
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+  game_state.contingency_card.contents.push_back(card::Card(card::airlift));
   game_state.players.push_back(player::Player(player::researcher));
-  game_state.player_locations[player::researcher] = "San Francisco";
+  game_state.player_locations[player::researcher] = san_francisco;
 
   TurnState turn_state{player::researcher, game_state.get_infection_rate()};
 
-  std::vector<PlayerChoice> choices = get_player_choices(player::contingency_planner, game_state, turn_state);
+  MoveList choices;
+  get_player_choices(player::contingency_planner, game_state, turn_state, &choices);
   assert_equal<int>(choices.size(), 6);
   std::string expected_propmpt = "Use ";
   expected_propmpt += AIRLIFT;
   expected_propmpt += " from your role card to move the ";
   expected_propmpt += CONTINGENCY_PLANNER;
   expected_propmpt += " to Chicago.";
-  assert_equal<std::string>(choices[0].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[0], game_state), expected_propmpt);
 
   expected_propmpt = "Use ";
   expected_propmpt += AIRLIFT;
   expected_propmpt += " from your role card to move the ";
   expected_propmpt += CONTINGENCY_PLANNER;
   expected_propmpt += " to Miami.";
-  assert_equal<std::string>(choices[1].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[1], game_state), expected_propmpt);
 
   expected_propmpt = "Use ";
   expected_propmpt += AIRLIFT;
   expected_propmpt += " from your role card to move the ";
   expected_propmpt += CONTINGENCY_PLANNER;
   expected_propmpt += " to San Francisco.";
-  assert_equal<std::string>(choices[2].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[2], game_state), expected_propmpt);
 
   expected_propmpt = "Use ";
   expected_propmpt += AIRLIFT;
@@ -1518,52 +1579,668 @@ TEST(get_player_choice_cp_airlift) {
   expected_propmpt += " to ";
   expected_propmpt += CDC_LOCATION;
   expected_propmpt += ".";
-  assert_equal<std::string>(choices[3].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[3], game_state), expected_propmpt);
 
   expected_propmpt = "Use ";
   expected_propmpt += AIRLIFT;
   expected_propmpt += " from your role card to move the ";
   expected_propmpt += RESEARCHER;
   expected_propmpt += " to Chicago.";
-  assert_equal<std::string>(choices[4].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[4], game_state), expected_propmpt);
 
   expected_propmpt = "Use ";
   expected_propmpt += AIRLIFT;
   expected_propmpt += " from your role card to move the ";
   expected_propmpt += RESEARCHER;
   expected_propmpt += " to Miami.";
-  assert_equal<std::string>(choices[5].prompt, expected_propmpt);
+  assert_equal<std::string>(describe(choices[5], game_state), expected_propmpt);
 
   Game game{game_state};
-  assert_false(choices[0].effect(game, turn_state), "Playing an event card shouldn't win the game.");
+  game.apply(choices[0], turn_state);
   assert_equal<int>(game.get_state().contingency_card.contents.size(), 0);
-  assert_equal<std::string>(game.get_state().player_locations[player::contingency_planner], "Chicago");
+  assert_equal(game.get_state().player_locations[player::contingency_planner], chicago);
 }
 
 TEST(get_player_actions) {
   GameState game_state{};
 
-  gerryfudd::data::city::load_cities(&game_state.cities);
+  game_state.players.push_back(player::Player(player::contingency_planner));
+  game_state.player_locations[player::contingency_planner] = game_state.cities->id_of(CDC_LOCATION);
+
+  TurnState turn_state{player::contingency_planner, game_state.get_infection_rate()};
+  turn_state.event_cards_played = true;
+
+  MoveList choices;
+  get_player_choices(player::contingency_planner, game_state, turn_state, &choices);
+  
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+  assert_equal<int>(choices.size(), game_state.cities->neighbors(cdc_location).size());
+  assert_equal<std::string>(describe(choices[0], game_state), "Drive to Chicago.");
+  assert_equal<std::string>(describe(choices[1], game_state), "Drive to Miami.");
+  assert_equal<std::string>(describe(choices[2], game_state), "Drive to Washington.");
+
+  Game game{game_state};
+
+  game.apply(choices[0], turn_state);
+  assert_equal(game.get_state().player_locations[player::contingency_planner], game_state.cities->id_of("Chicago"));
+}
+
+TEST(eradicated) {
+  GameState game_state{};
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+
+  game_state.board.set_cube_count(cdc_location, disease::blue, 1);
+  assert_false(game_state.eradicated(disease::blue), "An uncured disease is not eradicated.");
+
+  game_state.diseases[disease::blue].cured = true;
+  assert_false(game_state.eradicated(disease::blue), "A cured disease with cubes on the board is not eradicated.");
+
+  game_state.board.set_cube_count(cdc_location, disease::blue, 0);
+  assert_true(game_state.eradicated(disease::blue), "A cured disease with no cubes on the board is eradicated.");
+}
+
+TEST(epidemic_outbreaks_city_with_cubes) {
+  GameState game_state{};
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+
+  game_state.infection_deck.insert(card::Card(cdc_location, card::infect), 0);
+  game_state.board.set_cube_count(cdc_location, disease::blue, 2);
+  game_state.diseases[disease::blue].reserve = DISEASE_RESERVE - 2;
+
+  Game game{game_state};
+  assert_false(game.epidemic(), "A single outbreak shouldn't lose the game.");
 
-  for (std::map<std::string, city::City>::iterator cursor = game_state.cities.begin(); cursor != game_state.cities.end(); cursor++) {
-    game_state.board[cursor->first] = city::CityState{};
+  int neighbor_count = game_state.cities->neighbors(cdc_location).size();
+  assert_equal(game.get_state().board.cube_count(cdc_location, disease::blue), 3);
+  assert_equal(game.get_state().outbreaks, 1);
+  for (city::CityId neighbor : game_state.cities->neighbors(cdc_location)) {
+    assert_equal(game.get_state().board.cube_count(neighbor, disease::blue), 1);
   }
+  assert_equal(game.get_state().diseases[disease::blue].reserve, DISEASE_RESERVE - 3 - neighbor_count);
+}
+
+TEST(draw_player_card) {
+  GameState game_state{};
+  game_state.players.push_back(player::Player(player::medic));
+  game_state.player_deck.insert(card::Card(game_state.cities->id_of(CDC_LOCATION), card::player), 0);
+  Game game{game_state};
+
+  assert_false(game.draw_player_card(player::medic), "Drawing from a non-empty player deck should not end the game.");
+  assert_equal(game.get_state().get_player(player::medic).hand.contents.size(), 1);
+  assert_equal(game.get_state().get_player(player::medic).hand.contents[0].city_id(), game_state.cities->id_of(CDC_LOCATION));
+  assert_equal(game.get_state().player_deck.remaining(), 0);
+
+  assert_true(game.draw_player_card(player::medic), "Drawing from an empty player deck should end the game.");
+}
+
+TEST(get_state_does_not_copy) {
+  Game game{initialize_state(easy, 2, 99)};
+
+  assert_true(&game.get_state() == &game.get_state(), "The game should expose its state without copying it.");
+  GameStateView view{game.get_state()};
+  assert_true(&*view == &game.get_state(), "A view should refer to the game's own state.");
+  assert_equal(view->players.size(), game.get_state().players.size());
+}
+
+int count_moves(const MoveList &moves, player::ActionType action) {
+  int result = 0;
+  for (const Move &move : moves) {
+    if (move.type == take_action && move.action == action) {
+      result++;
+    }
+  }
+  return result;
+}
+
+TEST(get_player_actions_with_cards) {
+  GameState game_state{};
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+  city::CityId paris = game_state.cities->id_of("Paris");
 
   game_state.players.push_back(player::Player(player::contingency_planner));
-  game_state.player_locations[player::contingency_planner] = CDC_LOCATION;
+  game_state.player_locations[player::contingency_planner] = cdc_location;
+  game_state.add_card(player::contingency_planner, card::Card(paris, card::player));
+  game_state.add_card(player::contingency_planner, card::Card(cdc_location, card::player));
+  game_state.board.set_cube_count(cdc_location, disease::blue, 2);
 
   TurnState turn_state{player::contingency_planner, game_state.get_infection_rate()};
   turn_state.event_cards_played = true;
 
-  std::vector<PlayerChoice> choices = get_player_choices(player::contingency_planner, game_state, turn_state);
-  
-  assert_equal<int>(choices.size(), game_state.cities[CDC_LOCATION].neighbors.size());
-  assert_equal<std::string>(choices[0].prompt, "Drive to Chicago.");
-  assert_equal<std::string>(choices[1].prompt, "Drive to Miami.");
-  assert_equal<std::string>(choices[2].prompt, "Drive to Washington.");
+  MoveList choices;
+  get_player_choices(player::contingency_planner, game_state, turn_state, &choices);
+
+  assert_equal<int>(count_moves(choices, player::drive), 3);
+  assert_equal(count_moves(choices, player::direct_flight), 1);
+  assert_equal(count_moves(choices, player::charter_flight), game_state.cities->size() - 1);
+  assert_equal(count_moves(choices, player::shuttle), 0);
+  assert_equal(count_moves(choices, player::build), 1);
+  assert_equal(count_moves(choices, player::treat), 1);
+  assert_equal(count_moves(choices, player::cure), 0);
 
   Game game{game_state};
+  for (const Move &move : choices) {
+    if (move.action == player::build) {
+      assert_equal<std::string>(describe(move, game_state), "Build a research station in Atlanta.");
+      game.apply(move, turn_state);
+    }
+  }
+  assert_true(game.get_state().board.research_facility(cdc_location), "Building should place a research facility.");
+  assert_equal<int>(game.get_state().get_player(player::contingency_planner).hand.contents.size(), 1);
+  assert_equal(turn_state.remaining_actions, 3);
+}
+
+TEST(get_player_actions_share_and_cure) {
+  GameState game_state{};
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+  game_state.board.set_research_facility(cdc_location, true);
+
+  game_state.players.push_back(player::Player(player::scientist));
+  game_state.players.push_back(player::Player(player::researcher));
+  game_state.player_locations[player::scientist] = cdc_location;
+  game_state.player_locations[player::researcher] = cdc_location;
+  std::string blue_cities[] {"Chicago", "Essen", "London", "Madrid"};
+  for (std::string name : blue_cities) {
+    game_state.add_card(player::scientist, card::Card(game_state.cities->id_of(name), card::player));
+  }
+  game_state.add_card(player::researcher, card::Card(game_state.cities->id_of("Paris"), card::player));
+
+  TurnState turn_state{player::scientist, game_state.get_infection_rate()};
+  turn_state.event_cards_played = true;
+
+  MoveList choices;
+  get_player_choices(player::scientist, game_state, turn_state, &choices);
+
+  // The scientist may only take from the researcher, who may hand over any city card.
+  assert_equal(count_moves(choices, player::share), 1);
+  assert_equal(count_moves(choices, player::cure), 1);
+
+  Game game{game_state};
+  for (const Move &move : choices) {
+    if (move.action == player::share) {
+      assert_equal<std::string>(describe(move, game_state), "Take Paris from the Researcher.");
+      game.apply(move, turn_state);
+    }
+  }
+  assert_equal<int>(game.get_state().get_player(player::scientist).hand.contents.size(), 5);
+  for (const Move &move : choices) {
+    if (move.action == player::cure) {
+      assert_equal<std::string>(describe(move, game_state), "Discover a cure for blue disease.");
+      game.apply(move, turn_state);
+    }
+  }
+  assert_true(game.get_state().diseases[disease::blue].cured, "The disease should be cured.");
+  assert_equal(turn_state.remaining_actions, 2);
+}
+
+TEST(get_player_actions_cure_every_discard) {
+  GameState game_state{};
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+  game_state.board.set_research_facility(cdc_location, true);
+
+  game_state.players.push_back(player::Player(player::medic));
+  game_state.player_locations[player::medic] = cdc_location;
+  std::string blue_cities[] {"Chicago", "Essen", "London", "Madrid", "Paris", "Milan", "Washington"};
+  for (std::string name : blue_cities) {
+    game_state.add_card(player::medic, card::Card(game_state.cities->id_of(name), card::player));
+  }
+
+  TurnState turn_state{player::medic, game_state.get_infection_rate()};
+  turn_state.event_cards_played = true;
+  MoveList choices;
+  get_player_choices(player::medic, game_state, turn_state, &choices);
+
+  // Any five of the seven cards may be discarded.
+  assert_equal(count_moves(choices, player::cure), 21);
+  for (int i = 0; i < choices.size(); i++) {
+    for (int j = i + 1; j < choices.size(); j++) {
+      assert_false(choices[i] == choices[j], "Each discard should be offered once.");
+    }
+  }
+}
+
+TEST(get_player_actions_company_plane_once_per_turn) {
+  GameState game_state{};
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+  city::CityId destination = game_state.cities->id_of("Istanbul");
+  game_state.board.set_research_facility(cdc_location, true);
+  game_state.board.set_research_facility(destination, true);
+
+  game_state.players.push_back(player::Player(player::operations_expert));
+  game_state.player_locations[player::operations_expert] = cdc_location;
+  game_state.add_card(player::operations_expert, card::Card(game_state.cities->id_of("Madrid"), card::player));
+  game_state.add_card(player::operations_expert, card::Card(game_state.cities->id_of("Paris"), card::player));
+
+  TurnState turn_state{player::operations_expert, game_state.get_infection_rate()};
+  turn_state.event_cards_played = true;
+  MoveList choices;
+  get_player_choices(player::operations_expert, game_state, turn_state, &choices);
+  assert_true(count_moves(choices, player::company_plane) > 0, "The company plane should be offered from a research facility.");
+
+  Game game{game_state};
+  for (const Move &move : choices) {
+    if (move.action == player::company_plane && move.target_city == destination) {
+      game.apply(move, turn_state);
+      break;
+    }
+  }
+  assert_equal(game.get_state().player_locations[player::operations_expert], destination);
+  get_player_choices(player::operations_expert, game.get_state(), turn_state, &choices);
+  assert_equal(count_moves(choices, player::company_plane), 0);
+}
+
+TEST(get_player_actions_dispatcher) {
+  GameState game_state{};
+  city::CityId cdc_location = game_state.cities->id_of(CDC_LOCATION);
+  city::CityId paris = game_state.cities->id_of("Paris");
+
+  game_state.players.push_back(player::Player(player::dispatcher));
+  game_state.players.push_back(player::Player(player::medic));
+  game_state.player_locations[player::dispatcher] = cdc_location;
+  game_state.player_locations[player::medic] = paris;
+
+  TurnState turn_state{player::dispatcher, game_state.get_infection_rate()};
+  turn_state.event_cards_played = true;
+
+  MoveList choices;
+  get_player_choices(player::dispatcher, game_state, turn_state, &choices);
+
+  int drives = game_state.cities->neighbors(cdc_location).size() + game_state.cities->neighbors(paris).size();
+  assert_equal(count_moves(choices, player::drive), drives);
+  assert_equal(count_moves(choices, player::conference), 2);
+
+  Game game{game_state};
+  for (const Move &move : choices) {
+    if (move.action == player::conference && move.target_role == player::medic) {
+      assert_equal<std::string>(describe(move, game_state), "Move the Medic to Atlanta.");
+      game.apply(move, turn_state);
+    }
+  }
+  assert_equal(game.get_state().player_locations[player::medic], cdc_location);
+}
+
+TEST(get_player_actions_none_remaining) {
+  GameState game_state{};
+  game_state.players.push_back(player::Player(player::medic));
+  game_state.player_locations[player::medic] = game_state.cities->id_of(CDC_LOCATION);
+
+  TurnState turn_state{player::medic, game_state.get_infection_rate()};
+  turn_state.event_cards_played = true;
+  turn_state.remaining_actions = 0;
+
+  MoveList choices;
+  get_player_choices(player::medic, game_state, turn_state, &choices);
+
+  assert_equal(choices.size(), 0);
+}
+
+TEST(outbreak_chain) {
+  GameState game_state{};
+  city::CityId atlanta = game_state.cities->id_of(CDC_LOCATION);
+  city::CityId chicago = game_state.cities->id_of("Chicago");
+  game_state.board.set_cube_count(atlanta, disease::blue, 3);
+  game_state.board.set_cube_count(chicago, disease::blue, 3);
+  game_state.diseases[disease::blue].reserve = DISEASE_RESERVE - 6;
+  game_state.infection_deck.insert(card::Card(atlanta, card::infect), 0);
+  Game game{game_state};
+
+  assert_false(game.draw_infection_card(), "Two outbreaks should not end the game.");
+
+  const GameState &after = game.get_state();
+  assert_equal(after.outbreaks, 2);
+  assert_equal(after.board.cube_count(atlanta, disease::blue), 3);
+  assert_equal(after.board.cube_count(chicago, disease::blue), 3);
+  int placed = 0;
+  city::CitySet reached;
+  for (city::CityId id : {atlanta, chicago}) {
+    for (city::CityId neighbor : after.cities->neighbors(id)) {
+      if (neighbor != atlanta && neighbor != chicago && !reached.contains(neighbor)) {
+        reached.insert(neighbor);
+        assert_equal(after.board.cube_count(neighbor, disease::blue), 1);
+        placed++;
+      }
+    }
+  }
+  assert_equal(after.diseases[disease::blue].reserve, DISEASE_RESERVE - 6 - placed);
+}
+
+TEST(outbreak_limit_ends_game) {
+  GameState game_state{};
+  city::CityId atlanta = game_state.cities->id_of(CDC_LOCATION);
+  game_state.board.set_cube_count(atlanta, disease::blue, 3);
+  game_state.outbreaks = OUTBREAK_LIMIT - 1;
+  game_state.infection_deck.insert(card::Card(atlanta, card::infect), 0);
+  Game game{game_state};
+
+  assert_true(game.draw_infection_card(), "Reaching the outbreak limit should end the game.");
+  assert_equal(game.get_state().outbreaks, OUTBREAK_LIMIT);
+}
+
+TEST(outbreak_exhausting_reserve_ends_game) {
+  GameState game_state{};
+  city::CityId atlanta = game_state.cities->id_of(CDC_LOCATION);
+  game_state.board.set_cube_count(atlanta, disease::blue, 3);
+  game_state.diseases[disease::blue].reserve = 1;
+  game_state.infection_deck.insert(card::Card(atlanta, card::infect), 0);
+  Game game{game_state};
+
+  assert_true(game.draw_infection_card(), "Running out of cubes during an outbreak should end the game.");
+  assert_equal(game.get_state().diseases[disease::blue].reserve, 0);
+  assert_equal(game.get_state().outbreaks, 1);
+}
+
+// The recursive walk that place_disease replaced, as a reference for the order
+// of its checks.
+bool place_recursively(GameState &state, city::CityId id, disease::DiseaseColor color, std::vector<city::CityId> &executed) {
+  if (state.prevent_placement(id, color)) {
+    return false;
+  }
+  if (state.diseases[color].reserve <= 0) {
+    return true;
+  }
+  if (state.board.cube_count(id, color) >= MAX_CUBES_PER_CITY) {
+    if (std::find(executed.begin(), executed.end(), id) != executed.end()) {
+      return false;
+    }
+    if (++state.outbreaks >= OUTBREAK_LIMIT) {
+      return true;
+    }
+    executed.push_back(id);
+    for (city::CityId neighbor : state.cities->neighbors(id)) {
+      if (place_recursively(state, neighbor, color, executed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  state.diseases[color].reserve--;
+  state.board.set_cube_count(id, color, state.board.cube_count(id, color) + 1);
+  return false;
+}
+
+TEST(outbreak_chain_exhausting_reserve_matches_recursion) {
+  for (int reserve = 0; reserve <= 8; reserve++) {
+    GameState game_state{};
+    for (std::string name : {CDC_LOCATION, "Chicago", "Washington", "New York", "Montréal"}) {
+      game_state.board.set_cube_count(game_state.cities->id_of(name), disease::blue, 3);
+    }
+    game_state.diseases[disease::blue].reserve = reserve;
+    city::CityId atlanta = game_state.cities->id_of(CDC_LOCATION);
+    game_state.infection_deck.insert(card::Card(atlanta, card::infect), 0);
+
+    GameState expected = game_state;
+    std::vector<city::CityId> executed;
+    bool expected_loss = place_recursively(expected, atlanta, disease::blue, executed);
+
+    Game game{game_state};
+    assert_true(game.draw_infection_card() == expected_loss, "The loss should match the recursive walk.");
+    const GameState &after = game.get_state();
+    assert_equal(after.outbreaks, expected.outbreaks);
+    assert_equal(after.diseases[disease::blue].reserve, expected.diseases[disease::blue].reserve);
+    for (city::CityId id = 0; id < after.cities->size(); id++) {
+      assert_equal(after.board.cube_count(id, disease::blue), expected.board.cube_count(id, disease::blue));
+    }
+  }
+}
+
+TEST(standard_graph_distances) {
+  GameState game_state{};
+  const city::Graph &cities = *game_state.cities;
+
+  for (city::CityId a = 0; a < cities.size(); a++) {
+    for (city::CityId b = 0; b < cities.size(); b++) {
+      assert_equal(cities.distance(a, b), cities.distance(b, a));
+      assert_true(cities.distance(a, b) < NO_PATH, "The standard board should be connected.");
+    }
+    for (city::CityId neighbor : cities.neighbors(a)) {
+      assert_equal(cities.distance(a, neighbor), 1);
+    }
+  }
+  assert_equal(cities.distance(cities.id_of(CDC_LOCATION), cities.id_of("New York")), 2);
+}
+
+TEST(research_facility_distances) {
+  GameState game_state = initialize_state(easy, 2, 1);
+  const city::Graph &cities = *game_state.cities;
+  city::CityId cdc_location = cities.id_of(CDC_LOCATION);
+  city::CityId paris = cities.id_of("Paris");
+  Game game{game_state};
+
+  assert_equal(game.get_state().distance_to_research_facility(cdc_location), 0);
+  assert_equal(game.get_state().distance_to_research_facility(cities.id_of("Chicago")), 1);
+  int before = game.get_state().distance_to_research_facility(cities.id_of("Essen"));
+
+  game.place_research_facility(paris);
+  assert_equal(game.get_state().distance_to_research_facility(paris), 0);
+  assert_equal(game.get_state().distance_to_research_facility(cities.id_of("Essen")), 1);
+  assert_true(before > 1, "Essen should have been farther from a research facility before Paris had one.");
+
+  game.place_research_facility(cities.id_of("Tokyo"), paris);
+  assert_equal(game.get_state().distance_to_research_facility(paris), cities.distance(paris, cdc_location));
+  for (city::CityId id = 0; id < cities.size(); id++) {
+    int expected = std::min(cities.distance(id, cdc_location), cities.distance(id, cities.id_of("Tokyo")));
+    assert_equal(game.get_state().distance_to_research_facility(id), expected);
+  }
+}
+
+TEST(hash_tracks_random_play) {
+  Game game{initialize_state(medium, 4, 7)};
+  const GameState &state = game.get_state();
+  random::Generator generator{11};
+  MoveList moves;
+  std::set<uint64_t> seen{state.hash()};
+  bool lost = false;
+  for (int turn = 0; turn < 20 && !lost; turn++) {
+    player::Role role = state.players[turn % state.players.size()].role;
+    TurnState turn_state{role, state.get_infection_rate()};
+    turn_state.event_cards_played = true;
+    for (get_player_choices(role, state, turn_state, &moves); !moves.empty(); get_player_choices(role, state, turn_state, &moves)) {
+      game.apply(moves[generator.below(moves.size())], turn_state);
+      assert_equal(state.hash(), state.compute_hash());
+      seen.insert(state.hash());
+    }
+    for (int draw = 0; draw < 2 && !lost; draw++) {
+      lost = game.draw_player_card(role);
+      if (!lost && state.get_player(role).hand.contents.back().type() == card::epidemic) {
+        game.remove_player_card(role, state.get_player(role).hand.contents.back());
+        lost = game.epidemic();
+      }
+      assert_equal(state.hash(), state.compute_hash());
+    }
+    while (state.get_player(role).hand.contents.size() > HAND_LIMIT) {
+      game.discard(game.remove_player_card(role, state.get_player(role).hand.contents[0]));
+    }
+    for (int draw = 0; draw < state.get_infection_rate() && !lost; draw++) {
+      lost = game.draw_infection_card();
+      assert_equal(state.hash(), state.compute_hash());
+      seen.insert(state.hash());
+    }
+  }
+  assert_true(seen.size() > 20, "Play should reach many distinct hashes.");
+}
+
+TEST(hash_is_restored_by_reversing_a_move) {
+  Game game{initialize_state(easy, 2, 3)};
+  const GameState &state = game.get_state();
+  player::Role role = state.players[0].role;
+  city::CityId start = state.player_locations[role];
+  city::CityId neighbor = state.cities->neighbors(start)[0];
+  uint64_t initial = state.hash();
+
+  game.drive(role, neighbor);
+  assert_false(state.hash() == initial, "Moving a pawn should change the hash.");
+  game.drive(role, start);
+  assert_equal(state.hash(), initial);
+
+  game.place_research_facility(neighbor);
+  assert_false(state.hash() == initial, "Building a research facility should change the hash.");
+  assert_equal(state.hash(), state.compute_hash());
+}
+
+void assert_same_deck(const card::Deck &expected, const card::Deck &actual) {
+  assert_equal(actual.remaining(), expected.remaining());
+  for (int i = 0; i < expected.remaining(); i++) {
+    assert_true(actual.reveal(i) == expected.reveal(i), "The undrawn cards should be in the same order.");
+  }
+  assert_equal(actual.layer_count(), expected.layer_count());
+  for (int i = 0; i < expected.layer_count(); i++) {
+    assert_equal(actual.layer_size(i), expected.layer_size(i));
+    assert_true(actual.is_stacked(i) == expected.is_stacked(i), "The layers should be shuffled or stacked alike.");
+  }
+  assert_equal(actual.get_discard_contents().size(), expected.get_discard_contents().size());
+  for (int i = 0; i < expected.get_discard_contents().size(); i++) {
+    assert_true(actual.get_discard_contents()[i] == expected.get_discard_contents()[i], "The discards should be in the same order.");
+  }
+}
+
+void assert_same_state(const GameState &expected, const GameState &actual) {
+  assert_equal(actual.hash(), expected.hash());
+  assert_equal(actual.hash(), actual.compute_hash());
+  for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+    assert_equal(actual.diseases[color].reserve, expected.diseases[color].reserve);
+    assert_true(actual.diseases[color].cured == expected.diseases[color].cured, "Cures should match.");
+    assert_true(actual.protected_cities[color] == expected.protected_cities[color], "Protected cities should match.");
+    assert_true(actual.board.infected((disease::DiseaseColor) color) == expected.board.infected((disease::DiseaseColor) color), "Infected cities should match.");
+  }
+  for (city::CityId id = 0; id < expected.cities->size(); id++) {
+    assert_equal(actual.board.cube_count(id), expected.board.cube_count(id));
+    assert_equal(actual.distance_to_research_facility(id), expected.distance_to_research_facility(id));
+  }
+  for (const player::Player &player : expected.players) {
+    assert_equal<int>(actual.player_locations[player.role], expected.player_locations[player.role]);
+    const card::Hand &hand = actual.get_player(player.role).hand;
+    assert_equal(hand.contents.size(), player.hand.contents.size());
+    for (int i = 0; i < player.hand.contents.size(); i++) {
+      assert_true(hand.contents[i] == player.hand.contents[i], "Hands should be in the same order.");
+    }
+  }
+  assert_equal(actual.contingency_card.contents.size(), expected.contingency_card.contents.size());
+  assert_same_deck(expected.infection_deck, actual.infection_deck);
+  assert_same_deck(expected.player_deck, actual.player_deck);
+  assert_equal(actual.outbreaks, expected.outbreaks);
+  assert_equal(actual.infection_rate_level, expected.infection_rate_level);
+  assert_equal(actual.research_facility_reserve, expected.research_facility_reserve);
+  assert_true(actual.generator == expected.generator, "The generator should be restored.");
+}
+
+TEST(undo_restores_each_move) {
+  Game game{initialize_state(medium, 4, 5)};
+  const GameState &state = game.get_state();
+  random::Generator generator{17};
+  MoveList moves;
+  for (int turn = 0; turn < 12; turn++) {
+    player::Role role = state.players[turn % state.players.size()].role;
+    TurnState turn_state{role, state.get_infection_rate()};
+    for (get_player_choices(role, state, turn_state, &moves); !moves.empty(); get_player_choices(role, state, turn_state, &moves)) {
+      GameState before = state;
+      TurnState turn_before = turn_state;
+      for (int i = 0; i < moves.size(); i += 1 + moves.size() / 8) {
+        Undo undo = game.apply(moves[i], turn_state);
+        game.undo(undo, turn_state);
+        assert_same_state(before, state);
+        assert_equal(turn_state.remaining_actions, turn_before.remaining_actions);
+      }
+      game.apply(moves[generator.below(moves.size())], turn_state);
+      turn_state.event_cards_played = true;
+    }
+    for (int draw = 0; draw < 2; draw++) {
+      if (game.draw_player_card(role)) {
+        return;
+      }
+      if (state.get_player(role).hand.contents.back().type() == card::epidemic) {
+        game.remove_player_card(role, state.get_player(role).hand.contents.back());
+        game.epidemic();
+      }
+    }
+    while (state.get_player(role).hand.contents.size() > HAND_LIMIT) {
+      game.discard(game.remove_player_card(role, state.get_player(role).hand.contents[0]));
+    }
+    for (int draw = 0; draw < state.get_infection_rate(); draw++) {
+      if (game.draw_infection_card()) {
+        return;
+      }
+    }
+  }
+}
+
+TEST(undo_restores_draws_and_epidemics) {
+  GameState initial = initialize_state(hard, 3, 9);
+  Game game{initial};
+  player::Role role = initial.players[0].role;
+  TurnState turn_state{role, initial.get_infection_rate()};
+  Undo start = game.checkpoint(turn_state);
+
+  for (int i = 0; i < 4; i++) {
+    game.draw_player_card(role);
+    game.draw_infection_card();
+  }
+  Undo middle = game.checkpoint(turn_state);
+  GameState before_epidemic = game.get_state();
+  game.epidemic();
+  game.epidemic();
+  assert_equal(game.get_state().infection_rate_level, 2);
+
+  game.undo(middle);
+  assert_same_state(before_epidemic, game.get_state());
+  game.undo(start);
+  assert_same_state(initial, game.get_state());
+}
+
+TEST(undo_restores_stacked_layers) {
+  GameState initial = initialize_state(medium, 2, 17);
+  Game game{initial};
+  TurnState turn_state{initial.players[0].role, initial.get_infection_rate()};
+  Undo start = game.checkpoint(turn_state);
+  game.epidemic();
+  GameState stacked = game.get_state();
+  assert_true(stacked.infection_deck.is_stacked(1), "The epidemic should stack the discard pile.");
+  assert_true(stacked.generator == initial.generator, "Stacking shouldn't use the generator.");
+
+  Undo before_draw = game.checkpoint(turn_state);
+  game.draw_infection_card();
+  assert_false(game.get_state().infection_deck.is_stacked(1), "The first draw should shuffle the layer.");
+  assert_false(game.get_state().generator == initial.generator, "The shuffle should use the generator.");
+  game.draw_infection_card();
+  game.undo(before_draw);
+  assert_same_state(stacked, game.get_state());
+  game.undo(start);
+  assert_same_state(initial, game.get_state());
+}
+
+TEST(undo_restores_outbreak_chain) {
+  GameState game_state{};
+  city::CityId atlanta = game_state.cities->id_of(CDC_LOCATION);
+  city::CityId chicago = game_state.cities->id_of("Chicago");
+  game_state.board.set_cube_count(atlanta, disease::blue, 3);
+  game_state.board.set_cube_count(chicago, disease::blue, 3);
+  game_state.diseases[disease::blue].reserve = DISEASE_RESERVE - 6;
+  game_state.infection_deck.insert(card::Card(atlanta, card::infect), 0);
+  Game game{game_state};
+  Undo start = game.checkpoint(TurnState{player::medic, 2});
+
+  game.draw_infection_card();
+  assert_equal(game.get_state().outbreaks, 2);
+  game.undo(start);
+  assert_same_state(game_state, game.get_state());
+}
 
-  choices[0].effect(game, turn_state);
-  assert_equal<std::string>(game.get_state().player_locations[player::contingency_planner], "Chicago");
+TEST(undo_restores_draws_from_any_position) {
+  GameState initial = initialize_state(medium, 2, 17);
+  Game game{initial};
+  player::Role role = initial.players[0].role;
+  TurnState turn_state{role, initial.get_infection_rate()};
+  Undo start = game.checkpoint(turn_state);
+  card::Card player_card = initial.player_deck.reveal(5);
+  card::Card infection_card = initial.infection_deck.reveal(7);
+
+  game.draw_player_card(role, 5);
+  game.draw_infection_card(7);
+  assert_true(game.get_state().get_player(role).hand.contents.back() == player_card, "The player card at the position should be drawn.");
+  assert_true(game.get_state().infection_deck.get_discard_contents().back() == infection_card, "The infection card at the position should be drawn.");
+  card::Card epidemic_card = game.get_state().infection_deck.reveal(3);
+  game.epidemic(3);
+  city::CityId epidemic_city = epidemic_card.city_id();
+  assert_equal(game.get_state().board.cube_count(epidemic_city, (*initial.cities)[epidemic_city].color), MAX_CUBES_PER_CITY);
+
+  game.undo(start);
+  assert_same_state(initial, game.get_state());
 }
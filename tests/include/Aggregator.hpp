@@ -14,7 +14,9 @@ namespace gerryfudd::test {
   };
 
   class Aggregator {
-    static std::vector<Test> tests;
+    // A function-local static, so that it is constructed before the first test
+    // registers itself no matter which translation unit that test is in.
+    static std::vector<Test>& tests();
   public:
     static void add(Test);
     static int run_all();
@@ -9,9 +9,12 @@ namespace gerryfudd::test {
     return message.c_str();
   }
 
-  std::vector<Test> Aggregator::tests;
+  std::vector<Test>& Aggregator::tests() {
+    static std::vector<Test> registered;
+    return registered;
+  }
   void Aggregator::add(Test t) {
-    Aggregator::tests.push_back(t);
+    tests().push_back(t);
   }
 
   bool update_name(char * name, const char * source) {
@@ -33,7 +36,7 @@ namespace gerryfudd::test {
     std::string current_file;
     int ordinal = 1;
 
-    for (std::vector<Test>::iterator current_test = tests.begin(); current_test != tests.end(); current_test++) {
+    for (std::vector<Test>::iterator current_test = tests().begin(); current_test != tests().end(); current_test++) {
       info_buff.str(std::string());
       failure_buff.str(std::string());
       if (current_file != current_test->get_filename()) {
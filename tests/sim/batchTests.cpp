@@ -0,0 +1,65 @@
+#include <Framework.hpp>
+#include <Assertions.inl>
+#include <sim/batch.hpp>
+
+using namespace gerryfudd::test;
+using namespace gerryfudd::sim;
+
+TEST(game_setup_varies_games) {
+  bool seen[DIFFICULTY_COUNT][PLAYER_COUNT_OPTIONS] = {};
+  for (uint32_t i = 0; i < 200; i++) {
+    GameSetup setup = game_setup(9, i);
+    assert_true(setup.player_count >= MIN_PLAYER_COUNT && setup.player_count < MIN_PLAYER_COUNT + PLAYER_COUNT_OPTIONS, "Every game should have a legal player count.");
+    seen[setup.difficulty][setup.player_count - MIN_PLAYER_COUNT] = true;
+    assert_equal(setup.seed, game_setup(9, i).seed);
+  }
+  for (int difficulty = 0; difficulty < DIFFICULTY_COUNT; difficulty++) {
+    for (int i = 0; i < PLAYER_COUNT_OPTIONS; i++) {
+      assert_true(seen[difficulty][i], "A batch should cover every difficulty and player count.");
+    }
+  }
+}
+
+TEST(work_range_take_and_steal) {
+  WorkRange owner, thief;
+  owner.reset(0, 10);
+  uint32_t begin, end;
+
+  assert_true(owner.take(4, &begin, &end), "A non-empty range should give up work.");
+  assert_equal(begin, 0u);
+  assert_equal(end, 4u);
+
+  assert_false(thief.take(4, &begin, &end), "An empty range should have no work to give.");
+  assert_true(owner.steal_into(&thief), "Six remaining games can be split.");
+  assert_true(thief.take(10, &begin, &end), "The thief should now have work.");
+  assert_equal(begin, 7u);
+  assert_equal(end, 10u);
+  assert_true(owner.take(10, &begin, &end), "The owner should keep the front half.");
+  assert_equal(begin, 4u);
+  assert_equal(end, 7u);
+}
+
+TEST(batch_summary_counts_every_game) {
+  BatchRunner runner{3};
+
+  BatchSummary summary = runner.run(120, 5);
+
+  assert_equal(summary.game_count(), 120l);
+  long losses = 0;
+  for (long count : summary.losses) {
+    losses += count;
+  }
+  assert_equal(summary.win_count() + losses, 120l);
+  long outbreak_total = 0;
+  for (long count : summary.outbreak_counts) {
+    outbreak_total += count;
+  }
+  assert_equal(outbreak_total, 120l);
+}
+
+TEST(batch_is_independent_of_thread_count) {
+  BatchSummary single = BatchRunner(1).run(90, 21);
+  BatchSummary several = BatchRunner(4).run(90, 21);
+
+  assert_true(single == several, "A batch should play the same games on any number of threads.");
+}
@@ -0,0 +1,239 @@
+#include <Framework.hpp>
+#include <Assertions.inl>
+#include <cmath>
+#include <map>
+#include <sim/expectimax.hpp>
+
+using namespace gerryfudd::test;
+using namespace gerryfudd::sim;
+
+// A game in which the first player stands on Atlanta's research facility
+// with five blue cards on the last action of their turn.
+GameState cure_in_reach(TurnState *turn_state) {
+  GameState game_state = initialize_state(easy, 2, 21);
+  player::Role role = game_state.players[0].role;
+  while (!game_state.get_player(role).hand.contents.empty()) {
+    game_state.remove_card(role, game_state.get_player(role).hand.contents[0]);
+  }
+  for (std::string name : {"Chicago", "Essen", "London", "Madrid", "Paris"}) {
+    game_state.add_card(role, card::Card(game_state.cities->id_of(name), card::player));
+  }
+  *turn_state = TurnState{role, game_state.get_infection_rate()};
+  turn_state->event_cards_played = true;
+  turn_state->remaining_actions = 1;
+  return game_state;
+}
+
+ExpectimaxOptions shallow_search(int depth, double probability_threshold) {
+  ExpectimaxOptions options;
+  options.depth = depth;
+  options.probability_threshold = probability_threshold;
+  return options;
+}
+
+TEST(expectimax_cures_on_last_action) {
+  TurnState turn_state{player::medic, 2};
+  GameState game_state = cure_in_reach(&turn_state);
+  MoveList moves;
+  get_player_choices(turn_state.active_role, game_state, turn_state, &moves);
+  ExpectimaxPolicy policy{shallow_search(1, 0.02)};
+
+  int choice = policy.choose(moves, game_state, turn_state);
+
+  assert_true(choice != NO_MOVE, "An action should be chosen.");
+  assert_equal(moves[choice].action, player::cure);
+}
+
+TEST(expectimax_leaves_the_position_unchanged) {
+  GameState game_state = initialize_state(medium, 3, 4);
+  TurnState turn_state{game_state.players[0].role, game_state.get_infection_rate()};
+  turn_state.event_cards_played = true;
+  MoveList moves;
+  get_player_choices(turn_state.active_role, game_state, turn_state, &moves);
+  ExpectimaxPolicy policy{shallow_search(2, 0.05)};
+  uint64_t hash = game_state.hash();
+
+  policy.choose(moves, game_state, turn_state);
+
+  assert_equal(game_state.hash(), hash);
+  assert_true(policy.stats().nodes > 0, "The search should visit nodes.");
+  assert_true(policy.stats().memo_hits > 0, "Draws in a different order should reach memoized positions.");
+}
+
+TEST(expectimax_threshold_limits_search) {
+  GameState game_state = initialize_state(medium, 2, 8);
+  TurnState turn_state{game_state.players[0].role, game_state.get_infection_rate()};
+  turn_state.event_cards_played = true;
+  MoveList moves;
+  get_player_choices(turn_state.active_role, game_state, turn_state, &moves);
+  ExpectimaxPolicy narrow{shallow_search(1, 0.2)};
+  ExpectimaxPolicy wide{shallow_search(1, 0.01)};
+
+  narrow.choose(moves, game_state, turn_state);
+  wide.choose(moves, game_state, turn_state);
+
+  assert_true(narrow.stats().nodes < wide.stats().nodes, "Unlikely draws should not be searched.");
+}
+
+TEST(expectimax_plays_a_game) {
+  ExpectimaxPolicy policy{shallow_search(1, 0.1)};
+  Simulator simulator{&policy};
+
+  GameResult result = simulator.play(easy, 2, 3);
+
+  assert_true(result.turns > 0, "A game should last at least one turn.");
+  assert_true(result.won == (result.loss_reason == no_loss), "A game should either be won or lost for a reason.");
+}
+
+TEST(expectimax_needs_a_depth) {
+  bool exception_thrown = false;
+  try {
+    ExpectimaxPolicy policy{shallow_search(0, 0.02)};
+  } catch (std::invalid_argument &e) {
+    exception_thrown = true;
+    assert_equal<std::string>(e.what(), "A search must look at least one action ahead.");
+  }
+  assert_true(exception_thrown, "A search that looks at no actions can't choose one.");
+}
+
+// Whether two infection cards lead to the same kind of position: unprotected
+// cities of the same color and cube count, or the same city once it is full
+// or protected.
+bool infects_alike(const GameState &game_state, card::Card a, card::Card b) {
+  disease::DiseaseColor color = (*game_state.cities)[a.city_id()].color;
+  int count = game_state.board.cube_count(a.city_id(), color);
+  if (count == MAX_CUBES_PER_CITY || game_state.prevent_placement(a.city_id(), color) || game_state.prevent_placement(b.city_id(), color) || (*game_state.cities)[b.city_id()].color != color) {
+    return a.city_id() == b.city_id();
+  }
+  return game_state.board.cube_count(b.city_id(), color) == count;
+}
+
+// Checks the infection outcomes against infects_alike.
+void assert_infection_outcomes(const GameState &game_state) {
+  int top = game_state.infection_deck.layer_size(game_state.infection_deck.layer_of(0));
+  Outcomes outcomes;
+
+  int available = infection_outcomes(game_state, &outcomes);
+
+  assert_equal(available, top);
+  int covered = 0;
+  for (const Outcome &outcome : outcomes) {
+    assert_true(outcome.position < top, "An infection card should come from the cards the epidemic stacked on top.");
+    card::Card card = game_state.infection_deck.reveal(outcome.position);
+    int alike = 0;
+    for (int i = 0; i < top; i++) {
+      alike += infects_alike(game_state, card, game_state.infection_deck.reveal(i));
+    }
+    assert_equal(outcome.count, alike);
+    covered += outcome.count;
+  }
+  assert_equal(covered, top);
+}
+
+TEST(expectimax_infections_come_from_the_top_layer) {
+  Game game{initialize_state(hard, 2, 21)};
+  game.epidemic();
+  const GameState &game_state = game.get_state();
+
+  assert_equal(game_state.infection_deck.layer_size(game_state.infection_deck.layer_of(0)), 10);
+  assert_infection_outcomes(game_state);
+}
+
+TEST(expectimax_infections_of_protected_cities_stand_alone) {
+  Game game{initialize_state(hard, 2, 21)};
+  game.epidemic();
+  GameState game_state = game.get_state();
+  // Of the ten cities on top, two share a color. Give them the same cubes so
+  // that they would be alike, then protect one.
+  int top = game_state.infection_deck.layer_size(game_state.infection_deck.layer_of(0));
+  city::CityId protected_city = NO_CITY;
+  for (int i = 0; i < top && protected_city == NO_CITY; i++) {
+    for (int j = i + 1; j < top && protected_city == NO_CITY; j++) {
+      city::CityId a = game_state.infection_deck.reveal(i).city_id(), b = game_state.infection_deck.reveal(j).city_id();
+      disease::DiseaseColor color = (*game_state.cities)[a].color;
+      if (a != b && (*game_state.cities)[b].color == color) {
+        game_state.board.set_cube_count(a, color, 1);
+        game_state.board.set_cube_count(b, color, 1);
+        assert_true(infects_alike(game_state, card::Card(a, card::infect), card::Card(b, card::infect)), "Cities of a color with the same cubes should be alike.");
+        protected_city = a;
+      }
+    }
+  }
+  assert_true(protected_city != NO_CITY, "Two cities in the top layer should share a color.");
+  game_state.protected_cities[(*game_state.cities)[protected_city].color].insert(protected_city);
+
+  assert_infection_outcomes(game_state);
+}
+
+TEST(expectimax_epidemics_come_from_the_bottom_layer) {
+  Game game{initialize_state(hard, 2, 21)};
+  game.epidemic();
+  const GameState &game_state = game.get_state();
+  int remaining = game_state.infection_deck.remaining();
+  int bottom = game_state.infection_deck.layer_size(game_state.infection_deck.layer_of(-1));
+  Outcomes outcomes;
+
+  int available = epidemic_outcomes(game_state, &outcomes);
+
+  assert_equal(available, bottom);
+  assert_equal(bottom, remaining - 10);
+  int covered = 0;
+  for (const Outcome &outcome : outcomes) {
+    assert_true(outcome.position >= remaining - bottom, "An epidemic should draw from the cards below the stacked layer.");
+    disease::DiseaseColor color = (*game_state.cities)[game_state.infection_deck.reveal(outcome.position).city_id()].color;
+    int alike = 0;
+    for (int i = remaining - bottom; i < remaining; i++) {
+      alike += (*game_state.cities)[game_state.infection_deck.reveal(i).city_id()].color == color;
+    }
+    assert_equal(outcome.count, alike);
+    covered += outcome.count;
+  }
+  assert_equal(covered, bottom);
+}
+
+// The undrawn player cards of each group other than the epidemics.
+std::map<int, int> player_groups(const GameState &game_state, int *others) {
+  std::map<int, int> result;
+  *others = 0;
+  for (int i = 0; i < game_state.player_deck.remaining(); i++) {
+    card::Card card = game_state.player_deck.reveal(i);
+    if (card.type() != card::epidemic) {
+      result[card.type() == card::city ? (int) card::city + (*game_state.cities)[card.city_id()].color : (int) card.type()]++;
+      (*others)++;
+    }
+  }
+  return result;
+}
+
+TEST(expectimax_player_draws_follow_the_epidemic_pile) {
+  GameState game_state = initialize_state(hard, 2, 21);
+  int left = game_state.epidemic_piles[0], others;
+  std::map<int, int> groups = player_groups(game_state, &others);
+  Outcomes outcomes;
+
+  int total = player_outcomes(game_state, &outcomes);
+
+  // The epidemic is one of the pile's cards; the rest could be any other card.
+  double covered = 0;
+  for (const Outcome &outcome : outcomes) {
+    double probability = (double) outcome.count / total;
+    if (game_state.player_deck.reveal(outcome.position).type() == card::epidemic) {
+      assert_true(std::abs(probability - 1.0 / left) < 1e-9, "The epidemic should be drawn with one chance in the pile's cards.");
+    } else {
+      assert_true(std::abs(probability - (1 - 1.0 / left) * groups[outcome.group] / others) < 1e-9, "Other cards should be drawn by the composition of the whole deck.");
+    }
+    covered += probability;
+  }
+  assert_equal(outcomes.size(), (int) groups.size() + 1);
+  assert_true(std::abs(covered - 1) < 1e-9, "The outcomes should cover every draw.");
+
+  // Once the pile's epidemic is drawn, no other epidemic can come from it.
+  game_state.infection_rate_level = 1;
+  Outcomes later;
+  total = player_outcomes(game_state, &later);
+  assert_equal(total, others);
+  for (const Outcome &outcome : later) {
+    assert_true(game_state.player_deck.reveal(outcome.position).type() != card::epidemic, "The next pile's epidemic should not be drawn early.");
+    assert_equal(outcome.count, groups[outcome.group]);
+  }
+}
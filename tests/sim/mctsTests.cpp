@@ -0,0 +1,143 @@
+#include <Framework.hpp>
+#include <Assertions.inl>
+#include <algorithm>
+#include <vector>
+#include <sim/mcts.hpp>
+
+using namespace gerryfudd::test;
+using namespace gerryfudd::sim;
+
+// A game in which the first player stands on Atlanta's research facility
+// with five blue cards on the last action of their turn.
+GameState ready_to_cure(TurnState *turn_state) {
+  GameState game_state = initialize_state(easy, 2, 21);
+  player::Role role = game_state.players[0].role;
+  while (!game_state.get_player(role).hand.contents.empty()) {
+    game_state.remove_card(role, game_state.get_player(role).hand.contents[0]);
+  }
+  for (std::string name : {"Chicago", "Essen", "London", "Madrid", "Paris"}) {
+    game_state.add_card(role, card::Card(game_state.cities->id_of(name), card::player));
+  }
+  *turn_state = TurnState{role, game_state.get_infection_rate()};
+  turn_state->event_cards_played = true;
+  turn_state->remaining_actions = 1;
+  return game_state;
+}
+
+SearchOptions short_search(int iterations, int threads) {
+  SearchOptions options;
+  options.iterations = iterations;
+  options.threads = threads;
+  options.rollout_turns = 1;
+  return options;
+}
+
+TEST(mcts_cures_on_last_action) {
+  TurnState turn_state{player::medic, 2};
+  GameState game_state = ready_to_cure(&turn_state);
+  MoveList moves;
+  get_player_choices(turn_state.active_role, game_state, turn_state, &moves);
+  MctsPolicy policy{short_search(400, 1), 1};
+
+  int choice = policy.choose(moves, game_state, turn_state);
+
+  assert_true(choice != NO_MOVE, "An action should be chosen.");
+  assert_equal(moves[choice].action, player::cure);
+  assert_true(policy.root_visits() > 0, "The chosen move's subtree should be kept for the next choice.");
+}
+
+TEST(mcts_root_parallel_search) {
+  TurnState turn_state{player::medic, 2};
+  GameState game_state = ready_to_cure(&turn_state);
+  MoveList moves;
+  get_player_choices(turn_state.active_role, game_state, turn_state, &moves);
+  MctsPolicy policy{short_search(800, 2), 5};
+
+  int choice = policy.choose(moves, game_state, turn_state);
+
+  assert_equal(moves[choice].action, player::cure);
+}
+
+TEST(mcts_plays_a_game) {
+  MctsPolicy policy{short_search(16, 1), 3};
+  Simulator simulator{&policy};
+
+  GameResult result = simulator.play(easy, 2, 3);
+
+  assert_true(result.turns > 0, "A game should last at least one turn.");
+  assert_true(result.won == (result.loss_reason == no_loss), "A game should either be won or lost for a reason.");
+}
+
+TEST(mcts_needs_a_budget) {
+  SearchOptions options;
+  options.iterations = 0;
+  bool exception_thrown = false;
+  try {
+    MctsPolicy policy{options, 1};
+  } catch (std::invalid_argument &e) {
+    exception_thrown = true;
+    assert_equal<std::string>(e.what(), "A search needs an iteration or time budget.");
+  }
+  assert_true(exception_thrown, "A search without a budget would never stop.");
+}
+
+// The ids of the undrawn player cards left in each epidemic pile, sorted.
+std::vector<std::vector<int>> pile_contents(const GameState &state) {
+  std::vector<std::vector<int>> result;
+  int total = 0;
+  for (int size : state.epidemic_piles) {
+    total += size;
+  }
+  int drawn = total - state.player_deck.remaining(), start = 0;
+  for (int size : state.epidemic_piles) {
+    std::vector<int> pile;
+    for (int i = std::max(start, drawn); i < start + size; i++) {
+      pile.push_back(state.player_deck.reveal(i - drawn).id);
+    }
+    std::sort(pile.begin(), pile.end());
+    result.push_back(pile);
+    start += size;
+  }
+  return result;
+}
+
+// The epidemics left in each pile.
+std::vector<int> pile_epidemics(const std::vector<std::vector<int>> &piles) {
+  std::vector<int> result;
+  for (const std::vector<int> &pile : piles) {
+    result.push_back(std::count(pile.begin(), pile.end(), card::Card(card::epidemic).id));
+  }
+  return result;
+}
+
+TEST(determinize_keeps_epidemics_in_their_piles) {
+  Game game{initialize_state(hard, 4, 6)};
+  player::Role role = game.get_state().players[0].role;
+  for (int i = 0; i < 3; i++) {
+    game.draw_player_card(role);
+  }
+  const GameState &state = game.get_state();
+  std::vector<std::vector<int>> piles = pile_contents(state);
+  std::vector<int> undrawn;
+  for (const std::vector<int> &pile : piles) {
+    undrawn.insert(undrawn.end(), pile.begin(), pile.end());
+  }
+  std::sort(undrawn.begin(), undrawn.end());
+  random::Generator generator{2};
+  bool moved = false;
+  for (int i = 0; i < 20; i++) {
+    GameState deal = state;
+    determinize(&deal, generator);
+    std::vector<std::vector<int>> dealt = pile_contents(deal);
+    std::vector<int> cards;
+    for (int pile = 0; pile < (int) piles.size(); pile++) {
+      assert_equal(dealt[pile].size(), piles[pile].size());
+      cards.insert(cards.end(), dealt[pile].begin(), dealt[pile].end());
+    }
+    std::sort(cards.begin(), cards.end());
+    assert_true(cards == undrawn, "The same cards should be left to draw.");
+    assert_true(pile_epidemics(dealt) == pile_epidemics(piles), "Each epidemic should stay in its pile.");
+    moved = moved || dealt != piles;
+  }
+  assert_true(moved, "Cards other than the epidemics should be dealt across the piles.");
+}
@@ -0,0 +1,164 @@
+#include <Framework.hpp>
+#include <Assertions.inl>
+#include <cmath>
+#include <sim/mcts.hpp>
+#include <sim/risk.hpp>
+
+using namespace gerryfudd::test;
+using namespace gerryfudd::sim;
+
+void assert_close(double actual, double expected, std::string message) {
+  assert_true(std::abs(actual - expected) < 1e-9, (message + " Expected " + std::to_string(expected) + " but was " + std::to_string(actual) + ".").c_str());
+}
+
+// A new two player game on easy: 39 undrawn infection cards, 9 in the discard
+// and 12 player cards in the first pile, one of them an epidemic.
+TEST(risk_of_the_first_turn) {
+  GameState game_state = initialize_state(easy, 2, 6);
+  city::CityId discarded = game_state.infection_deck.get_discard_contents()[0].city_id();
+  city::CityId undrawn = game_state.infection_deck.reveal(0).city_id();
+
+  RiskReport report = assess_risk(game_state, 1);
+
+  assert_close(report.epidemic_probability, 2.0 / 12, "One of the first two player cards may be the epidemic.");
+  // After an epidemic the 10 discards are on top and two of them are drawn.
+  assert_close(report.draw_probability[discarded], 2.0 / 12 * 2 / 10, "Discards are only drawn after an epidemic.");
+  // Otherwise two of the 39 are drawn, and an epidemic takes one of them from the bottom.
+  assert_close(report.draw_probability[undrawn], 10.0 / 12 * 2 / 39 + 2.0 / 12 / 39, "Undrawn cards are drawn at the rate.");
+}
+
+TEST(risk_of_a_saturated_city) {
+  GameState game_state = initialize_state(easy, 2, 6);
+  city::CityId saturated = game_state.infection_deck.get_discard_contents()[8].city_id();
+  assert_equal(game_state.board.cube_count(saturated), 3);
+
+  RiskReport report = assess_risk(game_state, 1);
+
+  assert_close(report.outbreak_probability[saturated], report.draw_probability[saturated], "Drawing a city with three cubes breaks it out.");
+  game_state.outbreaks = OUTBREAK_LIMIT - 1;
+  RiskReport late = assess_risk(game_state, 1);
+  assert_true(late.outbreak_loss_probability >= report.outbreak_probability[saturated], "Any outbreak should end the game.");
+  assert_true(late.outbreak_loss_probability < 1, "Some deals should end the game without an outbreak.");
+}
+
+TEST(risk_grows_with_turns) {
+  GameState game_state = initialize_state(hard, 4, 3);
+  RiskReport one = assess_risk(game_state, 1);
+  RiskReport four = assess_risk(game_state, RISK_TURN_LIMIT);
+
+  assert_true(four.epidemic_probability > one.epidemic_probability, "More turns should draw more epidemics.");
+  assert_true(four.outbreak_loss_probability >= one.outbreak_loss_probability, "More turns should risk more outbreaks.");
+  double expected_draws = 0;
+  for (city::CityId id = 0; id < game_state.cities->size(); id++) {
+    assert_true(four.draw_probability[id] >= one.draw_probability[id], "More turns should draw more cards.");
+    assert_true(four.draw_probability[id] <= 1, "Probabilities should be at most one.");
+    expected_draws += one.draw_probability[id];
+  }
+  // Two or three cards are drawn, fewer when an epidemic draws one twice.
+  assert_true(expected_draws > 2 && expected_draws < 3, "The chances should sum to about the draws in a turn.");
+}
+
+TEST(risk_follows_intensified_layers) {
+  GameState game_state = initialize_state(medium, 3, 12);
+  Game game{game_state};
+  game.epidemic();
+  const GameState &state = game.get_state();
+  card::Deck deck = state.infection_deck;
+  int layer_size = deck.layer_size(1);
+
+  RiskReport report = assess_risk(state, 1);
+
+  // Without a second epidemic the rate's cards all come from the known top layer.
+  city::CityId below = deck.reveal(layer_size).city_id();
+  assert_true(report.draw_probability[below] < 0.05, "Cards under the top layer should rarely be drawn.");
+  city::CityId top = deck.reveal(0).city_id();
+  assert_true(report.draw_probability[top] > (double) state.get_infection_rate() / layer_size * 0.8, "Cards in the top layer should be drawn at its rate.");
+}
+
+// Tallies one sampled turn of the game as the calculator sees it: two player
+// cards and the infection cards at the rate, with no actions. Each infection
+// card's layer is shuffled before it is revealed so that the card drawn is
+// known in advance, and its city broke out if the outbreaks went up, since an
+// outbreak chain starts with the city drawn.
+void sample_risk_turn(const GameState &game_state, random::Generator &generator, RiskReport *tally) {
+  GameState sample = game_state;
+  determinize(&sample, generator);
+  Game game{sample};
+  const GameState &state = game.get_state();
+  player::Role role = state.players[0].role;
+  bool epidemic_drawn = false;
+  for (int draw = 0; draw < 2; draw++) {
+    game.draw_player_card(role);
+    card::Card drawn = state.get_player(role).hand.contents.back();
+    if (drawn.type() != card::epidemic) {
+      continue;
+    }
+    tally->epidemic_probability += !epidemic_drawn;
+    epidemic_drawn = true;
+    game.remove_player_card(role, drawn);
+    game.shuffle_layer(card::infect, -1);
+    city::CityId city_id = state.infection_deck.reveal(-1).city_id();
+    int outbreaks = state.outbreaks;
+    bool lost = game.epidemic();
+    tally->draw_probability[city_id]++;
+    tally->outbreak_probability[city_id] += state.outbreaks > outbreaks;
+    if (lost) {
+      return;
+    }
+  }
+  for (int draw = 0; draw < state.get_infection_rate() && state.infection_deck.remaining() > 0; draw++) {
+    game.shuffle_layer(card::infect, 0);
+    city::CityId city_id = state.infection_deck.reveal(0).city_id();
+    int outbreaks = state.outbreaks;
+    bool lost = game.draw_infection_card();
+    tally->draw_probability[city_id]++;
+    tally->outbreak_probability[city_id] += state.outbreaks > outbreaks;
+    if (lost) {
+      return;
+    }
+  }
+}
+
+// Cubes are put on the bottom of the infection deck so that an epidemic is
+// likely to break one of them out.
+TEST(risk_matches_sampled_games) {
+  GameState game_state = initialize_state(easy, 2, 6);
+  city::CitySet bottom;
+  for (int position = game_state.infection_deck.remaining() - 10; position < game_state.infection_deck.remaining(); position++) {
+    city::CityId city_id = game_state.infection_deck.reveal(position).city_id();
+    game_state.board.set_cube_count(city_id, (*game_state.cities)[city_id].color, 1);
+    bottom.insert(city_id);
+  }
+  int samples = 20000;
+  random::Generator generator{8};
+  RiskReport tally;
+  for (int i = 0; i < samples; i++) {
+    sample_risk_turn(game_state, generator, &tally);
+  }
+
+  RiskReport report = assess_risk(game_state, 1);
+
+  assert_true(std::abs(tally.epidemic_probability / samples - report.epidemic_probability) < 0.015, "Epidemics should be as likely as in the game.");
+  double discard_draws = 0, sampled_discard_draws = 0, bottom_outbreaks = 0, sampled_bottom_outbreaks = 0;
+  for (card::Card card : game_state.infection_deck.get_discard_contents()) {
+    discard_draws += report.draw_probability[card.city_id()];
+    sampled_discard_draws += tally.draw_probability[card.city_id()] / samples;
+  }
+  for (city::CityId city_id : bottom) {
+    bottom_outbreaks += report.outbreak_probability[city_id];
+    sampled_bottom_outbreaks += tally.outbreak_probability[city_id] / samples;
+  }
+  assert_true(std::abs(sampled_discard_draws - discard_draws) < 0.03, "Discards should be drawn as often as in the game.");
+  assert_true(bottom_outbreaks > 0.02, "An epidemic should break out a city with cubes.");
+  assert_true(std::abs(sampled_bottom_outbreaks - bottom_outbreaks) < 0.01, "Epidemics should break out cities as often as in the game.");
+}
+
+TEST(risk_needs_turns) {
+  bool exception_thrown = false;
+  try {
+    assess_risk(initialize_state(), 0);
+  } catch (std::invalid_argument &e) {
+    exception_thrown = true;
+  }
+  assert_true(exception_thrown, "Risk should be assessed for at least one turn.");
+}
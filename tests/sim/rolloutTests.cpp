@@ -0,0 +1,83 @@
+#include <Framework.hpp>
+#include <Assertions.inl>
+#include <sim/rollout.hpp>
+
+using namespace gerryfudd::test;
+using namespace gerryfudd::sim;
+
+void assert_lane_matches(const GameBatch &batch, int lane, const GameState &state, bool lost) {
+  for (city::CityId id = 0; id < state.cities->size(); id++) {
+    for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+      assert_equal(batch.cube_count(lane, id, (disease::DiseaseColor) color), state.board.cube_count(id, (disease::DiseaseColor) color));
+    }
+  }
+  for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+    assert_equal(batch.reserve(lane, (disease::DiseaseColor) color), state.diseases[color].reserve);
+  }
+  assert_equal(batch.outbreaks(lane), state.outbreaks);
+  assert_equal(batch.infection_rate_level(lane), state.infection_rate_level);
+  assert_true(batch.lost(lane) == lost, "The lane should be lost with the game.");
+  if (!lost) {
+    assert_equal(batch.remaining(lane), state.infection_deck.remaining());
+  }
+}
+
+TEST(game_batch_matches_game) {
+  int outbreaks = 0;
+  for (uint64_t seed = 1; seed <= 6; seed++) {
+    GameState state = initialize_state(hard, 4, seed);
+    state.infection_rate_level = INFECTION_RATE_SIZE - 2;
+    Game game{state};
+    // The epidemic stacks the infected cities back on top to break out.
+    game.epidemic();
+    GameBatch batch{game.get_state()};
+    bool lost = false;
+    for (int turn = 0; turn < 9 && !lost; turn++) {
+      batch.infect();
+      for (int i = 0; i < game.get_state().get_infection_rate() && !lost; i++) {
+        lost = game.draw_infection_card();
+      }
+      for (int lane = 0; lane < BATCH_LANES; lane++) {
+        assert_lane_matches(batch, lane, game.get_state(), lost);
+      }
+    }
+    outbreaks += game.get_state().outbreaks;
+  }
+  assert_true(outbreaks > 0, "The games should have had outbreaks to compare.");
+}
+
+TEST(game_batch_respects_protection) {
+  GameState state = initialize_state(medium, 2, 3);
+  city::CityId top = state.infection_deck.reveal(0).city_id();
+  disease::DiseaseColor color = (*state.cities)[top].color;
+  state.player_locations[player::quarantine_specialist] = top;
+  state.update_protection();
+  int before = state.board.cube_count(top, color);
+  GameBatch batch{state};
+  batch.infect();
+  for (int lane = 0; lane < BATCH_LANES; lane++) {
+    assert_equal(batch.cube_count(lane, top, color), before);
+    assert_equal(batch.remaining(lane), state.infection_deck.remaining() - state.get_infection_rate());
+  }
+}
+
+TEST(game_batch_shuffles_lanes) {
+  GameState state = initialize_state(medium, 3, 8);
+  random::Generator generator{5};
+  GameBatch batch{state, generator};
+  for (int turn = 0; turn < 6; turn++) {
+    batch.infect();
+  }
+  bool differ = false;
+  for (int lane = 0; lane < BATCH_LANES; lane++) {
+    for (int color = 0; color < DISEASE_COLOR_COUNT; color++) {
+      int placed = 0;
+      for (city::CityId id = 0; id < state.cities->size(); id++) {
+        placed += batch.cube_count(lane, id, (disease::DiseaseColor) color);
+        differ = differ || batch.cube_count(lane, id, (disease::DiseaseColor) color) != batch.cube_count(0, id, (disease::DiseaseColor) color);
+      }
+      assert_equal(placed + batch.reserve(lane, (disease::DiseaseColor) color), DISEASE_RESERVE);
+    }
+  }
+  assert_true(differ, "Each lane should draw its own order.");
+}
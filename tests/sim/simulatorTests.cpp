@@ -0,0 +1,102 @@
+#include <Framework.hpp>
+#include <Assertions.inl>
+#include <sim/simulator.hpp>
+#include <thread>
+#include <vector>
+
+using namespace gerryfudd::test;
+using namespace gerryfudd::sim;
+
+// Never plays an event or takes an action and discards the oldest card.
+class PassivePolicy: public Policy {
+public:
+  int choose(const MoveList&, GameStateView, const TurnState&) override {
+    return NO_MOVE;
+  }
+  card::Card choose_discard(player::Role role, GameStateView game_state) override {
+    return game_state->get_player(role).hand.contents[0];
+  }
+};
+
+TEST(simulate_random_game) {
+  RandomPolicy policy{7};
+  Simulator simulator{&policy};
+
+  GameResult result = simulator.play(easy, 4, 7);
+
+  assert_true(result.turns > 0, "A game should last at least one turn.");
+  assert_true(result.won == (result.loss_reason == no_loss), "A game should either be won or lost for a reason.");
+  assert_true(result.epidemic_turns.size() <= BASE_EPIDEMIC_COUNT + easy, "No more epidemics can be drawn than were shuffled in.");
+  for (int i = 1; i < result.epidemic_turns.size(); i++) {
+    assert_true(result.epidemic_turns[i - 1] <= result.epidemic_turns[i], "Epidemics should be recorded in the order they were drawn.");
+  }
+}
+
+TEST(simulate_is_reproducible_from_seed) {
+  RandomPolicy first_policy{3}, second_policy{3};
+  Simulator first{&first_policy}, second{&second_policy};
+
+  GameResult first_result = first.play(hard, 3, 11);
+  GameResult second_result = second.play(hard, 3, 11);
+
+  assert_equal(first_result.won, second_result.won);
+  assert_equal(first_result.loss_reason, second_result.loss_reason);
+  assert_equal(first_result.turns, second_result.turns);
+  assert_equal(first_result.outbreaks, second_result.outbreaks);
+}
+
+TEST(simulate_with_a_new_policy) {
+  RandomPolicy used_policy{5}, first_policy{3}, second_policy{3};
+  Simulator reused{&used_policy}, fresh{&second_policy};
+  reused.play(easy, 2, 4);
+  reused.set_policy(&first_policy);
+
+  GameResult first_result = reused.play(hard, 3, 11);
+  GameResult second_result = fresh.play(hard, 3, 11);
+
+  assert_equal(first_result.loss_reason, second_result.loss_reason);
+  assert_equal(first_result.turns, second_result.turns);
+  assert_equal(first_result.outbreaks, second_result.outbreaks);
+}
+
+TEST(simulate_passive_game_is_lost) {
+  PassivePolicy policy;
+  Simulator simulator{&policy};
+
+  GameResult result = simulator.play(easy, 2, 5);
+
+  assert_false(result.won, "A game in which nobody acts should be lost.");
+  assert_equal(result.cures, 0);
+  if (result.loss_reason == outbreaks) {
+    assert_equal(result.outbreaks, OUTBREAK_LIMIT);
+  }
+}
+
+// Run under -fsanitize=thread to check that concurrent games share no mutable state.
+TEST(simulate_concurrent_games) {
+  const int thread_count = 8;
+  const int games_per_thread = 250;
+  std::vector<GameResult> results(thread_count * games_per_thread);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; t++) {
+    threads.emplace_back([&results, t] {
+      for (int i = t * games_per_thread; i < (t + 1) * games_per_thread; i++) {
+        RandomPolicy policy{(uint64_t) i};
+        Simulator simulator{&policy};
+        results[i] = simulator.play((Difficulty) (i % 3), 2 + i % 3, i);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < (int) results.size(); i += 97) {
+    RandomPolicy policy{(uint64_t) i};
+    Simulator simulator{&policy};
+    GameResult expected = simulator.play((Difficulty) (i % 3), 2 + i % 3, i);
+    assert_equal(results[i].turns, expected.turns);
+    assert_equal(results[i].loss_reason, expected.loss_reason);
+    assert_equal(results[i].outbreaks, expected.outbreaks);
+  }
+}
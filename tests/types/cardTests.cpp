@@ -1,32 +1,34 @@
 #include <Framework.hpp>
 #include <Assertions.inl>
 #include <types/card.hpp>
+#include <set>
+#include <type_traits>
 
 using namespace gerryfudd::test;
 
 TEST(populate_deck) {
-  std::string card_names[] = {"foo", "bar", "baz"};
 
   gerryfudd::types::card::Deck deck{gerryfudd::types::card::infect};
   assert_equal(deck.size(), 0);
   assert_equal(deck.remaining(), 0);
 
   for (int i = 0; i < 3; i++) {
-    deck.discard(gerryfudd::types::card::Card(card_names[i], gerryfudd::types::card::infect));
+    deck.discard(gerryfudd::types::card::Card(i, gerryfudd::types::card::infect));
     assert_equal(deck.size(), i + 1);
     assert_equal(deck.remaining(), 0);
   }
 
-  deck.shuffle();
+  gerryfudd::types::random::Generator generator{1};
+  deck.shuffle(generator);
   assert_equal(deck.size(), 3);
   assert_equal(deck.remaining(), 3);
 
-  std::vector<std::string> draws;
+  std::vector<gerryfudd::types::card::Card> draws;
   while (draws.size() < 3)
   {
-    std::string current = deck.draw().name;
+    gerryfudd::types::card::Card current = deck.draw();
     for (auto draw = draws.begin(); draw != draws.end(); draw++) {
-      assert_false(current == *draw, (current + " should not have already been drawn.").c_str());
+      assert_false(current == *draw, "This card should not have already been drawn.");
     }
     draws.push_back(current);
     assert_equal(deck.size(), deck.remaining());
@@ -36,7 +38,7 @@ TEST(populate_deck) {
 
 TEST(deck_rejects_wrong_type) {
   gerryfudd::types::card::Deck infect_deck{gerryfudd::types::card::infect};
-  gerryfudd::types::card::Card infect_card{"Infect card", gerryfudd::types::card::infect}, player_card{"Player Card", gerryfudd::types::card::player};
+  gerryfudd::types::card::Card infect_card{0, gerryfudd::types::card::infect}, player_card{0, gerryfudd::types::card::player};
   bool error_thrown{false};
   try {
     infect_deck.discard(infect_card);
@@ -55,51 +57,53 @@ TEST(deck_rejects_wrong_type) {
 
 TEST(deck_insert) {
   gerryfudd::types::card::Deck player_deck{gerryfudd::types::card::player};
-  player_deck.discard(gerryfudd::types::card::Card("Seattle", gerryfudd::types::card::player));
-  player_deck.discard(gerryfudd::types::card::Card("Tacoma", gerryfudd::types::card::player)); 
-  player_deck.discard(gerryfudd::types::card::Card("Olympia", gerryfudd::types::card::player)); 
-  player_deck.discard(gerryfudd::types::card::Card("Centralia", gerryfudd::types::card::player)); 
-  player_deck.discard(gerryfudd::types::card::Card("Astoria", gerryfudd::types::card::player)); 
-  player_deck.discard(gerryfudd::types::card::Card("Newberg", gerryfudd::types::card::player)); 
-  player_deck.discard(gerryfudd::types::card::Card("Portland", gerryfudd::types::card::player)); 
-  player_deck.discard(gerryfudd::types::card::Card("Bend", gerryfudd::types::card::player)); 
-  player_deck.discard(gerryfudd::types::card::Card("Gresham", gerryfudd::types::card::player));
+  player_deck.discard(gerryfudd::types::card::Card(0, gerryfudd::types::card::player));
+  player_deck.discard(gerryfudd::types::card::Card(1, gerryfudd::types::card::player)); 
+  player_deck.discard(gerryfudd::types::card::Card(2, gerryfudd::types::card::player)); 
+  player_deck.discard(gerryfudd::types::card::Card(3, gerryfudd::types::card::player)); 
+  player_deck.discard(gerryfudd::types::card::Card(4, gerryfudd::types::card::player)); 
+  player_deck.discard(gerryfudd::types::card::Card(5, gerryfudd::types::card::player)); 
+  player_deck.discard(gerryfudd::types::card::Card(6, gerryfudd::types::card::player)); 
+  player_deck.discard(gerryfudd::types::card::Card(7, gerryfudd::types::card::player)); 
+  player_deck.discard(gerryfudd::types::card::Card(8, gerryfudd::types::card::player));
 
-  player_deck.shuffle();
+  gerryfudd::types::random::Generator generator{1};
+  player_deck.shuffle(generator);
 
-  player_deck.insert(gerryfudd::types::card::Card(EPIDEMIC, gerryfudd::types::card::player, gerryfudd::types::card::epidemic), 6);
-  assert_equal<std::string>(player_deck.reveal(6).name, EPIDEMIC);
+  player_deck.insert(gerryfudd::types::card::Card(gerryfudd::types::card::epidemic), 6);
+  assert_equal(player_deck.reveal(6).type(), gerryfudd::types::card::epidemic);
 
-  player_deck.insert(gerryfudd::types::card::Card(EPIDEMIC, gerryfudd::types::card::player, gerryfudd::types::card::epidemic), 3);
-  assert_equal<std::string>(player_deck.reveal(3).name, EPIDEMIC);
+  player_deck.insert(gerryfudd::types::card::Card(gerryfudd::types::card::epidemic), 3);
+  assert_equal(player_deck.reveal(3).type(), gerryfudd::types::card::epidemic);
 
-  player_deck.insert(gerryfudd::types::card::Card(EPIDEMIC, gerryfudd::types::card::player, gerryfudd::types::card::epidemic), 0);
-  assert_equal<std::string>(player_deck.reveal(0).name, EPIDEMIC);
+  player_deck.insert(gerryfudd::types::card::Card(gerryfudd::types::card::epidemic), 0);
+  assert_equal(player_deck.reveal(0).type(), gerryfudd::types::card::epidemic);
 
   assert_equal(player_deck.remaining(), 12);
 }
 
 TEST(deck_shuffle) {
   gerryfudd::types::card::Deck player_deck{gerryfudd::types::card::player};
-  player_deck.insert(gerryfudd::types::card::Card("Seattle", gerryfudd::types::card::player), 0);
-  player_deck.insert(gerryfudd::types::card::Card("Tacoma", gerryfudd::types::card::player), 0); 
-  player_deck.insert(gerryfudd::types::card::Card("Olympia", gerryfudd::types::card::player), 0); 
-  player_deck.insert(gerryfudd::types::card::Card(EPIDEMIC, gerryfudd::types::card::player, gerryfudd::types::card::epidemic), 0);
-  player_deck.insert(gerryfudd::types::card::Card("Centralia", gerryfudd::types::card::player), 0); 
-  player_deck.insert(gerryfudd::types::card::Card("Astoria", gerryfudd::types::card::player), 0); 
-  player_deck.insert(gerryfudd::types::card::Card("Newberg", gerryfudd::types::card::player), 0); 
-  player_deck.insert(gerryfudd::types::card::Card(EPIDEMIC, gerryfudd::types::card::player, gerryfudd::types::card::epidemic), 0);
-  player_deck.insert(gerryfudd::types::card::Card("Portland", gerryfudd::types::card::player), 0); 
-  player_deck.insert(gerryfudd::types::card::Card("Bend", gerryfudd::types::card::player), 0); 
-  player_deck.insert(gerryfudd::types::card::Card("Gresham", gerryfudd::types::card::player), 0);
-  player_deck.insert(gerryfudd::types::card::Card(EPIDEMIC, gerryfudd::types::card::player, gerryfudd::types::card::epidemic), 0);
-
-  player_deck.shuffle(0, 4);
-  player_deck.shuffle(4, 8);
-  player_deck.shuffle(8, 12);
+  player_deck.insert(gerryfudd::types::card::Card(0, gerryfudd::types::card::player), 0);
+  player_deck.insert(gerryfudd::types::card::Card(1, gerryfudd::types::card::player), 0); 
+  player_deck.insert(gerryfudd::types::card::Card(2, gerryfudd::types::card::player), 0); 
+  player_deck.insert(gerryfudd::types::card::Card(gerryfudd::types::card::epidemic), 0);
+  player_deck.insert(gerryfudd::types::card::Card(3, gerryfudd::types::card::player), 0); 
+  player_deck.insert(gerryfudd::types::card::Card(4, gerryfudd::types::card::player), 0); 
+  player_deck.insert(gerryfudd::types::card::Card(5, gerryfudd::types::card::player), 0); 
+  player_deck.insert(gerryfudd::types::card::Card(gerryfudd::types::card::epidemic), 0);
+  player_deck.insert(gerryfudd::types::card::Card(6, gerryfudd::types::card::player), 0); 
+  player_deck.insert(gerryfudd::types::card::Card(7, gerryfudd::types::card::player), 0); 
+  player_deck.insert(gerryfudd::types::card::Card(8, gerryfudd::types::card::player), 0);
+  player_deck.insert(gerryfudd::types::card::Card(gerryfudd::types::card::epidemic), 0);
+
+  gerryfudd::types::random::Generator generator{1};
+  player_deck.shuffle(0, 4, generator);
+  player_deck.shuffle(4, 8, generator);
+  player_deck.shuffle(8, 12, generator);
   bool has_match{false};
   for (int i = 0; i < 4; i++) {
-    if (player_deck.reveal(i).name == EPIDEMIC) {
+    if (player_deck.reveal(i).type() == gerryfudd::types::card::epidemic) {
       has_match = true;
       break;
     }
@@ -107,7 +111,7 @@ TEST(deck_shuffle) {
   assert_true(has_match, "One of the first four cards should be an Epidemic");
   has_match = false;
   for (int i = 4; i < 8; i++) {
-    if (player_deck.reveal(i).name == EPIDEMIC) {
+    if (player_deck.reveal(i).type() == gerryfudd::types::card::epidemic) {
       has_match = true;
       break;
     }
@@ -115,7 +119,7 @@ TEST(deck_shuffle) {
   assert_true(has_match, "One of the middle four cards should be an Epidemic");
   has_match = false;
   for (int i = 8; i < 12; i++) {
-    if (player_deck.reveal(i).name == EPIDEMIC) {
+    if (player_deck.reveal(i).type() == gerryfudd::types::card::epidemic) {
       has_match = true;
       break;
     }
@@ -123,33 +127,33 @@ TEST(deck_shuffle) {
   assert_true(has_match, "One of the last four cards should be an Epidemic");
 }
 
-TEST(hand_is_streamable) {
+TEST(hand_to_string) {
+  gerryfudd::types::city::Graph cities;
+  gerryfudd::types::city::CityId foo = cities.add(gerryfudd::types::city::City("foo", gerryfudd::types::disease::black, 10)),
+    bar = cities.add(gerryfudd::types::city::City("bar", gerryfudd::types::disease::black, 10));
   gerryfudd::types::card::Hand player_hand(gerryfudd::types::card::player);
 
-  player_hand.contents.push_back(gerryfudd::types::card::Card("foo", gerryfudd::types::card::player));
-  player_hand.contents.push_back(gerryfudd::types::card::Card("bar", gerryfudd::types::card::player));
-  player_hand.contents.push_back(gerryfudd::types::card::Card("baz", gerryfudd::types::card::player));
+  player_hand.contents.push_back(gerryfudd::types::card::Card(foo, gerryfudd::types::card::player));
+  player_hand.contents.push_back(gerryfudd::types::card::Card(bar, gerryfudd::types::card::player));
+  player_hand.contents.push_back(gerryfudd::types::card::Card(gerryfudd::types::card::airlift));
 
-  std::stringstream captor;
-  captor << player_hand;
-
-  assert_equal<std::string>(captor.str(), "Player hand: baz, bar, foo");
+  assert_equal<std::string>(gerryfudd::types::card::to_string(player_hand, cities), "Player hand: Airlift, bar, foo");
 }
 
 TEST(clear_deck) {
-  std::string card_names[] = {"foo", "bar", "baz"};
 
   gerryfudd::types::card::Deck deck{gerryfudd::types::card::infect};
   assert_equal(deck.size(), 0);
   assert_equal(deck.remaining(), 0);
 
   for (int i = 0; i < 3; i++) {
-    deck.discard(gerryfudd::types::card::Card(card_names[i], gerryfudd::types::card::infect));
+    deck.discard(gerryfudd::types::card::Card(i, gerryfudd::types::card::infect));
     assert_equal(deck.size(), i + 1);
     assert_equal(deck.remaining(), 0);
   }
 
-  deck.shuffle();
+  gerryfudd::types::random::Generator generator{1};
+  deck.shuffle(generator);
   assert_equal(deck.size(), 3);
   assert_equal(deck.remaining(), 3);
 
@@ -161,15 +165,15 @@ TEST(clear_deck) {
 TEST(get_discard_contents) {
   gerryfudd::types::card::Deck deck(gerryfudd::types::card::infect);
 
-  deck.discard(gerryfudd::types::card::Card("foo", gerryfudd::types::card::infect));
-  deck.discard(gerryfudd::types::card::Card("bar", gerryfudd::types::card::infect));
-  deck.discard(gerryfudd::types::card::Card("baz", gerryfudd::types::card::infect));
+  deck.discard(gerryfudd::types::card::Card(0, gerryfudd::types::card::infect));
+  deck.discard(gerryfudd::types::card::Card(1, gerryfudd::types::card::infect));
+  deck.discard(gerryfudd::types::card::Card(2, gerryfudd::types::card::infect));
 
-  // This method returns a copy of the contents.
-  std::vector<gerryfudd::types::card::Card> discard_copy = deck.get_discard_contents();
-  assert_equal<std::string>(discard_copy[0].name, "foo");
-  assert_equal<std::string>(discard_copy[1].name, "bar");
-  assert_equal<std::string>(discard_copy[2].name, "baz");
+  // Copying the contents out of the deck is a plain copy of a fixed array.
+  gerryfudd::types::fixed::Vector<gerryfudd::types::card::Card, DECK_CAPACITY> discard_copy = deck.get_discard_contents();
+  assert_equal<int>(discard_copy[0].city_id(), 0);
+  assert_equal<int>(discard_copy[1].city_id(), 1);
+  assert_equal<int>(discard_copy[2].city_id(), 2);
   // Modifying this copy doesn't alter the original
   discard_copy.pop_back();
   assert_equal(discard_copy.size(), deck.get_discard_contents().size() - 1);
@@ -180,10 +184,10 @@ TEST(remove_from_discard_throws_if_not_present) {
 
   bool exception_thrown = false;
   try {
-    deck.remove_from_discard("foo");
+    deck.remove_from_discard(gerryfudd::types::card::Card(gerryfudd::types::card::airlift));
   } catch(std::invalid_argument e) {
     exception_thrown = true;
-    assert_equal<std::string>(e.what(), "The card foo is not in the discard pile.");
+    assert_equal<std::string>(e.what(), "The card Airlift is not in the discard pile.");
   }
   assert_true(exception_thrown, "This method should throw if the card isn't in the discard.");
 }
@@ -191,11 +195,141 @@ TEST(remove_from_discard_throws_if_not_present) {
 TEST(remove_from_discard) {
   gerryfudd::types::card::Deck deck(gerryfudd::types::card::player);
 
-  deck.discard(gerryfudd::types::card::Card("foo", gerryfudd::types::card::player));
+  deck.discard(gerryfudd::types::card::Card(gerryfudd::types::card::airlift));
   assert_equal<int>(deck.get_discard_contents().size(), 1);
 
-  gerryfudd::types::card::Card removed_foo = deck.remove_from_discard("foo");
+  gerryfudd::types::card::Card removed = deck.remove_from_discard(gerryfudd::types::card::Card(gerryfudd::types::card::airlift));
 
   assert_equal<int>(deck.get_discard_contents().size(), 0);
-  assert_equal<std::string>(removed_foo.name, "foo");
+  assert_equal(removed.type(), gerryfudd::types::card::airlift);
+}
+
+TEST(deck_shuffle_range_only_moves_range) {
+  gerryfudd::types::card::Deck deck{gerryfudd::types::card::player};
+  for (int i = 0; i < 8; i++) {
+    deck.insert(gerryfudd::types::card::Card(i, gerryfudd::types::card::player), 0);
+  }
+
+  gerryfudd::types::random::Generator generator{3};
+  deck.shuffle(2, 6, generator);
+
+  assert_equal<int>(deck.reveal(0).city_id(), 7);
+  assert_equal<int>(deck.reveal(1).city_id(), 6);
+  assert_equal<int>(deck.reveal(6).city_id(), 1);
+  assert_equal<int>(deck.reveal(7).city_id(), 0);
+  std::set<int> middle;
+  for (int i = 2; i < 6; i++) {
+    middle.insert(deck.reveal(i).city_id());
+  }
+  assert_equal<int>(middle.size(), 4);
+  assert_true(middle.count(2) && middle.count(3) && middle.count(4) && middle.count(5), "The shuffled range should hold the same cards.");
+}
+
+TEST(deck_shuffle_places_discards_on_top) {
+  gerryfudd::types::card::Deck deck{gerryfudd::types::card::infect};
+  deck.insert(gerryfudd::types::card::Card(9, gerryfudd::types::card::infect), 0);
+  deck.discard(gerryfudd::types::card::Card(0, gerryfudd::types::card::infect));
+  deck.discard(gerryfudd::types::card::Card(1, gerryfudd::types::card::infect));
+  deck.discard(gerryfudd::types::card::Card(2, gerryfudd::types::card::infect));
+
+  gerryfudd::types::random::Generator generator{5};
+  deck.shuffle(generator);
+
+  assert_equal(deck.remaining(), 4);
+  assert_equal<int>(deck.get_discard_contents().size(), 0);
+  assert_equal<int>(deck.reveal(3).city_id(), 9);
+}
+
+TEST(deck_draw_from_top_bottom_and_middle) {
+  gerryfudd::types::card::Deck deck{gerryfudd::types::card::infect};
+  for (int i = 0; i < 5; i++) {
+    deck.insert(gerryfudd::types::card::Card(i, gerryfudd::types::card::infect), 0);
+  }
+
+  assert_equal<int>(deck.reveal(-1).city_id(), 0);
+  assert_equal<int>(deck.draw(-1).city_id(), 0);
+  assert_equal<int>(deck.draw().city_id(), 4);
+  assert_equal<int>(deck.draw(1).city_id(), 2);
+  assert_equal(deck.remaining(), 2);
+  assert_equal<int>(deck.reveal(0).city_id(), 3);
+  assert_equal<int>(deck.reveal(1).city_id(), 1);
+}
+
+TEST(card_ids) {
+  gerryfudd::types::card::Card player_city{12, gerryfudd::types::card::player},
+    infection_city{12, gerryfudd::types::card::infect},
+    event{gerryfudd::types::card::government_grant};
+
+  assert_equal(player_city.type(), gerryfudd::types::card::city);
+  assert_equal(player_city.deck_type(), gerryfudd::types::card::player);
+  assert_equal<int>(player_city.city_id(), 12);
+  assert_equal(infection_city.type(), gerryfudd::types::card::city);
+  assert_equal(infection_city.deck_type(), gerryfudd::types::card::infect);
+  assert_equal<int>(infection_city.city_id(), 12);
+  assert_false(player_city == infection_city, "Player and infection cards for the same city are different cards.");
+  assert_equal(event.type(), gerryfudd::types::card::government_grant);
+  assert_equal(event.deck_type(), gerryfudd::types::card::player);
+  assert_equal<int>(event.city_id(), NO_CITY);
+  assert_true(std::is_trivially_copyable_v<gerryfudd::types::card::Hand>, "Hands should be trivially copyable.");
+  assert_true(std::is_trivially_copyable_v<gerryfudd::types::card::Deck>, "Decks should be trivially copyable.");
+}
+
+TEST(deck_layers) {
+  gerryfudd::types::card::Deck deck{gerryfudd::types::card::infect};
+  gerryfudd::types::random::Generator generator{4};
+  for (int i = 0; i < 6; i++) {
+    deck.discard(gerryfudd::types::card::Card(i, gerryfudd::types::card::infect));
+  }
+  deck.shuffle(generator);
+  deck.draw_and_discard();
+  deck.draw_and_discard();
+  deck.shuffle(generator);
+  assert_equal(deck.layer_count(), 2);
+  assert_equal(deck.layer_size(0), 4);
+  assert_equal(deck.layer_size(1), 2);
+  assert_equal(deck.layer_of(1), 1);
+  assert_equal(deck.layer_of(2), 0);
+  assert_equal(deck.layer_of(-1), 0);
+
+  gerryfudd::types::card::Card drawn = deck.draw(3);
+  assert_equal(deck.layer_size(0), 3);
+  deck.draw();
+  deck.draw();
+  assert_equal(deck.layer_size(1), 0);
+  assert_equal(deck.layer_of(0), 0);
+  deck.insert(drawn, 0, 1);
+  assert_equal(deck.layer_size(1), 1);
+
+  deck.unshuffle();
+  assert_equal(deck.layer_count(), 1);
+  assert_equal(deck.remaining(), 3);
+}
+
+TEST(deck_stacked_layers) {
+  gerryfudd::types::card::Deck deck{gerryfudd::types::card::infect};
+  gerryfudd::types::random::Generator generator{4};
+  for (int i = 0; i < 8; i++) {
+    deck.discard(gerryfudd::types::card::Card(i, gerryfudd::types::card::infect));
+  }
+  deck.stack();
+  assert_equal(deck.layer_count(), 1);
+  assert_true(deck.is_stacked(0), "A stacked layer shouldn't be shuffled yet.");
+  for (int i = 0; i < 8; i++) {
+    assert_equal<int>(deck.reveal(i).city_id(), 7 - i);
+  }
+
+  gerryfudd::types::random::Generator before = generator;
+  deck.shuffle_layer(0, generator);
+  assert_false(deck.is_stacked(0), "The layer should be shuffled.");
+  bool moved = false;
+  for (int i = 0; i < 8; i++) {
+    moved = moved || deck.reveal(i).city_id() != 7 - i;
+  }
+  assert_true(moved, "The shuffle should reorder the layer.");
+
+  deck.unshuffle_layer(0, before);
+  assert_true(deck.is_stacked(0), "The layer should be stacked again.");
+  for (int i = 0; i < 8; i++) {
+    assert_equal<int>(deck.reveal(i).city_id(), 7 - i);
+  }
 }
@@ -24,33 +24,222 @@ TEST(get_population) {
   assert_equal(city.population, population);
 }
 
-TEST(attach) {
-  gerryfudd::types::city::City cityA("A", gerryfudd::types::disease::black, 10), cityB("B", gerryfudd::types::disease::blue, 20);
+TEST(graph_ids_and_neighbors) {
+  gerryfudd::types::city::Graph graph;
+  gerryfudd::types::city::CityId a = graph.add(gerryfudd::types::city::City("A", gerryfudd::types::disease::black, 10)),
+    b = graph.add(gerryfudd::types::city::City("B", gerryfudd::types::disease::blue, 20)),
+    c = graph.add(gerryfudd::types::city::City("C", gerryfudd::types::disease::blue, 15));
 
-  assert_equal<int>(cityA.neighbors.size(), 0);
-  assert_equal<int>(cityB.neighbors.size(), 0);
+  graph.attach(a, b);
+  graph.attach(b, c);
 
-  attach(&cityA, &cityB);
-  assert_equal<int>(cityA.neighbors.size(), 1);
-  assert_equal<int>(cityB.neighbors.size(), 1);
-  assert_equal<std::string>(cityA.neighbors[0].name, "B");
-  assert_equal<std::string>(cityB.neighbors[0].name, "A");
+  assert_equal(graph.size(), 3);
+  assert_equal(graph.id_of("B"), b);
+  assert_equal<std::string>(graph.name_of(c), "C");
+
+  assert_equal<int>(graph.neighbors(a).size(), 1);
+  assert_equal(graph.neighbors(a)[0], b);
+  assert_equal<int>(graph.neighbors(b).size(), 2);
+  assert_equal(graph.neighbors(b)[0], a);
+  assert_equal(graph.neighbors(b)[1], c);
+  assert_equal<int>(graph.neighbors(c).size(), 1);
+  assert_equal(graph.neighbors(c)[0], b);
+
+  assert_true(graph.adjacent(a, b), "A and B should be adjacent.");
+  assert_false(graph.adjacent(a, c), "A and C should not be adjacent.");
+}
+
+TEST(graph_distances) {
+  gerryfudd::types::city::Graph graph;
+  gerryfudd::types::city::CityId a = graph.add(gerryfudd::types::city::City("A", gerryfudd::types::disease::black, 10)),
+    b = graph.add(gerryfudd::types::city::City("B", gerryfudd::types::disease::blue, 20)),
+    c = graph.add(gerryfudd::types::city::City("C", gerryfudd::types::disease::blue, 15)),
+    d = graph.add(gerryfudd::types::city::City("D", gerryfudd::types::disease::red, 5)),
+    e = graph.add(gerryfudd::types::city::City("E", gerryfudd::types::disease::red, 5));
+
+  graph.attach(a, b);
+  graph.attach(c, d);
+  assert_equal(graph.distance(a, a), 0);
+  assert_equal(graph.distance(a, b), 1);
+  assert_equal(graph.distance(a, c), NO_PATH);
+
+  // Joining the two components routes every pair through the new edge.
+  graph.attach(b, c);
+  assert_equal(graph.distance(a, d), 3);
+  assert_equal(graph.distance(d, a), 3);
+  assert_equal(graph.distance(b, d), 2);
+  assert_equal(graph.distance(e, a), NO_PATH);
+
+  // A shortcut shortens paths that already existed.
+  graph.attach(a, d);
+  assert_equal(graph.distance(a, d), 1);
+  assert_equal(graph.distance(b, d), 2);
+  assert_equal(graph.distance(a, c), 2);
+
+  gerryfudd::types::city::Graph copy = graph;
+  assert_equal(copy.distance(a, c), 2);
+}
+
+TEST(graph_distances_long_path) {
+  gerryfudd::types::city::Graph graph;
+  // The longest path that fits in the graph, up to the longest that can be measured.
+  int length = std::min(MAX_CITY_COUNT - 1, NO_PATH - 1);
+  graph.add(gerryfudd::types::city::City("0", gerryfudd::types::disease::black, 10));
+  for (int i = 1; i <= length; i++) {
+    graph.attach(graph.add(gerryfudd::types::city::City(std::to_string(i), gerryfudd::types::disease::black, 10)), i - 1);
+  }
+  assert_equal(graph.distance(0, length), length);
+  assert_equal(graph.distance(length, 0), length);
+
+#if MAX_CITY_COUNT > NO_PATH
+  gerryfudd::types::city::CityId last = graph.add(gerryfudd::types::city::City("Last", gerryfudd::types::disease::black, 10));
+  bool exception_thrown = false;
+  try {
+    graph.attach(last, length);
+  } catch (std::invalid_argument e) {
+    exception_thrown = true;
+    assert_equal<std::string>(e.what(), "The cities 0 and Last are too far apart to measure.");
+  }
+  assert_true(exception_thrown, "A path too long to measure should throw rather than wrap around.");
+#endif
+}
+
+TEST(city_neighbors_view_graph) {
+  gerryfudd::types::city::Graph graph;
+  gerryfudd::types::city::CityId a = graph.add(gerryfudd::types::city::City("A", gerryfudd::types::disease::black, 10)),
+    b = graph.add(gerryfudd::types::city::City("B", gerryfudd::types::disease::blue, 20)),
+    c = graph.add(gerryfudd::types::city::City("C", gerryfudd::types::disease::blue, 15));
+
+  graph.attach(a, b);
+  graph.attach(b, c);
+
+  gerryfudd::types::city::Graph copy = graph;
+  graph = gerryfudd::types::city::Graph();
+
+  assert_equal<int>(copy[a].neighbors.size(), 1);
+  assert_equal(copy[a].neighbors[0], b);
+  assert_equal<int>(copy[b].neighbors.size(), 2);
+  assert_equal(copy[b].neighbors[0], a);
+  assert_equal(copy[b].neighbors[1], c);
+  assert_equal<int>(copy[c].neighbors.size(), 1);
+  assert_equal(copy[c].neighbors[0], b);
+}
+
+TEST(graph_id_of_unknown_city) {
+  gerryfudd::types::city::Graph graph;
+  graph.add(gerryfudd::types::city::City("A", gerryfudd::types::disease::black, 10));
+
+  bool exception_thrown = false;
+  try {
+    graph.id_of("B");
+  } catch (std::invalid_argument e) {
+    exception_thrown = true;
+    assert_equal<std::string>(e.what(), "There is no city named B.");
+  }
+  assert_true(exception_thrown, "Looking up a city that isn't on the graph should throw.");
 }
 
-TEST(neighbor_logic) {
-  gerryfudd::types::city::City cityA("A", gerryfudd::types::disease::black, 10), 
-    cityB("B", gerryfudd::types::disease::blue, 20),
-    cityC("C", gerryfudd::types::disease::blue, 15);
+TEST(graph_load) {
+  std::vector<gerryfudd::types::city::City> cities {
+    gerryfudd::types::city::City("A", gerryfudd::types::disease::black, 10),
+    gerryfudd::types::city::City("B", gerryfudd::types::disease::blue, 20),
+    gerryfudd::types::city::City("C", gerryfudd::types::disease::blue, 15)
+  };
+  int offsets[] {0, 1, 3, 4};
+  gerryfudd::types::city::CityId neighbor_ids[] {1, 0, 2, 1};
+  uint8_t distances[] {0, 1, 2, 1, 0, 1, 2, 1, 0};
+
+  gerryfudd::types::city::Graph graph;
+  graph.load(cities, offsets, neighbor_ids, distances);
+
+  assert_equal(graph.size(), 3);
+  assert_equal<int>(graph.id_of("C"), 2);
+  assert_equal<int>(graph[1].neighbors.size(), 2);
+  assert_equal<int>(graph[1].neighbors[1], 2);
+  assert_equal(graph.distance(0, 2), 2);
+
+  bool exception_thrown = false;
+  try {
+    gerryfudd::types::city::Graph mismatched;
+    mismatched.load(cities, std::span<const int>(offsets, 3), neighbor_ids, distances);
+  } catch (std::invalid_argument e) {
+    exception_thrown = true;
+    assert_equal<std::string>(e.what(), "The adjacency arrays don't match the cities being loaded.");
+  }
+  assert_true(exception_thrown, "Loading adjacency arrays of the wrong size should throw.");
+}
+
+TEST(city_set_operations) {
+  gerryfudd::types::city::CitySet a, b;
+
+  assert_true(a.empty(), "A new city set is empty.");
+  a.insert(3);
+  a.insert(47);
+  a.insert(63);
+  b.insert(47);
+  b.insert(5);
+
+  assert_equal(a.size(), 3);
+  assert_true(a.contains(63), "The set should contain an inserted city.");
+  assert_false(a.contains(5), "The set should not contain a city that wasn't inserted.");
+  assert_equal((a & b).size(), 1);
+  assert_true((a & b).contains(47), "The intersection should contain the shared city.");
+  assert_equal((a | b).size(), 4);
+  assert_false((~a).contains(3), "The complement should not contain a member.");
 
-  attach(&cityA, &cityB);
-  attach(&cityB, &cityC);
-  assert_equal<int>(cityA.neighbors.size(), 1);
-  assert_equal<std::string>(cityA.neighbors[0].name, "B");
+  std::vector<gerryfudd::types::city::CityId> members;
+  for (gerryfudd::types::city::CityId id : a) {
+    members.push_back(id);
+  }
+  assert_equal<int>(members.size(), 3);
+  assert_equal<int>(members[0], 3);
+  assert_equal<int>(members[1], 47);
+  assert_equal<int>(members[2], 63);
+
+  a.erase(47);
+  assert_false(a.contains(47), "The set should not contain an erased city.");
+  assert_equal(a.size(), 2);
+}
+
+TEST(board_cube_counts) {
+  gerryfudd::types::city::Board board;
+
+  board.set_cube_count(7, gerryfudd::types::disease::red, 3);
+  board.set_cube_count(7, gerryfudd::types::disease::black, 1);
+  board.set_cube_count(9, gerryfudd::types::disease::red, 2);
+
+  assert_equal(board.cube_count(7, gerryfudd::types::disease::red), 3);
+  assert_equal(board.cube_count(7, gerryfudd::types::disease::black), 1);
+  assert_equal(board.cube_count(7, gerryfudd::types::disease::blue), 0);
+  assert_equal(board.cube_count(7), 4);
+  assert_equal(board.infected(gerryfudd::types::disease::red).size(), 2);
+  assert_equal(board.saturated(gerryfudd::types::disease::red).size(), 1);
+  assert_true(board.saturated(gerryfudd::types::disease::red).contains(7), "A city with 3 red cubes is at capacity for red.");
+
+  board.set_cube_count(7, gerryfudd::types::disease::red, 0);
+  assert_equal(board.cube_count(7, gerryfudd::types::disease::black), 1);
+  assert_true(board.saturated(gerryfudd::types::disease::red).empty(), "No city is at capacity for red after treating.");
+  assert_equal(board.infected(gerryfudd::types::disease::red).size(), 1);
+
+  bool exception_thrown = false;
+  try {
+    board.set_cube_count(9, gerryfudd::types::disease::red, 4);
+  } catch (std::invalid_argument e) {
+    exception_thrown = true;
+    assert_equal<std::string>(e.what(), "A city can't hold 4 cubes of one color.");
+  }
+  assert_true(exception_thrown, "A city should not hold more than 3 cubes of one color.");
+}
 
-  assert_equal<int>(cityB.neighbors.size(), 2);
-  assert_equal<std::string>(cityB.neighbors[0].name, "A");
-  assert_equal<std::string>(cityB.neighbors[1].name, "C");
+TEST(board_research_facilities) {
+  gerryfudd::types::city::Board board;
 
-  assert_equal<int>(cityC.neighbors.size(), 1);
-  assert_equal<std::string>(cityC.neighbors[0].name, "B");
+  assert_false(board.research_facility(12), "A new board has no research facilities.");
+  board.set_research_facility(12, true);
+  board.set_research_facility(40, true);
+  assert_true(board.research_facility(12), "The board should have a research facility where one was placed.");
+  assert_equal(board.research_facility_locations().size(), 2);
+  board.set_research_facility(12, false);
+  assert_false(board.research_facility(12), "The board should not have a research facility where one was removed.");
+  assert_equal(board.research_facility_locations().size(), 1);
 }
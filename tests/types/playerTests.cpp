@@ -8,8 +8,9 @@ using namespace gerryfudd::types;
 
 TEST(get_roles_by_player_count) {
   std::vector<player::Role> assigned_roles;
+  random::Generator generator{1};
   for (int i = 2; i <= 4; i++) {
-    assigned_roles = player::get_roles(i);
+    assigned_roles = player::get_roles(i, generator);
     assert_equal<int>(assigned_roles.size(), i);
     for (int j = 0; j < i - 1; j++) {
       for (int k = j + 1; k < i; k++) {
@@ -20,7 +21,7 @@ TEST(get_roles_by_player_count) {
 }
 
 TEST(get_actions_for_role) {
-  std::vector<player::ActionType> actions;
+  fixed::Vector<player::ActionType, ACTION_TYPE_COUNT> actions;
   player::Role begin = player::contingency_planner;
   for (int i = 0; i < 7; i++) {
     player::Role role = *(&begin + i);
@@ -0,0 +1,33 @@
+#include <Framework.hpp>
+#include <Assertions.inl>
+#include <types/random.hpp>
+
+using namespace gerryfudd::test;
+
+TEST(generator_is_reproducible) {
+  gerryfudd::types::random::Generator first{42}, second{42}, other{43};
+
+  bool differs_from_other_seed = false;
+  for (int i = 0; i < 100; i++) {
+    uint64_t value = first();
+    assert_true(value == second(), "Generators with the same seed should produce the same sequence.");
+    if (value != other()) {
+      differs_from_other_seed = true;
+    }
+  }
+  assert_true(differs_from_other_seed, "Generators with different seeds should produce different sequences.");
+}
+
+TEST(generator_below_stays_in_range) {
+  gerryfudd::types::random::Generator generator{7};
+  int counts[6] = {0, 0, 0, 0, 0, 0};
+
+  for (int i = 0; i < 6000; i++) {
+    int value = generator.below(6);
+    assert_true(value >= 0 && value < 6, "Values should be in [0, bound).");
+    counts[value]++;
+  }
+  for (int i = 0; i < 6; i++) {
+    assert_true(counts[i] > 800 && counts[i] < 1200, "Values should be roughly uniform.");
+  }
+}
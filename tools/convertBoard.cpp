@@ -0,0 +1,18 @@
+#include <iostream>
+#include <stdexcept>
+#include <data/board_file.hpp>
+
+// Converts a text board definition into the binary format read by load_board.
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <text board> <binary board>" << std::endl;
+    return 2;
+  }
+  try {
+    gerryfudd::data::board::convert_board(argv[1], argv[2]);
+  } catch (std::invalid_argument e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}